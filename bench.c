@@ -0,0 +1,1395 @@
+/* BENCH_EXTERN links against a separately compiled implementation to
+measure calls across translation units, see make bench-inline */
+
+#ifndef BENCH_EXTERN
+#define SPXM_APPLICATION
+#endif
+#include <spxmath.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_REPS 5
+#define BENCH_BUFSIZE 4096
+#define BENCH_MASK (BENCH_BUFSIZE - 1)
+#define BENCH_MESH_W 1024
+#define BENCH_MESH_H 512
+#define BENCH_MESH (BENCH_MESH_W * BENCH_MESH_H * 2)
+#define BENCH_CLOUD (10 * 1000 * 1000)
+#define BENCH_SORT (1024 * 1024)
+
+/* name of the build in the results, set with -DBENCH_BUILD=\"name\" */
+
+#ifndef BENCH_BUILD
+#define BENCH_BUILD "default"
+#endif
+
+static size_t scale = 1;
+static int json = 0;
+static int count = 0;
+static const char* filter = NULL;
+static volatile unsigned int sinku;
+static volatile float sinkf;
+static spxrng rng;
+static float* buf;
+static vec4* vin;
+static vec4* vout;
+static mat4* mats;
+static mat4* mout;
+static quat* quats;
+static vec3* pos;
+static vec3* vel;
+static vec3_soa soa;
+static sincos_lut lut;
+static vec4_soa spheres;
+static vec3_soa box_min;
+static vec3_soa box_max;
+static frustum view;
+static unsigned int visible[BENCH_BUFSIZE / 32];
+static transform_hierarchy scene;
+static ray* rays;
+static ray4* packets4;
+static ray8* packets8;
+static triangle* mesh;
+static aabb* mesh_boxes;
+static bvh mesh_bvh;
+static ray* mesh_rays;
+static unsigned int found[BENCH_BUFSIZE];
+static vec3_soa cloud;
+static vec3_soa cloud_part;
+static spatial_hash grids[3];
+static spatial_hash* grid;
+static vec3_soa cloud_sorted;
+static unsigned int* sort_keys;
+static unsigned int* sort_values;
+static unsigned int* sort_tmp;
+
+typedef void (*benchfn)(size_t);
+
+/* best of BENCH_REPS timed runs after one warmup run, in ns per op */
+
+static double bench_time(benchfn fn, size_t ops)
+{
+    int i;
+    double t, best = -1.0;
+    clock_t start;
+
+    fn(ops);
+    for (i = 0; i < BENCH_REPS; ++i) {
+        start = clock();
+        fn(ops);
+        t = (double)(clock() - start) / (double)CLOCKS_PER_SEC;
+        best = (best < 0.0 || t < best) ? t : best;
+    }
+    return best * 1e9 / (double)ops;
+}
+
+static void bench(const char* name, benchfn fn, size_t ops)
+{
+    double ns, rate;
+    if (filter && !strstr(name, filter)) {
+        return;
+    }
+
+    ns = bench_time(fn, ops * scale);
+    rate = ns > 0.0 ? 1e9 / ns : 0.0;
+    if (json) {
+        printf("%s\n  {\"build\": \"%s\", \"name\": \"%s\", \"ns_per_op\": %.3f, \"ops_per_sec\": %.0f}",
+            count ? "," : "", BENCH_BUILD, name, ns, rate);
+    } else {
+        printf("%s,%s,%.3f,%.0f\n", BENCH_BUILD, name, ns, rate);
+    }
+    ++count;
+}
+
+/* random number generators */
+
+static void bench_spxrand(size_t n)
+{
+    unsigned int s = 0;
+    while (n--) {
+        s += spxrand();
+    }
+    sinku = s;
+}
+
+static void bench_spxrandf(size_t n)
+{
+    float s = 0.0F;
+    while (n--) {
+        s += spxrandf();
+    }
+    sinkf = s;
+}
+
+static void bench_spxrandf_fill(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        spxrandf_fill(buf, BENCH_BUFSIZE);
+    }
+    sinkf = buf[0];
+}
+
+static void bench_spxrand32_r(size_t n)
+{
+    unsigned int s = 0;
+    while (n--) {
+        s += spxrand32_r(&rng);
+    }
+    sinku = s;
+}
+
+static void bench_spxrandf_r(size_t n)
+{
+    float s = 0.0F;
+    while (n--) {
+        s += spxrandf_r(&rng);
+    }
+    sinkf = s;
+}
+
+static void bench_spxrand_bounded_r(size_t n)
+{
+    unsigned int s = 0;
+    while (n--) {
+        s += spxrand_bounded_r(&rng, 1000);
+    }
+    sinku = s;
+}
+
+static void bench_random(void)
+{
+    static const char* names[] = {"hash", "xoshiro128p", "xoshiro256ss", "pcg32", "philox"};
+    char name[64];
+    unsigned int type;
+
+    bench("spxrand", bench_spxrand, 10000000);
+    bench("spxrandf", bench_spxrandf, 10000000);
+    bench("spxrandf_fill", bench_spxrandf_fill, 10000000);
+
+    for (type = SPXRNG_HASH; type <= SPXRNG_PHILOX; ++type) {
+        rng = spxrng_create(type, 1, 0);
+        sprintf(name, "spxrand32_r[%s]", names[type]);
+        bench(name, bench_spxrand32_r, 10000000);
+        sprintf(name, "spxrandf_r[%s]", names[type]);
+        bench(name, bench_spxrandf_r, 10000000);
+        sprintf(name, "spxrand_bounded_r[%s]", names[type]);
+        bench(name, bench_spxrand_bounded_r, 10000000);
+    }
+}
+
+/* matrices, the inputs are rotations so chained products stay bounded */
+
+static void bench_mat4_mult(size_t n)
+{
+    size_t i;
+    mat4 m = mat4_id();
+    for (i = 0; i < n; ++i) {
+        m = mat4_mult(m, mats[i & BENCH_MASK]);
+    }
+    sinkf = m.data[0][0];
+}
+
+static void bench_mat4_mult_to(size_t n)
+{
+    size_t i;
+    mat4 m[2];
+    m[0] = mat4_id();
+    for (i = 0; i < n; ++i) {
+        mat4_mult_to(m + ((i + 1) & 1), m + (i & 1), mats + (i & BENCH_MASK));
+    }
+    sinkf = m[n & 1].data[0][0];
+}
+
+static void bench_mat4_mult_inplace(size_t n)
+{
+    size_t i;
+    mat4 m = mat4_id();
+    for (i = 0; i < n; ++i) {
+        mat4_mult_inplace(&m, mats + (i & BENCH_MASK));
+    }
+    sinkf = m.data[0][0];
+}
+
+static void bench_mat4_mult_affine(size_t n)
+{
+    size_t i;
+    mat4 m = mat4_id();
+    for (i = 0; i < n; ++i) {
+        mat4_mult_affine_to(&m, &m, mats + (i & BENCH_MASK));
+    }
+    sinkf = m.data[0][0];
+}
+
+static void bench_mat4_rot(size_t n)
+{
+    size_t i;
+    mat4 m = mat4_id();
+    for (i = 0; i < n; ++i) {
+        m = mat4_rot(m, buf[i & BENCH_MASK], vec3_norm(vec3_new(vin[i & BENCH_MASK].x, 1.0F, 0.5F)));
+    }
+    sinkf = m.data[0][0];
+}
+
+static void bench_mat4_rot_inplace(size_t n)
+{
+    size_t i;
+    mat4 m = mat4_id();
+    for (i = 0; i < n; ++i) {
+        mat4_rot_inplace(&m, buf[i & BENCH_MASK], vec3_norm(vec3_new(vin[i & BENCH_MASK].x, 1.0F, 0.5F)));
+    }
+    sinkf = m.data[0][0];
+}
+
+static void bench_mat4_rot_sincos(size_t n)
+{
+    size_t i;
+    mat4 m = mat4_id();
+    for (i = 0; i < n; ++i) {
+        vec2 p = sincos_lut_step(&lut, (unsigned int)i);
+        m = mat4_rot_sincos(m, p.y, p.x, vec3_norm(vec3_new(vin[i & BENCH_MASK].x, 1.0F, 0.5F)));
+    }
+    sinkf = m.data[0][0];
+}
+
+static void bench_mat4_model(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    mat4 m;
+    for (i = 0; i < n; ++i) {
+        const vec4* p = vin + (i & BENCH_MASK);
+        m = mat4_model(vec3_new(p->x, p->y, p->z), vec3_new(p->w, p->w, p->w), vec3_new(0.0F, 1.0F, 0.0F), p->x);
+        s += m.data[3][0];
+    }
+    sinkf = s;
+}
+
+static void bench_mat4_model_to(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    mat4 m;
+    for (i = 0; i < n; ++i) {
+        const vec4* p = vin + (i & BENCH_MASK);
+        mat4_model_to(&m, vec3_new(p->x, p->y, p->z), vec3_new(p->w, p->w, p->w), vec3_new(0.0F, 1.0F, 0.0F), p->x);
+        s += m.data[3][0];
+    }
+    sinkf = s;
+}
+
+static void bench_quat_to_mat4(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    mat4 m;
+    for (i = 0; i < n; ++i) {
+        m = quat_to_mat4(quats[i & BENCH_MASK]);
+        s += m.data[1][2];
+    }
+    sinkf = s;
+}
+
+static void bench_mat4_inverse(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    mat4 m;
+    for (i = 0; i < n; ++i) {
+        m = mat4_inverse(mats[i & BENCH_MASK]);
+        s += m.data[3][0];
+    }
+    sinkf = s;
+}
+
+static void bench_mat4_array_inverse(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        mat4_array_inverse(mats, mout, BENCH_BUFSIZE);
+    }
+    sinkf = mout[0].data[0][0];
+}
+
+static void bench_mat4(void)
+{
+    bench("mat4_mult", bench_mat4_mult, 10000000);
+    bench("mat4_mult_to", bench_mat4_mult_to, 10000000);
+    bench("mat4_mult_affine_to", bench_mat4_mult_affine, 10000000);
+    bench("mat4_mult_inplace", bench_mat4_mult_inplace, 10000000);
+    bench("mat4_rot", bench_mat4_rot, 10000000);
+    bench("mat4_rot_inplace", bench_mat4_rot_inplace, 10000000);
+    bench("mat4_rot_sincos", bench_mat4_rot_sincos, 10000000);
+    bench("mat4_model", bench_mat4_model, 10000000);
+    bench("mat4_model_to", bench_mat4_model_to, 10000000);
+    bench("quat_to_mat4", bench_quat_to_mat4, 10000000);
+    bench("mat4_inverse", bench_mat4_inverse, 10000000);
+    bench("mat4_array_inverse", bench_mat4_array_inverse, 10000000);
+}
+
+/* vectors */
+
+static void bench_vec4_mult_mat4(size_t n)
+{
+    size_t i;
+    vec4 v = vec4_new(1.0F, 0.0F, 0.0F, 1.0F);
+    for (i = 0; i < n; ++i) {
+        v = vec4_mult_mat4(v, mats[i & BENCH_MASK]);
+    }
+    sinkf = v.x;
+}
+
+static void bench_vec4_mult_mat4_to(size_t n)
+{
+    size_t i;
+    vec4 v[2];
+    v[0] = vec4_new(1.0F, 0.0F, 0.0F, 1.0F);
+    for (i = 0; i < n; ++i) {
+        vec4_mult_mat4_to(v + ((i + 1) & 1), v + (i & 1), mats + (i & BENCH_MASK));
+    }
+    sinkf = v[n & 1].x;
+}
+
+static void bench_vec4_array_mult_mat4(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        vec4_array_mult_mat4(mats, vin, vout, BENCH_BUFSIZE);
+    }
+    sinkf = vout[0].x;
+}
+
+static void bench_vec3_array_mult_mat4_point(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        vec3_array_mult_mat4_point(mats, (const vec3*)(void*)vin, (vec3*)(void*)vout, BENCH_BUFSIZE);
+    }
+    sinkf = vout[0].x;
+}
+
+static void bench_vec2_norm(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        const vec4* p = vin + (i & BENCH_MASK);
+        s += vec2_norm(vec2_new(p->x, p->y)).x;
+    }
+    sinkf = s;
+}
+
+/* 2D kernels over BENCH_BUFSIZE points read from vin as vec2 and angles in
+buf, one op per point */
+
+static void bench_vec2_rotate(size_t n)
+{
+    size_t i, j;
+    const vec2* in = (const vec2*)(const void*)vin;
+    vec2* out = (vec2*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        for (j = 0; j < BENCH_BUFSIZE; ++j) {
+            out[j] = vec2_rotate(in[j], buf[j]);
+        }
+    }
+    sinkf = out[0].x;
+}
+
+static void bench_vec2_array_rotate(size_t n)
+{
+    size_t i;
+    vec2* out = (vec2*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        vec2_array_rotate((const vec2*)(const void*)vin, buf, out, BENCH_BUFSIZE);
+    }
+    sinkf = out[0].x;
+}
+
+static void bench_vec2_array_to_polar(size_t n)
+{
+    size_t i;
+    float* out = (float*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        vec2_array_to_polar((const vec2*)(const void*)vin, out, out + BENCH_BUFSIZE, BENCH_BUFSIZE);
+    }
+    sinkf = out[0];
+}
+
+static void bench_vec2_array_to_polar_fast(size_t n)
+{
+    size_t i;
+    float* out = (float*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        vec2_array_to_polar_fast((const vec2*)(const void*)vin, out, out + BENCH_BUFSIZE, BENCH_BUFSIZE);
+    }
+    sinkf = out[0];
+}
+
+static void bench_vec2_array_norm(size_t n)
+{
+    size_t i;
+    vec2* out = (vec2*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        vec2_array_norm((const vec2*)(const void*)vin, out, BENCH_BUFSIZE);
+    }
+    sinkf = out[0].x;
+}
+
+static void bench_mat3x2_array_model(size_t n)
+{
+    size_t i;
+    const vec2* in = (const vec2*)(const void*)vin;
+    mat3x2* out = (mat3x2*)(void*)mout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        mat3x2_array_model(in, in + BENCH_BUFSIZE, buf, out, BENCH_BUFSIZE);
+    }
+    sinkf = out[0].data[0][0];
+}
+
+/* grid coordinates of BENCH_BUFSIZE positions, one op per vec3 */
+
+static void bench_ivec3_from_vec3_floor(size_t n)
+{
+    size_t i, j;
+    const vec3* in = (const vec3*)(const void*)vin;
+    ivec3* out = (ivec3*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        for (j = 0; j < BENCH_BUFSIZE; ++j) {
+            out[j] = ivec3_from_vec3_floor(in[j]);
+        }
+    }
+    sinku = (unsigned int)out[0].x;
+}
+
+static void bench_ivec3_array_from_vec3(size_t n)
+{
+    size_t i;
+    ivec3* out = (ivec3*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        ivec3_array_from_vec3((const vec3*)(const void*)vin, out, BENCH_BUFSIZE, SPXM_ROUND_FLOOR);
+    }
+    sinku = (unsigned int)out[0].x;
+}
+
+/* compact storage, n counts floats for the half conversions and normals
+for the octahedral encoding */
+
+static void bench_half_from_float(size_t n)
+{
+    size_t i, j;
+    const float* in = &vin[0].x;
+    unsigned short* out = (unsigned short*)(void*)vout;
+    for (i = 0; i < n; i += 4 * BENCH_BUFSIZE) {
+        for (j = 0; j < 4 * BENCH_BUFSIZE; ++j) {
+            out[j] = half_from_float(in[j]);
+        }
+    }
+    sinku = out[0];
+}
+
+static void bench_half_array_from_float(size_t n)
+{
+    size_t i;
+    unsigned short* out = (unsigned short*)(void*)vout;
+    for (i = 0; i < n; i += 4 * BENCH_BUFSIZE) {
+        half_array_from_float(&vin[0].x, out, 4 * BENCH_BUFSIZE);
+    }
+    sinku = out[0];
+}
+
+static void bench_float_array_from_half(size_t n)
+{
+    size_t i;
+    unsigned short* in = (unsigned short*)(void*)vout;
+    half_array_from_float(&vin[0].x, in, 2 * BENCH_BUFSIZE);
+    for (i = 0; i < n; i += 2 * BENCH_BUFSIZE) {
+        float_array_from_half(in, &vout[BENCH_BUFSIZE / 2].x, 2 * BENCH_BUFSIZE);
+    }
+    sinkf = vout[BENCH_BUFSIZE / 2].x;
+}
+
+static void bench_oct32_array_from_vec3(size_t n)
+{
+    size_t i;
+    unsigned int* out = (unsigned int*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        oct32_array_from_vec3((const vec3*)(const void*)vin, out, BENCH_BUFSIZE);
+    }
+    sinku = out[0];
+}
+
+static void bench_vec3_array_from_oct32(size_t n)
+{
+    size_t i;
+    unsigned int* in = (unsigned int*)(void*)vout;
+    oct32_array_from_vec3((const vec3*)(const void*)vin, in, BENCH_BUFSIZE / 2);
+    for (i = 0; i < n; i += BENCH_BUFSIZE / 2) {
+        vec3_array_from_oct32(in, (vec3*)(void*)&vout[BENCH_BUFSIZE / 2], BENCH_BUFSIZE / 2);
+    }
+    sinkf = vout[BENCH_BUFSIZE / 2].x;
+}
+
+static void bench_vec3_norm(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        const vec4* p = vin + (i & BENCH_MASK);
+        s += vec3_norm(vec3_new(p->x, p->y, p->z)).x;
+    }
+    sinkf = s;
+}
+
+static void bench_vec3_norm_fast(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        const vec4* p = vin + (i & BENCH_MASK);
+        s += vec3_norm_fast(vec3_new(p->x, p->y, p->z)).x;
+    }
+    sinkf = s;
+}
+
+static void bench_vec4_norm(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        s += vec4_norm(vin[i & BENCH_MASK]).x;
+    }
+    sinkf = s;
+}
+
+static void bench_vec3_soa_norm(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        vec3_soa_norm(&soa, &soa);
+    }
+    sinkf = soa.x[0];
+}
+
+static void bench_quat_array_slerp(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_BUFSIZE / 2) {
+        quat_array_slerp(quats, quats + BENCH_BUFSIZE / 2, 0.3F, (quat*)(void*)vout, BENCH_BUFSIZE / 2);
+    }
+    sinkf = vout[0].x;
+}
+
+/* one explicit Euler step per particle, a loop made only of small calls */
+
+static void bench_particles(size_t n)
+{
+    size_t i, j;
+    const float dt = 0.001F;
+    const vec3 gravity = {0.0F, -9.8F, 0.0F};
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        for (j = 0; j < BENCH_BUFSIZE; ++j) {
+            vel[j] = vec3_add(vel[j], vec3_mult(gravity, dt));
+            pos[j] = vec3_add(pos[j], vec3_mult(vel[j], dt));
+        }
+    }
+    sinkf = pos[0].y;
+}
+
+static void bench_vec(void)
+{
+    bench("vec4_mult_mat4", bench_vec4_mult_mat4, 10000000);
+    bench("vec4_mult_mat4_to", bench_vec4_mult_mat4_to, 10000000);
+    bench("vec4_array_mult_mat4", bench_vec4_array_mult_mat4, 10000000);
+    bench("vec3_array_mult_mat4_point", bench_vec3_array_mult_mat4_point, 10000000);
+    bench("vec2_norm", bench_vec2_norm, 10000000);
+    bench("vec2_rotate", bench_vec2_rotate, 10000000);
+    bench("vec2_array_rotate", bench_vec2_array_rotate, 10000000);
+    bench("vec2_array_to_polar", bench_vec2_array_to_polar, 10000000);
+    bench("vec2_array_to_polar_fast", bench_vec2_array_to_polar_fast, 10000000);
+    bench("vec2_array_norm", bench_vec2_array_norm, 10000000);
+    bench("mat3x2_array_model", bench_mat3x2_array_model, 10000000);
+    bench("ivec3_from_vec3_floor", bench_ivec3_from_vec3_floor, 10000000);
+    bench("ivec3_array_from_vec3[floor]", bench_ivec3_array_from_vec3, 10000000);
+    bench("half_from_float", bench_half_from_float, 10000000);
+    bench("half_array_from_float", bench_half_array_from_float, 10000000);
+    bench("float_array_from_half", bench_float_array_from_half, 10000000);
+    bench("oct32_array_from_vec3", bench_oct32_array_from_vec3, 10000000);
+    bench("vec3_array_from_oct32", bench_vec3_array_from_oct32, 10000000);
+    bench("vec3_norm", bench_vec3_norm, 10000000);
+    bench("vec3_norm_fast", bench_vec3_norm_fast, 10000000);
+    bench("vec4_norm", bench_vec4_norm, 10000000);
+    bench("vec3_soa_norm", bench_vec3_soa_norm, 10000000);
+    bench("quat_array_slerp", bench_quat_array_slerp, 10000000);
+    bench("particles", bench_particles, 10000000);
+}
+
+/* culling against a 90 degree frustum looking down -z, objects spread
+around the camera so about a quarter of them are visible */
+
+static void bench_frustum_test_sphere(size_t n)
+{
+    size_t i;
+    unsigned int v = 0;
+    for (i = 0; i < n; ++i) {
+        size_t j = i & BENCH_MASK;
+        sphere s;
+        s.center = vec3_new(spheres.x[j], spheres.y[j], spheres.z[j]);
+        s.radius = spheres.w[j];
+        v += (unsigned int)frustum_test_sphere(&view, s);
+    }
+    sinku = v;
+}
+
+static void bench_frustum_test_spheres(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        frustum_test_spheres(&view, &spheres, visible, 0, BENCH_BUFSIZE);
+    }
+    sinku = visible[0];
+}
+
+static void bench_frustum_test_aabb(size_t n)
+{
+    size_t i;
+    unsigned int v = 0;
+    for (i = 0; i < n; ++i) {
+        size_t j = i & BENCH_MASK;
+        aabb box;
+        box.min = vec3_new(box_min.x[j], box_min.y[j], box_min.z[j]);
+        box.max = vec3_new(box_max.x[j], box_max.y[j], box_max.z[j]);
+        v += (unsigned int)frustum_test_aabb(&view, box);
+    }
+    sinku = v;
+}
+
+static void bench_frustum_test_aabbs(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        frustum_test_aabbs(&view, &box_min, &box_max, visible, 0, BENCH_BUFSIZE);
+    }
+    sinku = visible[0];
+}
+
+static void bench_cull(void)
+{
+    bench("frustum_test_sphere", bench_frustum_test_sphere, 10000000);
+    bench("frustum_test_spheres", bench_frustum_test_spheres, 10000000);
+    bench("frustum_test_aabb", bench_frustum_test_aabb, 10000000);
+    bench("frustum_test_aabbs", bench_frustum_test_aabbs, 10000000);
+}
+
+/* world matrices of a scene of 64 node objects with random parents inside
+each object, all nodes recomputed with mat4_model and mat4_mult against the
+hierarchy with every node or 1 in 64 nodes moved */
+
+static void bench_scene_model_mult(size_t n)
+{
+    size_t i, j;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        for (j = 0; j < BENCH_BUFSIZE; ++j) {
+            mat4 local = mat4_model(scene.translation[j], scene.scale[j], vec3_new(0.0F, 1.0F, 0.0F), buf[j]);
+            int p = scene.parent[j];
+            mout[j] = p < 0 ? local : mat4_mult(mout[p], local);
+        }
+    }
+    sinkf = mout[BENCH_MASK].data[3][0];
+}
+
+static void bench_transform_hierarchy_all(size_t n)
+{
+    size_t i, j;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        for (j = 0; j < BENCH_BUFSIZE; ++j) {
+            scene.dirty[j] = 1;
+        }
+        transform_hierarchy_update(&scene);
+    }
+    sinkf = scene.world[BENCH_MASK].data[3][0];
+}
+
+static void bench_transform_hierarchy_sparse(size_t n)
+{
+    size_t i, j;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        for (j = 48; j < BENCH_BUFSIZE; j += 64) {
+            scene.dirty[j] = 1;
+        }
+        transform_hierarchy_update(&scene);
+    }
+    sinkf = scene.world[BENCH_MASK].data[3][0];
+}
+
+static void bench_scene(void)
+{
+    bench("scene[mat4_model+mat4_mult]", bench_scene_model_mult, 1000000);
+    bench("transform_hierarchy_update[all]", bench_transform_hierarchy_all, 1000000);
+    bench("transform_hierarchy_update[1/64]", bench_transform_hierarchy_sparse, 1000000);
+}
+
+/* rays from random points in [-2, 2] in random directions against a unit
+box, sphere and triangle around the origin, one op is one ray */
+
+static const aabb bench_box = {{-0.5F, -0.5F, -0.5F}, {0.5F, 0.5F, 0.5F}};
+static const sphere bench_sphere = {{0.0F, 0.0F, 0.0F}, 0.5F};
+static const triangle bench_triangle = {{-0.5F, -0.5F, 0.0F}, {0.5F, -0.5F, 0.0F}, {0.0F, 0.5F, 0.0F}};
+
+static void bench_ray_aabb(size_t n)
+{
+    size_t i;
+    unsigned int h = 0;
+    float t = 0.0F;
+    for (i = 0; i < n; ++i) {
+        h += (unsigned int)ray_aabb(rays[i & BENCH_MASK], bench_box, 100.0F, &t);
+    }
+    sinku = h;
+    sinkf = t;
+}
+
+static void bench_ray4_aabb(size_t n)
+{
+    size_t i;
+    unsigned int h = 0;
+    float tmax[4] = {100.0F, 100.0F, 100.0F, 100.0F}, t[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+    for (i = 0; i < n; i += 4) {
+        h += (unsigned int)ray4_aabb(packets4 + ((i / 4) & (BENCH_MASK / 4)), bench_box, tmax, t);
+    }
+    sinku = h;
+    sinkf = t[0];
+}
+
+static void bench_ray8_aabb(size_t n)
+{
+    size_t i;
+    unsigned int h = 0;
+    float tmax[8] = {100.0F, 100.0F, 100.0F, 100.0F, 100.0F, 100.0F, 100.0F, 100.0F};
+    float t[8] = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
+    for (i = 0; i < n; i += 8) {
+        h += (unsigned int)ray8_aabb(packets8 + ((i / 8) & (BENCH_MASK / 8)), bench_box, tmax, t);
+    }
+    sinku = h;
+    sinkf = t[0];
+}
+
+static void bench_ray_sphere(size_t n)
+{
+    size_t i;
+    unsigned int h = 0;
+    float t = 0.0F;
+    for (i = 0; i < n; ++i) {
+        h += (unsigned int)ray_sphere(rays[i & BENCH_MASK], bench_sphere, 100.0F, &t);
+    }
+    sinku = h;
+    sinkf = t;
+}
+
+static void bench_ray8_sphere(size_t n)
+{
+    size_t i;
+    unsigned int h = 0;
+    float tmax[8] = {100.0F, 100.0F, 100.0F, 100.0F, 100.0F, 100.0F, 100.0F, 100.0F};
+    float t[8] = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
+    for (i = 0; i < n; i += 8) {
+        h += (unsigned int)ray8_sphere(packets8 + ((i / 8) & (BENCH_MASK / 8)), bench_sphere, tmax, t);
+    }
+    sinku = h;
+    sinkf = t[0];
+}
+
+static void bench_ray_triangle(size_t n)
+{
+    size_t i;
+    unsigned int h = 0;
+    float t = 0.0F;
+    vec2 uv;
+    for (i = 0; i < n; ++i) {
+        h += (unsigned int)ray_triangle(rays[i & BENCH_MASK], bench_triangle, 100.0F, &t, &uv);
+    }
+    sinku = h;
+    sinkf = t;
+}
+
+static void bench_ray8_triangle(size_t n)
+{
+    size_t i;
+    unsigned int h = 0;
+    float tmax[8] = {100.0F, 100.0F, 100.0F, 100.0F, 100.0F, 100.0F, 100.0F, 100.0F};
+    float t[8] = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
+    float u[8] = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
+    float v[8] = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
+    for (i = 0; i < n; i += 8) {
+        h += (unsigned int)ray8_triangle(packets8 + ((i / 8) & (BENCH_MASK / 8)), bench_triangle, tmax, t, u, v);
+    }
+    sinku = h;
+    sinkf = t[0];
+}
+
+static void bench_ray(void)
+{
+    bench("ray_aabb", bench_ray_aabb, 10000000);
+    bench("ray4_aabb", bench_ray4_aabb, 10000000);
+    bench("ray8_aabb", bench_ray8_aabb, 10000000);
+    bench("ray_sphere", bench_ray_sphere, 10000000);
+    bench("ray8_sphere", bench_ray8_sphere, 10000000);
+    bench("ray_triangle", bench_ray_triangle, 10000000);
+    bench("ray8_triangle", bench_ray8_triangle, 10000000);
+}
+
+/* a height field of BENCH_MESH triangles over [0, 1024] x [0, 512], rays
+from above it pointing down and boxes of size 4 around points on it */
+
+static void bench_bvh_build(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_MESH) {
+        bvh_build(&mesh_bvh, mesh_boxes);
+    }
+    sinku = (unsigned int)mesh_bvh.node_count;
+}
+
+static void bench_bvh_build_tasks(size_t n)
+{
+    size_t i, j, tasks;
+    for (i = 0; i < n; i += BENCH_MESH) {
+        tasks = bvh_build_split(&mesh_bvh, mesh_boxes, 64);
+        for (j = 0; j < tasks; ++j) {
+            bvh_build_task(&mesh_bvh, mesh_boxes, j);
+        }
+    }
+    sinku = (unsigned int)mesh_bvh.node_count;
+}
+
+static void bench_bvh_refit(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_MESH) {
+        bvh_refit(&mesh_bvh, mesh_boxes);
+    }
+    sinkf = mesh_bvh.nodes->max.y;
+}
+
+static void bench_bvh_raycast_triangles(size_t n)
+{
+    size_t i;
+    unsigned int h = 0, prim = 0;
+    float t = 0.0F;
+    for (i = 0; i < n; ++i) {
+        h += (unsigned int)bvh_raycast_triangles(&mesh_bvh, mesh, mesh_rays[i & BENCH_MASK], 100.0F, &t, &prim);
+    }
+    sinku = h + prim;
+    sinkf = t;
+}
+
+static void bench_bvh_query_aabb(size_t n)
+{
+    size_t i, c = 0;
+    for (i = 0; i < n; ++i) {
+        aabb box;
+        box.min = vec3_sub(mesh_rays[i & BENCH_MASK].origin, vec3_new(2.0F, 30.0F, 2.0F));
+        box.max = vec3_sub(mesh_rays[i & BENCH_MASK].origin, vec3_new(-2.0F, 10.0F, -2.0F));
+        c += bvh_query_aabb(&mesh_bvh, mesh_boxes, box, found, BENCH_BUFSIZE);
+    }
+    sinku = (unsigned int)c;
+}
+
+/* points uniform in the unit cube with about 8 per cell, one op of the
+builds is one point, the queries use a radius of one cell */
+
+static void bench_spatial_hash_build(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += cloud_part.count) {
+        spatial_hash_build(grid, &cloud_part);
+    }
+    sinku = grid->start[0];
+}
+
+static void bench_spatial_hash_query_radius(size_t n)
+{
+    size_t i, c = 0;
+    for (i = 0; i < n; ++i) {
+        c += spatial_hash_query_radius(grid, pos[i & BENCH_MASK], grid->cell_size, found, BENCH_BUFSIZE);
+    }
+    sinku = (unsigned int)c;
+}
+
+static void bench_spatial_hash_query_knn(size_t n)
+{
+    size_t i, c = 0;
+    float d[8];
+    for (i = 0; i < n; ++i) {
+        c += spatial_hash_query_knn(grid, pos[i & BENCH_MASK], 8, 1.0F, found, d);
+    }
+    sinku = (unsigned int)c;
+}
+
+/* the point counts of the grids, each with a table of about one bucket per
+point and about 8 points per cell */
+
+static const size_t cloud_sizes[3] = {100000, 1000000, BENCH_CLOUD};
+
+static void bench_spatial_hash_size(int k)
+{
+    grid = grids + k;
+    cloud_part = cloud;
+    cloud_part.count = cloud_sizes[k];
+    spatial_hash_build(grid, &cloud_part);
+}
+
+static void bench_spatial(void)
+{
+    bench_spatial_hash_size(0);
+    bench("spatial_hash_build[100k, per point]", bench_spatial_hash_build, 1000000);
+    bench("spatial_hash_query_radius[100k]", bench_spatial_hash_query_radius, 100000);
+    bench("spatial_hash_query_knn[100k, k = 8]", bench_spatial_hash_query_knn, 100000);
+    bench_spatial_hash_size(1);
+    bench("spatial_hash_build[1M, per point]", bench_spatial_hash_build, 1000000);
+    bench("spatial_hash_query_radius[1M]", bench_spatial_hash_query_radius, 100000);
+    bench("spatial_hash_query_knn[1M, k = 8]", bench_spatial_hash_query_knn, 100000);
+    bench_spatial_hash_size(2);
+    bench("spatial_hash_build[10M, per point]", bench_spatial_hash_build, BENCH_CLOUD);
+    bench("spatial_hash_query_radius[10M]", bench_spatial_hash_query_radius, 100000);
+    bench("spatial_hash_query_knn[10M, k = 8]", bench_spatial_hash_query_knn, 100000);
+}
+
+/* Morton keys of the first BENCH_SORT points of the cloud in the unit cube,
+one op of the sorts is one key */
+
+static const vec3 bench_cube_min = {0.0F, 0.0F, 0.0F};
+static const vec3 bench_cube_max = {1.0F, 1.0F, 1.0F};
+
+static void bench_morton3_from_vec3(size_t n)
+{
+    size_t i;
+    unsigned int h = 0;
+    for (i = 0; i < n; ++i) {
+        h += morton3_from_vec3(pos[i & BENCH_MASK], bench_cube_min, bench_cube_max);
+    }
+    sinku = h;
+}
+
+static void bench_morton3_from_vec3_soa(size_t n)
+{
+    size_t i;
+    cloud_part = cloud;
+    cloud_part.count = BENCH_SORT;
+    for (i = 0; i < n; i += BENCH_SORT) {
+        morton3_from_vec3_soa(&cloud_part, bench_cube_min, bench_cube_max, sort_keys, 0, BENCH_SORT);
+    }
+    sinku = sort_keys[0];
+}
+
+static void bench_sort_fill(void)
+{
+    size_t i;
+    cloud_part = cloud;
+    cloud_part.count = BENCH_SORT;
+    morton3_from_vec3_soa(&cloud_part, bench_cube_min, bench_cube_max, sort_keys, 0, BENCH_SORT);
+    for (i = 0; i < BENCH_SORT; ++i) {
+        sort_values[i] = (unsigned int)i;
+    }
+}
+
+static int bench_compare_keys(const void* a, const void* b)
+{
+    unsigned int p = sort_keys[*(const unsigned int*)a], q = sort_keys[*(const unsigned int*)b];
+    return p < q ? -1 : p > q;
+}
+
+static void bench_qsort(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_SORT) {
+        bench_sort_fill();
+        qsort(sort_values, BENCH_SORT, sizeof(unsigned int), bench_compare_keys);
+    }
+    sinku = sort_values[0];
+}
+
+static void bench_radix_sort(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_SORT) {
+        bench_sort_fill();
+        radix_sort(sort_keys, sort_values, sort_tmp, sort_tmp + BENCH_SORT, BENCH_SORT);
+    }
+    sinku = sort_values[0];
+}
+
+static void bench_zorder(size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i += BENCH_SORT) {
+        bench_sort_fill();
+        radix_sort(sort_keys, sort_values, sort_tmp, sort_tmp + BENCH_SORT, BENCH_SORT);
+        vec3_soa_permute(&cloud_sorted, &cloud_part, sort_values);
+    }
+    sinkf = cloud_sorted.x[0];
+}
+
+static void bench_morton(void)
+{
+    bench("morton3_from_vec3", bench_morton3_from_vec3, 10000000);
+    bench("morton3_from_vec3_soa[1M]", bench_morton3_from_vec3_soa, BENCH_SORT * 4);
+    bench("qsort[1M key/index pairs, with keys]", bench_qsort, BENCH_SORT);
+    bench("radix_sort[1M key/index pairs, with keys]", bench_radix_sort, BENCH_SORT);
+    bench("zorder[1M, keys+radix_sort+vec3_soa_permute]", bench_zorder, BENCH_SORT);
+}
+
+static void bench_bvh(void)
+{
+    bench("bvh_build[per triangle]", bench_bvh_build, BENCH_MESH);
+    bench("bvh_build_split+tasks[64, per triangle]", bench_bvh_build_tasks, BENCH_MESH);
+    bench("bvh_refit[per triangle]", bench_bvh_refit, BENCH_MESH);
+    bench("bvh_raycast_triangles", bench_bvh_raycast_triangles, 100000);
+    bench("bvh_query_aabb", bench_bvh_query_aabb, 100000);
+}
+
+/* approximate math against the C math library, angles in [-10, 10] */
+
+static void bench_sinf(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        s += sinf((buf[i & BENCH_MASK] - 0.5F) * 20.0F);
+    }
+    sinkf = s;
+}
+
+static void bench_sinf_fast(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        s += sinf_fast((buf[i & BENCH_MASK] - 0.5F) * 20.0F);
+    }
+    sinkf = s;
+}
+
+/* independent iterations over a buffer, which the compiler may vectorize */
+
+static void bench_sinf_loop(size_t n)
+{
+    size_t i, j;
+    float* out = (float*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        for (j = 0; j < BENCH_BUFSIZE; ++j) {
+            out[j] = sinf(buf[j]);
+        }
+    }
+    sinkf = out[0];
+}
+
+static void bench_sinf_fast_loop(size_t n)
+{
+    size_t i, j;
+    float* out = (float*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        for (j = 0; j < BENCH_BUFSIZE; ++j) {
+            out[j] = sinf_fast(buf[j]);
+        }
+    }
+    sinkf = out[0];
+}
+
+static void bench_vec2_from_rad(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        vec2 p = vec2_from_rad((buf[i & BENCH_MASK] - 0.5F) * 20.0F);
+        s += p.x + p.y;
+    }
+    sinkf = s;
+}
+
+static void bench_vec2_from_rad_fast(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        vec2 p = vec2_from_rad_fast((buf[i & BENCH_MASK] - 0.5F) * 20.0F);
+        s += p.x + p.y;
+    }
+    sinkf = s;
+}
+
+static void bench_sinf_cosf(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        float x = (buf[i & BENCH_MASK] - 0.5F) * 20.0F;
+        s += sinf(x) + cosf(x);
+    }
+    sinkf = s;
+}
+
+static void bench_spxm_sincosf(size_t n)
+{
+    size_t i;
+    float s = 0.0F, c = 0.0F, ps, pc;
+    for (i = 0; i < n; ++i) {
+        spxm_sincosf((buf[i & BENCH_MASK] - 0.5F) * 20.0F, &ps, &pc);
+        s += ps;
+        c += pc;
+    }
+    sinkf = s + c;
+}
+
+static void bench_spxm_sincosf_array(size_t n)
+{
+    size_t i;
+    float* out = (float*)(void*)vout;
+    for (i = 0; i < n; i += BENCH_BUFSIZE) {
+        spxm_sincosf_array(buf, out, out + BENCH_BUFSIZE, BENCH_BUFSIZE);
+    }
+    sinkf = out[0];
+}
+
+static void bench_sincos_lut_rad(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        vec2 p = sincos_lut_rad(&lut, (buf[i & BENCH_MASK] - 0.5F) * 20.0F);
+        s += p.x + p.y;
+    }
+    sinkf = s;
+}
+
+static void bench_atan2f(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        const vec4* p = vin + (i & BENCH_MASK);
+        s += atan2f(p->x - 0.5F, p->y - 0.5F);
+    }
+    sinkf = s;
+}
+
+static void bench_atan2f_fast(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        const vec4* p = vin + (i & BENCH_MASK);
+        s += atan2f_fast(p->x - 0.5F, p->y - 0.5F);
+    }
+    sinkf = s;
+}
+
+static void bench_rsqrtf(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        s += 1.0F / sqrtf(buf[i & BENCH_MASK] + 1.0F);
+    }
+    sinkf = s;
+}
+
+static void bench_rsqrtf_fast(size_t n)
+{
+    size_t i;
+    float s = 0.0F;
+    for (i = 0; i < n; ++i) {
+        s += rsqrtf_fast(buf[i & BENCH_MASK] + 1.0F);
+    }
+    sinkf = s;
+}
+
+static void bench_math(void)
+{
+    bench("sinf", bench_sinf, 10000000);
+    bench("sinf_fast", bench_sinf_fast, 10000000);
+    bench("sinf[loop]", bench_sinf_loop, 10000000);
+    bench("sinf_fast[loop]", bench_sinf_fast_loop, 10000000);
+    bench("vec2_from_rad", bench_vec2_from_rad, 10000000);
+    bench("vec2_from_rad_fast", bench_vec2_from_rad_fast, 10000000);
+    bench("sinf+cosf", bench_sinf_cosf, 10000000);
+    bench("spxm_sincosf", bench_spxm_sincosf, 10000000);
+    bench("spxm_sincosf_array", bench_spxm_sincosf_array, 10000000);
+    bench("sincos_lut_rad", bench_sincos_lut_rad, 10000000);
+    bench("atan2f", bench_atan2f, 10000000);
+    bench("atan2f_fast", bench_atan2f_fast, 10000000);
+    bench("rsqrtf", bench_rsqrtf, 10000000);
+    bench("rsqrtf_fast", bench_rsqrtf_fast, 10000000);
+}
+
+static int bench_init(void)
+{
+    size_t i;
+    spxrng cloud_rng;
+    buf = (float*)malloc(BENCH_BUFSIZE * sizeof(float));
+    vin = (vec4*)malloc(BENCH_BUFSIZE * sizeof(vec4));
+    vout = (vec4*)malloc(BENCH_BUFSIZE * sizeof(vec4));
+    mats = (mat4*)malloc(BENCH_BUFSIZE * sizeof(mat4));
+    mout = (mat4*)malloc(BENCH_BUFSIZE * sizeof(mat4));
+    quats = (quat*)malloc(BENCH_BUFSIZE * sizeof(quat));
+    pos = (vec3*)malloc(BENCH_BUFSIZE * sizeof(vec3));
+    vel = (vec3*)malloc(BENCH_BUFSIZE * sizeof(vec3));
+    soa = vec3_soa_create(BENCH_BUFSIZE);
+    lut = sincos_lut_create(4096);
+    spheres = vec4_soa_create(BENCH_BUFSIZE);
+    box_min = vec3_soa_create(BENCH_BUFSIZE);
+    box_max = vec3_soa_create(BENCH_BUFSIZE);
+    scene = transform_hierarchy_create(BENCH_BUFSIZE);
+    rays = (ray*)malloc(BENCH_BUFSIZE * sizeof(ray));
+    packets4 = (ray4*)malloc(BENCH_BUFSIZE / 4 * sizeof(ray4));
+    packets8 = (ray8*)malloc(BENCH_BUFSIZE / 8 * sizeof(ray8));
+    mesh = (triangle*)malloc(BENCH_MESH * sizeof(triangle));
+    mesh_boxes = (aabb*)malloc(BENCH_MESH * sizeof(aabb));
+    mesh_bvh = bvh_create(BENCH_MESH);
+    mesh_rays = (ray*)malloc(BENCH_BUFSIZE * sizeof(ray));
+    cloud = vec3_soa_create(BENCH_CLOUD);
+    for (i = 0; i < 3; ++i) {
+        grids[i] = spatial_hash_create(cloud_sizes[i], cloud_sizes[i], (float)pow(8.0 / (double)cloud_sizes[i], 1.0 / 3.0));
+    }
+    cloud_sorted = vec3_soa_create(BENCH_SORT);
+    sort_keys = (unsigned int*)malloc(BENCH_SORT * sizeof(unsigned int));
+    sort_values = (unsigned int*)malloc(BENCH_SORT * sizeof(unsigned int));
+    sort_tmp = (unsigned int*)malloc(BENCH_SORT * 2 * sizeof(unsigned int));
+    if (!cloud_sorted.mem || !sort_keys || !sort_values || !sort_tmp || !cloud.mem || !grids[0].mem || !grids[1].mem || !grids[2].mem || !mesh || !mesh_boxes || !mesh_bvh.mem || !mesh_rays || !rays || !packets4 || !packets8 || !buf || !vin || !vout || !mats || !mout || !quats || !pos || !vel || !soa.mem || !lut.sin
+        || !spheres.mem || !box_min.mem || !box_max.mem || !scene.mem) {
+        return 0;
+    }
+
+    rng = spxrng_new(1);
+    spxrandf_fill_r(&rng, buf, BENCH_BUFSIZE);
+    vec4_rand_fill_r(&rng, vin, BENCH_BUFSIZE);
+    vec4_rand_rotation_fill_r(&rng, (vec4*)(void*)quats, BENCH_BUFSIZE);
+    vec3_rand_fill_r(&rng, pos, BENCH_BUFSIZE);
+    vec3_rand_fill_r(&rng, vel, BENCH_BUFSIZE);
+    for (i = 0; i < BENCH_BUFSIZE; ++i) {
+        mats[i] = quat_to_mat4(quats[i]);
+        soa.x[i] = vin[i].x;
+        soa.y[i] = vin[i].y;
+        soa.z[i] = vin[i].z;
+        spheres.x[i] = box_min.x[i] = (vin[i].x - 0.5F) * 200.0F;
+        spheres.y[i] = box_min.y[i] = (vin[i].y - 0.5F) * 200.0F;
+        spheres.z[i] = box_min.z[i] = (vin[i].z - 0.5F) * 200.0F;
+        spheres.w[i] = vin[i].w * 4.0F;
+        box_max.x[i] = box_min.x[i] + spheres.w[i];
+        box_max.y[i] = box_min.y[i] + spheres.w[i];
+        box_max.z[i] = box_min.z[i] + spheres.w[i];
+        transform_hierarchy_set_parent(&scene, i, i & 63 ? (int)((i & ~(size_t)63) + spxrand_r(&rng) % (i & 63)) : -1);
+        transform_hierarchy_set(&scene, i, pos[i], quat_from_axis_angle(vec3_new(0.0F, 1.0F, 0.0F), buf[i]),
+            vec3_new(1.0F, 1.0F, 1.0F));
+    }
+    for (i = 0; i < BENCH_BUFSIZE; ++i) {
+        rays[i] = ray_new(vec3_mult(vec3_sub(pos[i], vec3_uni(0.5F)), 4.0F), vec3_sub(vel[i], vec3_uni(0.5F)));
+    }
+    for (i = 0; i < BENCH_BUFSIZE / 8; ++i) {
+        packets4[i * 2] = ray4_from_rays(rays + i * 8);
+        packets4[i * 2 + 1] = ray4_from_rays(rays + i * 8 + 4);
+        packets8[i] = ray8_from_rays(rays + i * 8);
+    }
+    for (i = 0; i < BENCH_MESH; ++i) {
+        size_t x = i / 2 % BENCH_MESH_W, z = i / 2 / BENCH_MESH_W;
+        vec3 p[4];
+        int k;
+        for (k = 0; k < 4; ++k) {
+            float px = (float)(x + (k & 1)), pz = (float)(z + (k >> 1));
+            p[k] = vec3_new(px, sinf(px * 0.05F) * cosf(pz * 0.07F) * 8.0F, pz);
+        }
+        mesh[i].a = p[i & 1 ? 3 : 0];
+        mesh[i].b = p[1];
+        mesh[i].c = p[2];
+        mesh_boxes[i] = aabb_from_triangle(mesh[i]);
+    }
+    bvh_build(&mesh_bvh, mesh_boxes);
+    /* the hash generator correlates arrays this long */
+    cloud_rng = spxrng_create(SPXRNG_PCG32, 1, 0);
+    spxrandf_fill_r(&cloud_rng, cloud.x, BENCH_CLOUD);
+    spxrandf_fill_r(&cloud_rng, cloud.y, BENCH_CLOUD);
+    spxrandf_fill_r(&cloud_rng, cloud.z, BENCH_CLOUD);
+    for (i = 0; i < BENCH_BUFSIZE; ++i) {
+        mesh_rays[i] = ray_new(vec3_new(pos[i].x * BENCH_MESH_W, 20.0F, pos[i].z * BENCH_MESH_H),
+            vec3_new(vel[i].x - 0.5F, -1.0F, vel[i].z - 0.5F));
+    }
+    view = frustum_from_mat4(mat4_mult(mat4_perspective_LH(1.5707963F, 1.0F, 0.1F, 100.0F),
+        mat4_look_at_LH(vec3_new(0.0F, 0.0F, 0.0F), vec3_new(0.0F, 0.0F, -1.0F), vec3_new(0.0F, 1.0F, 0.0F))));
+    return 1;
+}
+
+static void bench_free(void)
+{
+    size_t i;
+    free(buf);
+    free(vin);
+    free(vout);
+    free(mats);
+    free(mout);
+    free(quats);
+    free(pos);
+    free(vel);
+    vec3_soa_free(&soa);
+    sincos_lut_free(&lut);
+    vec4_soa_free(&spheres);
+    vec3_soa_free(&box_min);
+    vec3_soa_free(&box_max);
+    transform_hierarchy_free(&scene);
+    free(rays);
+    free(packets4);
+    free(packets8);
+    free(mesh);
+    free(mesh_boxes);
+    bvh_free(&mesh_bvh);
+    free(mesh_rays);
+    vec3_soa_free(&cloud);
+    for (i = 0; i < 3; ++i) {
+        spatial_hash_free(grids + i);
+    }
+    vec3_soa_free(&cloud_sorted);
+    free(sort_keys);
+    free(sort_values);
+    free(sort_tmp);
+}
+
+/* usage: spxmbench [scale] [csv|json] [name filter] */
+
+int main(int argc, char** argv)
+{
+    int i;
+    for (i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "json")) {
+            json = 1;
+        } else if (!strcmp(argv[i], "csv")) {
+            json = 0;
+        } else if (atoi(argv[i]) > 0) {
+            scale = (size_t)atoi(argv[i]);
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    if (!bench_init()) {
+        fprintf(stderr, "could not allocate benchmark buffers\n");
+        bench_free();
+        return EXIT_FAILURE;
+    }
+
+    printf(json ? "[" : "build,name,ns_per_op,ops_per_sec\n");
+    bench_mat4();
+    bench_vec();
+    bench_math();
+    bench_cull();
+    bench_scene();
+    bench_ray();
+    bench_bvh();
+    bench_spatial();
+    bench_morton();
+    bench_random();
+    if (json) {
+        printf("\n]\n");
+    }
+    bench_free();
+    return EXIT_SUCCESS;
+}
@@ -2,6 +2,8 @@
 
 src=test.c
 exe=spxmtest
+benchsrc=bench.c
+benchexe=spxmbench
 header=spxmath.h
 installpath=/usr/local/include
 
@@ -51,6 +53,8 @@ usage() {
     echo "$0 usage:"
     echo -e "\t\t: Compile test.c file with $header"
     echo -e "<source>\t: Compile <source> file with $header"
+    echo -e "check [name]\t: Compile test.c and run its checks"
+    echo -e "bench [csv|json]: Compile and run the benchmarks in bench.c"
     echo -e "help\t\t: Print usage information and available commands"
     echo -e "clean\t\t: Delete compiled executables"
     echo -e "install\t\t: Install $header in $installpath (run with sudo)"
@@ -62,9 +66,14 @@ usage() {
 case "$1" in
     "help")
         usage;;
+    "check")
+        compile $src $exe && ./$exe check ${@:2};;
+    "bench")
+        compile $benchsrc $benchexe && ./$benchexe ${@:2};;
     "clean")
         cleanf a.out
-        cleanf $exe;;
+        cleanf $exe
+        cleanf $benchexe;;
     "install")
         install;;
     "uninstall")
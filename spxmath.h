@@ -58,8 +58,147 @@ graphics, physics and game development.
 
 #define SPXM_RANDMAX 0x7fffffff
 
+/* Random number generator streams derived by spxrng_stream get disjoint
+ranges of this many values, 64 streams of 2^26 values by default */
+
+#ifndef SPXM_RNG_STREAM_SIZE
+#define SPXM_RNG_STREAM_SIZE 0x04000000
+#endif /* SPXM_RNG_STREAM_SIZE */
+
+/* Define SPXM_THREAD_LOCAL to give every thread its own implicit seed
+for spxrand, spxrandf and the other functions without an explicit state */
+
+#ifdef SPXM_THREAD_LOCAL
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#define SPXM_TLS thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define SPXM_TLS _Thread_local
+#elif defined(_MSC_VER)
+#define SPXM_TLS __declspec(thread)
+#elif defined(__GNUC__)
+#define SPXM_TLS __thread
+#else
+#error "spxmath.h: SPXM_THREAD_LOCAL is not supported by this compiler"
+#endif
+#else
+#define SPXM_TLS
+#endif /* SPXM_THREAD_LOCAL */
+
+/* Function storage, every function in spxmath.h is declared with SPXM_API.
+
+By default functions are external and defined once in the translation unit
+that defines SPXM_APPLICATION. Define SPXM_STATIC_INLINE to emit all of them
+as static inline in every translation unit that includes the header, so the
+compiler can inline and vectorize them without LTO. SPXM_FORCE_INLINE does the
+same and also asks the compiler to always inline them. Both imply
+SPXM_APPLICATION, and each translation unit then has its own implicit seed
+for the random functions without an explicit spxrng state. */
+
+#ifdef SPXM_FORCE_INLINE
+#ifndef SPXM_STATIC_INLINE
+#define SPXM_STATIC_INLINE
+#endif
+#endif /* SPXM_FORCE_INLINE */
+
+#ifdef SPXM_STATIC_INLINE
+#ifndef SPXM_APPLICATION
+#define SPXM_APPLICATION
+#endif
+#if defined(__cplusplus) || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L)
+#define SPXM_INLINE inline
+#elif defined(__GNUC__)
+#define SPXM_INLINE __inline__
+#elif defined(_MSC_VER)
+#define SPXM_INLINE __inline
+#else
+#define SPXM_INLINE
+#endif
+#if defined(SPXM_FORCE_INLINE) && defined(_MSC_VER)
+#define SPXM_API static __forceinline
+#elif defined(SPXM_FORCE_INLINE) && defined(__GNUC__)
+#define SPXM_API static SPXM_INLINE __attribute__((always_inline))
+#else
+#define SPXM_API static SPXM_INLINE
+#endif
+#else
+#define SPXM_API
+#endif /* SPXM_STATIC_INLINE */
+
+/* Output pointers of the _to functions are restrict qualified, they must not
+point to any of the inputs. Use the _inplace functions to update in place. */
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L && !defined(__cplusplus)
+#define SPXM_RESTRICT restrict
+#elif defined(__GNUC__)
+#define SPXM_RESTRICT __restrict__
+#elif defined(_MSC_VER)
+#define SPXM_RESTRICT __restrict
+#else
+#define SPXM_RESTRICT
+#endif
+
+/* SIMD Configuration */
+
+/* Vectorized paths are selected at compile time from the target flags
+(SSE2/AVX on x86, NEON on ARM). Define SPXM_NO_SIMD before including
+spxmath.h to force the portable scalar C89 implementation. */
+
+#ifndef SPXM_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPXM_SSE
+#ifdef __AVX__
+#define SPXM_AVX
+#endif /* __AVX__ */
+#ifdef __BMI2__
+#define SPXM_BMI2
+#endif /* __BMI2__ */
+#ifdef __F16C__
+#define SPXM_F16C
+#endif /* __F16C__ */
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SPXM_NEON
+#endif
+#if defined(SPXM_SSE) || defined(SPXM_NEON)
+#define SPXM_SIMD
+#endif
+#endif /* SPXM_NO_SIMD */
+
+/* Alignment, SPXM_ALIGN(n) aligns a struct type to n bytes on compilers that
+support it and can be predefined for others. vec3a is 16 byte aligned wherever
+SPXM_ALIGN works. Define SPXM_ALIGNED to also align vec4 and quat to 16 bytes
+and mat4 to SPXM_MAT4_ALIGNMENT bytes (16 or 32). This changes the ABI of those
+types, so every translation unit must agree on it, and heap arrays need an
+allocator that honours the alignment. 32-bit MSVC cannot pass aligned types by
+value (error C2719), so there SPXM_ALIGN is empty by default and none of the
+types is over-aligned. The kernels only use unaligned loads, so this costs
+speed, not correctness. */
+
+#ifndef SPXM_ALIGN
+#if defined(__GNUC__) || defined(__clang__)
+#define SPXM_ALIGN(n) __attribute__((aligned(n)))
+#elif defined(_MSC_VER) && !defined(_M_IX86)
+#define SPXM_ALIGN(n) __declspec(align(n))
+#else
+#define SPXM_ALIGN(n)
+#endif
+#endif /* SPXM_ALIGN */
+
+#ifndef SPXM_MAT4_ALIGNMENT
+#define SPXM_MAT4_ALIGNMENT 16
+#endif /* SPXM_MAT4_ALIGNMENT */
+
+#ifdef SPXM_ALIGNED
+#define SPXM_ALIGN_VEC4 SPXM_ALIGN(16)
+#define SPXM_ALIGN_MAT4 SPXM_ALIGN(SPXM_MAT4_ALIGNMENT)
+#else
+#define SPXM_ALIGN_VEC4
+#define SPXM_ALIGN_MAT4
+#endif /* SPXM_ALIGNED */
+
 /* Simple Pixel Math */
 
+#include <stddef.h>
+
 
 #ifndef IVEC2_TYPE_DEFINED
 #define IVEC2_TYPE_DEFINED
@@ -109,60 +248,391 @@ typedef struct vec3 {
 #ifndef VEC4_TYPE_DEFINED
 #define VEC4_TYPE_DEFINED
 
-typedef struct vec4 {
+typedef struct SPXM_ALIGN_VEC4 vec4 {
     float x, y, z, w;
 } vec4;
 
 #endif /* VEC4_TYPE_DEFINED */
 
+#ifndef VEC3A_TYPE_DEFINED
+#define VEC3A_TYPE_DEFINED
+
+/* vec3 padded to 16 bytes, one aligned SIMD register per vector */
+
+typedef struct SPXM_ALIGN(16) vec3a {
+    float x, y, z, pad;
+} vec3a;
+
+#endif /* VEC3A_TYPE_DEFINED */
+
+#ifndef QUAT_TYPE_DEFINED
+#define QUAT_TYPE_DEFINED
+
+typedef struct SPXM_ALIGN_VEC4 quat {
+    float x, y, z, w;
+} quat;
+
+#endif /* QUAT_TYPE_DEFINED */
+
 #ifndef MAT4_TYPE_DEFINED
 #define MAT4_TYPE_DEFINED
 
-typedef struct mat4 {
+typedef struct SPXM_ALIGN_MAT4 mat4 {
     float data[4][4];
 } mat4;
 
 #endif /* MAT4_TYPE_DEFINED */
 
-float absf(float n);
-float signf(float n);
-float maxf(float n, float m);
-float minf(float n, float m);
-float clampf(float n, float min, float max);
-float lerpf(float a, float b, float t);
-float ilerpf(float min, float max, float n);
-float smoothlerpf(float a, float b, float t);
-float remapf(float min, float max, float a, float b, float n);
-float rad2deg(float rad);
-float deg2rad(float deg);
-
-unsigned int spxrand(void);
-unsigned int spxrand_hash(unsigned int n);
-unsigned int spxrand_between(unsigned int min, unsigned int max);
-float        spxrandf(void);
-float        spxrandf_hash(unsigned int n);
-float        spxrandf_between(float min, float max);
-void         spxrand_seed_set(unsigned int n);
-unsigned int spxrand_seed_get(void);
-
-vec2 vec2_uni(float n);
-vec2 vec2_new(float x, float y);
-vec2 vec2_rand(void);
-vec2 vec2_add(vec2 p, vec2 q);
-vec2 vec2_sub(vec2 p, vec2 q);
-vec2 vec2_mult(vec2 p, float n);
-vec2 vec2_div(vec2 p, float n);
-vec2 vec2_norm(vec2 p);
-vec2 vec2_cross(vec2 p, vec2 q);
-vec2 vec2_prod(vec2 p, vec2 q);
-vec2 vec2_lerp(vec2 p, vec2 q, float t);
-vec2 vec2_from_rad(float rad);
-float vec2_sqmag(vec2 p);
-float vec2_mag(vec2 p);
-float vec2_sqdist(vec2 p, vec2 q);
-float vec2_dist(vec2 p, vec2 q);
-float vec2_dot(vec2 p, vec2 q);
-float vec2_rads(vec2 p);
+#ifndef MAT3X4_TYPE_DEFINED
+#define MAT3X4_TYPE_DEFINED
+
+/* compact affine transform, the top 3 rows of a mat4 stored row by row */
+
+typedef struct mat3x4 {
+    float data[3][4];
+} mat3x4;
+
+#endif /* MAT3X4_TYPE_DEFINED */
+
+#ifndef MAT3X2_TYPE_DEFINED
+#define MAT3X2_TYPE_DEFINED
+
+/* 2D affine transform, 3 columns of 2 rows like the x and y rows of a mat4,
+data[0] and data[1] are the images of the axes and data[2] the translation */
+
+typedef struct mat3x2 {
+    float data[3][2];
+} mat3x2;
+
+#endif /* MAT3X2_TYPE_DEFINED */
+
+#ifndef SPXRNG_TYPE_DEFINED
+#define SPXRNG_TYPE_DEFINED
+
+/* unsigned 64 bit integer, C89 has no standard name for it */
+
+#if (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L) || \
+    (defined(__cplusplus) && __cplusplus >= 201103L)
+typedef unsigned long long spxu64;
+#elif defined(__UINT64_TYPE__)
+typedef __UINT64_TYPE__ spxu64;
+#elif defined(__GNUC__)
+__extension__ typedef unsigned long long spxu64;
+#elif defined(_MSC_VER)
+typedef unsigned __int64 spxu64;
+#else
+typedef unsigned long spxu64;
+#endif
+
+#define SPXM_U64(hi, lo) (((spxu64)(hi) << 32) | (spxu64)(lo))
+
+/* generator backends for spxrng_create */
+
+#define SPXRNG_HASH 0
+#define SPXRNG_XOSHIRO128P 1
+#define SPXRNG_XOSHIRO256SS 2
+#define SPXRNG_PCG32 3
+#define SPXRNG_PHILOX 4
+
+typedef struct spxrng {
+    unsigned int seed;
+    unsigned int type;
+    unsigned int index;
+    unsigned int buffer[4];
+    spxu64 state[4];
+} spxrng;
+
+#endif /* SPXRNG_TYPE_DEFINED */
+
+/* structure of arrays containers, see vec3_soa_create and vec4_soa_create */
+
+#define SPXM_SOA_ALIGN 32
+#define SPXM_SOA_WIDTH 8
+
+#ifndef VEC3_SOA_TYPE_DEFINED
+#define VEC3_SOA_TYPE_DEFINED
+
+typedef struct vec3_soa {
+    float* x;
+    float* y;
+    float* z;
+    size_t count;
+    void* mem;
+} vec3_soa;
+
+#endif /* VEC3_SOA_TYPE_DEFINED */
+
+#ifndef VEC4_SOA_TYPE_DEFINED
+#define VEC4_SOA_TYPE_DEFINED
+
+typedef struct vec4_soa {
+    float* x;
+    float* y;
+    float* z;
+    float* w;
+    size_t count;
+    void* mem;
+} vec4_soa;
+
+#endif /* VEC4_SOA_TYPE_DEFINED */
+
+/* sine table for quantized angles, see sincos_lut_create */
+
+#ifndef SINCOS_LUT_TYPE_DEFINED
+#define SINCOS_LUT_TYPE_DEFINED
+
+typedef struct sincos_lut {
+    float* sin;
+    unsigned int size;
+    unsigned int mask;
+    float steps_per_rad;
+} sincos_lut;
+
+#endif /* SINCOS_LUT_TYPE_DEFINED */
+
+/* bounding volumes and view frustums, see frustum_from_mat4 */
+
+#ifndef PLANE_TYPE_DEFINED
+#define PLANE_TYPE_DEFINED
+
+typedef struct plane {
+    vec3 n;
+    float d;
+} plane;
+
+#endif /* PLANE_TYPE_DEFINED */
+
+#ifndef FRUSTUM_TYPE_DEFINED
+#define FRUSTUM_TYPE_DEFINED
+
+typedef struct frustum {
+    plane planes[6];
+} frustum;
+
+#endif /* FRUSTUM_TYPE_DEFINED */
+
+#ifndef AABB_TYPE_DEFINED
+#define AABB_TYPE_DEFINED
+
+typedef struct aabb {
+    vec3 min;
+    vec3 max;
+} aabb;
+
+#endif /* AABB_TYPE_DEFINED */
+
+#ifndef SPHERE_TYPE_DEFINED
+#define SPHERE_TYPE_DEFINED
+
+typedef struct sphere {
+    vec3 center;
+    float radius;
+} sphere;
+
+#endif /* SPHERE_TYPE_DEFINED */
+
+/* rays, triangles and packets of 4 and 8 rays with one array per component */
+
+#ifndef RAY_TYPE_DEFINED
+#define RAY_TYPE_DEFINED
+
+typedef struct ray {
+    vec3 origin;
+    vec3 dir;
+} ray;
+
+#endif /* RAY_TYPE_DEFINED */
+
+#ifndef TRIANGLE_TYPE_DEFINED
+#define TRIANGLE_TYPE_DEFINED
+
+typedef struct triangle {
+    vec3 a, b, c;
+} triangle;
+
+#endif /* TRIANGLE_TYPE_DEFINED */
+
+#ifndef RAY4_TYPE_DEFINED
+#define RAY4_TYPE_DEFINED
+
+typedef struct ray4 {
+    float ox[4], oy[4], oz[4];
+    float dx[4], dy[4], dz[4];
+} ray4;
+
+#endif /* RAY4_TYPE_DEFINED */
+
+#ifndef RAY8_TYPE_DEFINED
+#define RAY8_TYPE_DEFINED
+
+typedef struct ray8 {
+    float ox[8], oy[8], oz[8];
+    float dx[8], dy[8], dz[8];
+} ray8;
+
+#endif /* RAY8_TYPE_DEFINED */
+
+/* bounding volume hierarchy over boxes, see bvh_create */
+
+#define SPXM_BVH_LEAF_SIZE 8
+#define SPXM_BVH_MAX_TASKS 256
+
+#ifndef BVH_TYPE_DEFINED
+#define BVH_TYPE_DEFINED
+
+typedef struct bvh_node {
+    vec3 min;
+    unsigned int first;
+    vec3 max;
+    unsigned int count;
+} bvh_node;
+
+typedef struct bvh {
+    bvh_node* nodes;
+    unsigned int* indices;
+    unsigned int* tasks;
+    size_t node_count;
+    size_t count;
+    size_t task_count;
+    void* mem;
+} bvh;
+
+#endif /* BVH_TYPE_DEFINED */
+
+/* uniform grid of hashed cells over points, see spatial_hash_create */
+
+#ifndef SPATIAL_HASH_TYPE_DEFINED
+#define SPATIAL_HASH_TYPE_DEFINED
+
+typedef struct spatial_hash {
+    unsigned int* start;
+    unsigned int* keys;
+    unsigned int* indices;
+    float* x;
+    float* y;
+    float* z;
+    size_t count;
+    size_t capacity;
+    size_t table_size;
+    float cell_size;
+    void* mem;
+} spatial_hash;
+
+#endif /* SPATIAL_HASH_TYPE_DEFINED */
+
+/* flat transform hierarchy, see transform_hierarchy_create */
+
+#ifndef TRANSFORM_HIERARCHY_TYPE_DEFINED
+#define TRANSFORM_HIERARCHY_TYPE_DEFINED
+
+typedef struct transform_hierarchy {
+    mat4* world;
+    quat* rotation;
+    vec3* translation;
+    vec3* scale;
+    int* parent;
+    unsigned char* dirty;
+    size_t count;
+    void* mem;
+} transform_hierarchy;
+
+#endif /* TRANSFORM_HIERARCHY_TYPE_DEFINED */
+
+SPXM_API float absf(float n);
+SPXM_API float signf(float n);
+SPXM_API float maxf(float n, float m);
+SPXM_API float minf(float n, float m);
+SPXM_API float clampf(float n, float min, float max);
+SPXM_API float lerpf(float a, float b, float t);
+SPXM_API float ilerpf(float min, float max, float n);
+SPXM_API float smoothlerpf(float a, float b, float t);
+SPXM_API float remapf(float min, float max, float a, float b, float n);
+SPXM_API float rad2deg(float rad);
+SPXM_API float deg2rad(float deg);
+SPXM_API float rsqrtf_fast(float n);
+SPXM_API float sinf_fast(float rad);
+SPXM_API float cosf_fast(float rad);
+SPXM_API float atan2f_fast(float y, float x);
+SPXM_API void spxm_sincosf(float rad, float* s, float* c);
+SPXM_API void spxm_sincosf_array(const float* rad, float* s, float* c, size_t count);
+SPXM_API sincos_lut sincos_lut_create(unsigned int size);
+SPXM_API void sincos_lut_free(sincos_lut* lut);
+SPXM_API vec2 sincos_lut_step(const sincos_lut* lut, unsigned int step);
+SPXM_API vec2 sincos_lut_rad(const sincos_lut* lut, float rad);
+
+SPXM_API unsigned int spxrand(void);
+SPXM_API unsigned int spxrand_hash(unsigned int n);
+SPXM_API unsigned int spxrand_between(unsigned int min, unsigned int max);
+SPXM_API float        spxrandf(void);
+SPXM_API float        spxrandf_hash(unsigned int n);
+SPXM_API float        spxrandf_between(float min, float max);
+SPXM_API void         spxrand_seed_set(unsigned int n);
+SPXM_API unsigned int spxrand_seed_get(void);
+
+SPXM_API void spxrand_fill(unsigned int* out, size_t count);
+SPXM_API void spxrand_hash_fill(unsigned int n, unsigned int* out, size_t count);
+SPXM_API void spxrandf_fill(float* out, size_t count);
+SPXM_API void spxrandf_hash_fill(unsigned int n, float* out, size_t count);
+
+SPXM_API spxrng       spxrng_new(unsigned int seed);
+SPXM_API spxrng       spxrng_stream(unsigned int seed, unsigned int stream);
+SPXM_API spxrng       spxrng_create(unsigned int type, spxu64 seed, spxu64 stream);
+SPXM_API unsigned int spxrand32_r(spxrng* rng);
+SPXM_API spxu64       spxrand64_r(spxrng* rng);
+SPXM_API unsigned int spxrand_bounded_r(spxrng* rng, unsigned int range);
+SPXM_API float        spxrandf_bits(unsigned int bits);
+SPXM_API unsigned int spxrand_r(spxrng* rng);
+SPXM_API unsigned int spxrand_between_r(spxrng* rng, unsigned int min, unsigned int max);
+SPXM_API float        spxrandf_r(spxrng* rng);
+SPXM_API float        spxrandf_between_r(spxrng* rng, float min, float max);
+SPXM_API void         spxrand_fill_r(spxrng* rng, unsigned int* out, size_t count);
+SPXM_API void         spxrandf_fill_r(spxrng* rng, float* out, size_t count);
+
+SPXM_API void spxrandf_normal_fill(float* out, size_t count);
+SPXM_API void spxrandf_normal_fill_r(spxrng* rng, float* out, size_t count);
+SPXM_API void vec2_rand_disk_fill(vec2* out, size_t count);
+SPXM_API void vec2_rand_disk_fill_r(spxrng* rng, vec2* out, size_t count);
+SPXM_API void vec3_rand_sphere_fill(vec3* out, size_t count);
+SPXM_API void vec3_rand_sphere_fill_r(spxrng* rng, vec3* out, size_t count);
+SPXM_API void vec3_rand_hemisphere_fill(vec3* out, size_t count);
+SPXM_API void vec3_rand_hemisphere_fill_r(spxrng* rng, vec3* out, size_t count);
+SPXM_API void vec4_rand_rotation_fill(vec4* out, size_t count);
+SPXM_API void vec4_rand_rotation_fill_r(spxrng* rng, vec4* out, size_t count);
+
+SPXM_API vec2 vec2_uni(float n);
+SPXM_API vec2 vec2_new(float x, float y);
+SPXM_API vec2 vec2_rand(void);
+SPXM_API void vec2_rand_fill(vec2* out, size_t count);
+SPXM_API vec2 vec2_rand_r(spxrng* rng);
+SPXM_API void vec2_rand_fill_r(spxrng* rng, vec2* out, size_t count);
+SPXM_API vec2 vec2_add(vec2 p, vec2 q);
+SPXM_API vec2 vec2_sub(vec2 p, vec2 q);
+SPXM_API vec2 vec2_mult(vec2 p, float n);
+SPXM_API vec2 vec2_div(vec2 p, float n);
+SPXM_API vec2 vec2_norm(vec2 p);
+SPXM_API vec2 vec2_norm_fast(vec2 p);
+SPXM_API vec2 vec2_cross(vec2 p, vec2 q);
+SPXM_API vec2 vec2_prod(vec2 p, vec2 q);
+SPXM_API vec2 vec2_lerp(vec2 p, vec2 q, float t);
+SPXM_API vec2 vec2_from_rad(float rad);
+SPXM_API vec2 vec2_from_rad_fast(float rad);
+SPXM_API vec2 vec2_from_sincos(float s, float c);
+SPXM_API float vec2_sqmag(vec2 p);
+SPXM_API float vec2_mag(vec2 p);
+SPXM_API float vec2_sqdist(vec2 p, vec2 q);
+SPXM_API float vec2_dist(vec2 p, vec2 q);
+SPXM_API float vec2_dot(vec2 p, vec2 q);
+SPXM_API float vec2_rads(vec2 p);
+SPXM_API float vec2_rads_fast(vec2 p);
+SPXM_API vec2 vec2_rotate(vec2 p, float rad);
+
+SPXM_API void vec2_array_rotate(const vec2* in, const float* rad, vec2* out, size_t count);
+SPXM_API void vec2_array_from_polar(const float* rad, const float* mag, vec2* out, size_t count);
+SPXM_API void vec2_array_to_polar(const vec2* in, float* rad, float* mag, size_t count);
+SPXM_API void vec2_array_to_polar_fast(const vec2* in, float* rad, float* mag, size_t count);
+SPXM_API void vec2_array_norm(const vec2* in, vec2* out, size_t count);
+SPXM_API void vec2_array_norm_fast(const vec2* in, vec2* out, size_t count);
+SPXM_API void vec2_array_cross(const vec2* p, const vec2* q, vec2* out, size_t count);
 
 #define vec2_rads_inline(p) atan2f(p.y, p.x)
 #define vec2_sqmag_inline(p) (p.x * p.x + p.y * p.y)
@@ -181,63 +651,334 @@ float vec2_rads(vec2 p);
 #define vec2_cross_inline(p, q) do \
 { float n = p.x - q.x; p.x = -(p.y - q.y); p.y = n; } while (0)
 
-vec3 vec3_uni(float n);
-vec3 vec3_new(float x, float y, float z);
-vec3 vec3_rand(void);
-vec3 vec3_add(vec3 p, vec3 q);
-vec3 vec3_sub(vec3 p, vec3 q);
-vec3 vec3_mult(vec3 p, float f);
-vec3 vec3_div(vec3 p, float f);
-vec3 vec3_norm(vec3 p);
-vec3 vec3_cross(vec3 p, vec3 q);
-vec3 vec3_prod(vec3 p, vec3 q);
-vec3 vec3_lerp(vec3 p, vec3 q, float t);
-float vec3_sqmag(vec3 p);
-float vec3_mag(vec3 p);
-float vec3_sqdist(vec3 p, vec3 q);
-float vec3_dist(vec3 p, vec3 q);
-float vec3_dot(vec3 p, vec3 q);
-
-vec4 vec4_uni(float n);
-vec4 vec4_new(float x, float y, float z, float w);
-vec4 vec4_rand(void);
-vec4 vec4_add(vec4 p, vec4 q);
-vec4 vec4_sub(vec4 p, vec4 q);
-vec4 vec4_mult(vec4 p, float n);
-vec4 vec4_div(vec4 p, float n);
-vec4 vec4_norm(vec4 p);
-vec4 vec4_prod(vec4 a, vec4 b);
-vec4 vec4_lerp(vec4 a, vec4 b, float t);
-float vec4_sqmag(vec4 p);
-float vec4_mag(vec4 p);
-float vec4_sqdist(vec4 p, vec4 q);
-float vec4_dist(vec4 p, vec4 q);
-float vec4_dot(vec4 p, vec4 q);
-vec4 vec4_mult_mat4(vec4 p, mat4 m);
-
-mat4 mat4_id(void);
-mat4 mat4_zero(void);
-mat4 mat4_translate(mat4 m, vec3 p);
-mat4 mat4_mult(mat4 m1, mat4 m2);
-mat4 mat4_mult_vec4(mat4 m, vec4 v);
-mat4 mat4_mult_vec3(mat4 m, vec3 v);
-mat4 mat4_scale(mat4 m, vec3 v);
-mat4 mat4_rot(mat4 m, float deg, vec3 rot_axis);
-mat4 mat4_perspective_RH(float fov, float aspect, float near, float far);
-mat4 mat4_perspective_LH(float fov, float aspect, float near, float far);
-mat4 mat4_look_at_RH(vec3 eye_position, vec3 eye_direction, vec3 eye_up);
-mat4 mat4_look_at_LH(vec3 eye_position, vec3 eye_direction, vec3 eye_up);
-mat4 mat4_ortho(float left, float right, float bottom, float top);
-mat4 mat4_perspective(float fov, float aspect, float near, float far);
-mat4 mat4_look_at(vec3 eye_position, vec3 eye_direction, vec3 eye_up);
-mat4 mat4_model(vec3 translation, vec3 scale, vec3 rot_axis, float rot_degs);
-
-vec2 vec2_from_ivec2(ivec2 p);
-vec3 vec3_from_ivec3(ivec3 p);
-vec4 vec4_from_ivec4(ivec4 p);
-ivec2 ivec2_from_vec2(vec2 p);
-ivec3 ivec3_from_vec3(vec3 p);
-ivec4 ivec4_from_vec4(vec4 p);
+SPXM_API vec3 vec3_uni(float n);
+SPXM_API vec3 vec3_new(float x, float y, float z);
+SPXM_API vec3 vec3_rand(void);
+SPXM_API void vec3_rand_fill(vec3* out, size_t count);
+SPXM_API vec3 vec3_rand_r(spxrng* rng);
+SPXM_API void vec3_rand_fill_r(spxrng* rng, vec3* out, size_t count);
+SPXM_API vec3 vec3_add(vec3 p, vec3 q);
+SPXM_API vec3 vec3_sub(vec3 p, vec3 q);
+SPXM_API vec3 vec3_mult(vec3 p, float f);
+SPXM_API vec3 vec3_div(vec3 p, float f);
+SPXM_API vec3 vec3_norm(vec3 p);
+SPXM_API vec3 vec3_norm_fast(vec3 p);
+SPXM_API vec3 vec3_cross(vec3 p, vec3 q);
+SPXM_API vec3 vec3_prod(vec3 p, vec3 q);
+SPXM_API vec3 vec3_lerp(vec3 p, vec3 q, float t);
+SPXM_API float vec3_sqmag(vec3 p);
+SPXM_API float vec3_mag(vec3 p);
+SPXM_API float vec3_sqdist(vec3 p, vec3 q);
+SPXM_API float vec3_dist(vec3 p, vec3 q);
+SPXM_API float vec3_dot(vec3 p, vec3 q);
+
+SPXM_API vec4 vec4_uni(float n);
+SPXM_API vec4 vec4_new(float x, float y, float z, float w);
+SPXM_API vec4 vec4_rand(void);
+SPXM_API void vec4_rand_fill(vec4* out, size_t count);
+SPXM_API vec4 vec4_rand_r(spxrng* rng);
+SPXM_API void vec4_rand_fill_r(spxrng* rng, vec4* out, size_t count);
+SPXM_API vec4 vec4_add(vec4 p, vec4 q);
+SPXM_API vec4 vec4_sub(vec4 p, vec4 q);
+SPXM_API vec4 vec4_mult(vec4 p, float n);
+SPXM_API vec4 vec4_div(vec4 p, float n);
+SPXM_API vec4 vec4_norm(vec4 p);
+SPXM_API vec4 vec4_norm_fast(vec4 p);
+SPXM_API vec4 vec4_prod(vec4 a, vec4 b);
+SPXM_API vec4 vec4_lerp(vec4 a, vec4 b, float t);
+SPXM_API float vec4_sqmag(vec4 p);
+SPXM_API float vec4_mag(vec4 p);
+SPXM_API float vec4_sqdist(vec4 p, vec4 q);
+SPXM_API float vec4_dist(vec4 p, vec4 q);
+SPXM_API float vec4_dot(vec4 p, vec4 q);
+SPXM_API vec4 vec4_mult_mat4(vec4 p, mat4 m);
+SPXM_API void vec4_add_to(vec4* SPXM_RESTRICT out, const vec4* p, const vec4* q);
+SPXM_API void vec4_sub_to(vec4* SPXM_RESTRICT out, const vec4* p, const vec4* q);
+SPXM_API void vec4_mult_to(vec4* SPXM_RESTRICT out, const vec4* p, float n);
+SPXM_API void vec4_prod_to(vec4* SPXM_RESTRICT out, const vec4* p, const vec4* q);
+SPXM_API void vec4_lerp_to(vec4* SPXM_RESTRICT out, const vec4* p, const vec4* q, float t);
+SPXM_API void vec4_norm_to(vec4* SPXM_RESTRICT out, const vec4* p);
+SPXM_API void vec4_mult_mat4_to(vec4* SPXM_RESTRICT out, const vec4* p, const mat4* m);
+
+SPXM_API void vec4_array_mult_mat4(const mat4* m, const vec4* in, vec4* out, size_t count);
+SPXM_API void vec3_array_mult_mat4_point(const mat4* m, const vec3* in, vec3* out, size_t count);
+SPXM_API void vec3_array_mult_mat4_dir(const mat4* m, const vec3* in, vec3* out, size_t count);
+SPXM_API void vec4_array_mult_mat4_stride(const mat4* m, const void* in, size_t in_stride, void* out, size_t out_stride, size_t count);
+SPXM_API void vec3_array_mult_mat4_point_stride(const mat4* m, const void* in, size_t in_stride, void* out, size_t out_stride, size_t count);
+SPXM_API void vec3_array_mult_mat4_dir_stride(const mat4* m, const void* in, size_t in_stride, void* out, size_t out_stride, size_t count);
+
+SPXM_API mat4 mat4_id(void);
+SPXM_API mat4 mat4_zero(void);
+SPXM_API mat4 mat4_translate(mat4 m, vec3 p);
+SPXM_API mat4 mat4_mult(mat4 m1, mat4 m2);
+SPXM_API void mat4_mult_to(mat4* SPXM_RESTRICT out, const mat4* m1, const mat4* m2);
+SPXM_API void mat4_mult_inplace(mat4* m1, const mat4* m2);
+SPXM_API mat4 mat4_mult_vec4(mat4 m, vec4 v);
+SPXM_API mat4 mat4_mult_vec3(mat4 m, vec3 v);
+SPXM_API mat4 mat4_scale(mat4 m, vec3 v);
+SPXM_API mat4 mat4_rot(mat4 m, float deg, vec3 rot_axis);
+SPXM_API mat4 mat4_rot_sincos(mat4 m, float s, float c, vec3 rot_axis);
+SPXM_API mat4 mat4_perspective_RH(float fov, float aspect, float near, float far);
+SPXM_API mat4 mat4_perspective_LH(float fov, float aspect, float near, float far);
+SPXM_API mat4 mat4_look_at_RH(vec3 eye_position, vec3 eye_direction, vec3 eye_up);
+SPXM_API mat4 mat4_look_at_LH(vec3 eye_position, vec3 eye_direction, vec3 eye_up);
+SPXM_API mat4 mat4_ortho(float left, float right, float bottom, float top);
+SPXM_API mat4 mat4_perspective(float fov, float aspect, float near, float far);
+SPXM_API mat4 mat4_look_at(vec3 eye_position, vec3 eye_direction, vec3 eye_up);
+SPXM_API mat4 mat4_model(vec3 translation, vec3 scale, vec3 rot_axis, float rot_degs);
+SPXM_API void mat4_model_to(mat4* SPXM_RESTRICT out, vec3 translation, vec3 scale, vec3 rot_axis, float rot_degs);
+SPXM_API void mat4_translate_inplace(mat4* m, vec3 p);
+SPXM_API void mat4_scale_inplace(mat4* m, vec3 p);
+SPXM_API void mat4_rot_inplace(mat4* m, float deg, vec3 rot_axis);
+SPXM_API void mat4_rot_sincos_inplace(mat4* m, float s, float c, vec3 rot_axis);
+SPXM_API mat4 mat4_mult_affine(mat4 m1, mat4 m2);
+SPXM_API void mat4_mult_affine_to(mat4* out, const mat4* m1, const mat4* m2);
+SPXM_API mat4 mat4_inverse_affine(mat4 m);
+SPXM_API mat4 mat4_inverse_rigid(mat4 m);
+SPXM_API mat4 mat4_inverse(mat4 m);
+SPXM_API void mat4_inverse_to(mat4* out, const mat4* m);
+SPXM_API mat4 mat4_transpose(mat4 m);
+SPXM_API float mat4_det(mat4 m);
+SPXM_API void mat4_array_inverse(const mat4* in, mat4* out, size_t count);
+SPXM_API void mat4_array_transpose(const mat4* in, mat4* out, size_t count);
+SPXM_API void mat4_array_det(const mat4* in, float* out, size_t count);
+
+SPXM_API mat3x4 mat3x4_id(void);
+SPXM_API mat3x4 mat3x4_from_mat4(mat4 m);
+SPXM_API mat4 mat4_from_mat3x4(mat3x4 m);
+SPXM_API mat3x4 mat3x4_mult(mat3x4 m1, mat3x4 m2);
+SPXM_API void mat3x4_mult_to(mat3x4* out, const mat3x4* m1, const mat3x4* m2);
+SPXM_API mat3x4 mat3x4_inverse(mat3x4 m);
+SPXM_API vec3 vec3_mult_mat3x4_point(vec3 p, mat3x4 m);
+SPXM_API vec3 vec3_mult_mat3x4_dir(vec3 p, mat3x4 m);
+
+SPXM_API mat3x2 mat3x2_id(void);
+SPXM_API mat3x2 mat3x2_model(vec2 translation, vec2 scale, float rad);
+SPXM_API mat3x2 mat3x2_mult(mat3x2 m1, mat3x2 m2);
+SPXM_API mat3x2 mat3x2_inverse(mat3x2 m);
+SPXM_API mat4 mat4_from_mat3x2(mat3x2 m);
+SPXM_API vec2 vec2_mult_mat3x2_point(vec2 p, mat3x2 m);
+SPXM_API vec2 vec2_mult_mat3x2_dir(vec2 p, mat3x2 m);
+SPXM_API void vec2_array_mult_mat3x2_point(const mat3x2* m, const vec2* in, vec2* out, size_t count);
+SPXM_API void mat3x2_array_model(const vec2* translation, const vec2* scale, const float* rad, mat3x2* out, size_t count);
+
+SPXM_API quat quat_id(void);
+SPXM_API quat quat_new(float x, float y, float z, float w);
+SPXM_API quat quat_from_axis_angle(vec3 axis, float rad);
+SPXM_API quat quat_from_mat4(mat4 m);
+SPXM_API quat quat_mult(quat p, quat q);
+SPXM_API quat quat_conj(quat q);
+SPXM_API quat quat_norm(quat q);
+SPXM_API quat quat_nlerp(quat p, quat q, float t);
+SPXM_API quat quat_slerp(quat p, quat q, float t);
+SPXM_API float quat_dot(quat p, quat q);
+SPXM_API vec3 quat_rotate_vec3(quat q, vec3 v);
+SPXM_API mat4 quat_to_mat4(quat q);
+SPXM_API mat4 mat4_model_quat(vec3 translation, vec3 scale, quat rot);
+
+SPXM_API void quat_array_mult(const quat* p, const quat* q, quat* out, size_t count);
+SPXM_API void quat_array_nlerp(const quat* p, const quat* q, float t, quat* out, size_t count);
+SPXM_API void quat_array_slerp(const quat* p, const quat* q, float t, quat* out, size_t count);
+SPXM_API void quat_array_rotate_vec3(const quat* q, const vec3* in, vec3* out, size_t count);
+SPXM_API void quat_array_to_mat4(const quat* q, mat4* out, size_t count);
+
+SPXM_API vec3a vec3a_new(float x, float y, float z);
+SPXM_API vec3a vec3a_from_vec3(vec3 p);
+SPXM_API vec3 vec3_from_vec3a(vec3a p);
+SPXM_API void vec3a_array_from_vec3(const vec3* in, vec3a* out, size_t count);
+SPXM_API void vec3_array_from_vec3a(const vec3a* in, vec3* out, size_t count);
+SPXM_API void vec3a_array_mult_mat4_point(const mat4* m, const vec3a* in, vec3a* out, size_t count);
+SPXM_API void vec3a_array_mult_mat4_dir(const mat4* m, const vec3a* in, vec3a* out, size_t count);
+
+SPXM_API vec2 vec2_from_ivec2(ivec2 p);
+SPXM_API vec3 vec3_from_ivec3(ivec3 p);
+SPXM_API vec4 vec4_from_ivec4(ivec4 p);
+SPXM_API ivec2 ivec2_from_vec2(vec2 p);
+SPXM_API ivec3 ivec3_from_vec3(vec3 p);
+SPXM_API ivec4 ivec4_from_vec4(vec4 p);
+SPXM_API ivec2 ivec2_from_vec2_floor(vec2 p);
+SPXM_API ivec3 ivec3_from_vec3_floor(vec3 p);
+SPXM_API ivec4 ivec4_from_vec4_floor(vec4 p);
+SPXM_API ivec2 ivec2_from_vec2_round(vec2 p);
+SPXM_API ivec3 ivec3_from_vec3_round(vec3 p);
+SPXM_API ivec4 ivec4_from_vec4_round(vec4 p);
+
+/* rounding of the float to integer batch conversions */
+
+#define SPXM_ROUND_TRUNC 0
+#define SPXM_ROUND_FLOOR 1
+#define SPXM_ROUND_NEAREST 2
+
+SPXM_API void ivec2_array_from_vec2(const vec2* in, ivec2* out, size_t count, int rounding);
+SPXM_API void ivec3_array_from_vec3(const vec3* in, ivec3* out, size_t count, int rounding);
+SPXM_API void ivec4_array_from_vec4(const vec4* in, ivec4* out, size_t count, int rounding);
+SPXM_API void vec2_array_from_ivec2(const ivec2* in, vec2* out, size_t count);
+SPXM_API void vec3_array_from_ivec3(const ivec3* in, vec3* out, size_t count);
+SPXM_API void vec4_array_from_ivec4(const ivec4* in, vec4* out, size_t count);
+
+SPXM_API ivec2 ivec2_new(int x, int y);
+SPXM_API ivec2 ivec2_add(ivec2 p, ivec2 q);
+SPXM_API ivec2 ivec2_sub(ivec2 p, ivec2 q);
+SPXM_API ivec2 ivec2_mult(ivec2 p, int n);
+SPXM_API ivec2 ivec2_prod(ivec2 p, ivec2 q);
+SPXM_API ivec2 ivec2_min(ivec2 p, ivec2 q);
+SPXM_API ivec2 ivec2_max(ivec2 p, ivec2 q);
+SPXM_API ivec2 ivec2_clamp(ivec2 p, ivec2 min, ivec2 max);
+SPXM_API int ivec2_dot(ivec2 p, ivec2 q);
+SPXM_API int ivec2_manhattan(ivec2 p, ivec2 q);
+
+SPXM_API ivec3 ivec3_new(int x, int y, int z);
+SPXM_API ivec3 ivec3_add(ivec3 p, ivec3 q);
+SPXM_API ivec3 ivec3_sub(ivec3 p, ivec3 q);
+SPXM_API ivec3 ivec3_mult(ivec3 p, int n);
+SPXM_API ivec3 ivec3_prod(ivec3 p, ivec3 q);
+SPXM_API ivec3 ivec3_min(ivec3 p, ivec3 q);
+SPXM_API ivec3 ivec3_max(ivec3 p, ivec3 q);
+SPXM_API ivec3 ivec3_clamp(ivec3 p, ivec3 min, ivec3 max);
+SPXM_API int ivec3_dot(ivec3 p, ivec3 q);
+SPXM_API int ivec3_manhattan(ivec3 p, ivec3 q);
+
+SPXM_API ivec4 ivec4_new(int x, int y, int z, int w);
+SPXM_API ivec4 ivec4_add(ivec4 p, ivec4 q);
+SPXM_API ivec4 ivec4_sub(ivec4 p, ivec4 q);
+SPXM_API ivec4 ivec4_mult(ivec4 p, int n);
+SPXM_API ivec4 ivec4_prod(ivec4 p, ivec4 q);
+SPXM_API ivec4 ivec4_min(ivec4 p, ivec4 q);
+SPXM_API ivec4 ivec4_max(ivec4 p, ivec4 q);
+SPXM_API ivec4 ivec4_clamp(ivec4 p, ivec4 min, ivec4 max);
+SPXM_API int ivec4_dot(ivec4 p, ivec4 q);
+SPXM_API int ivec4_manhattan(ivec4 p, ivec4 q);
+
+SPXM_API vec3_soa vec3_soa_create(size_t count);
+SPXM_API void vec3_soa_free(vec3_soa* soa);
+SPXM_API void vec3_soa_from_vec3(vec3_soa* soa, const vec3* in);
+SPXM_API void vec3_soa_to_vec3(const vec3_soa* soa, vec3* out);
+SPXM_API void vec3_soa_add(vec3_soa* out, const vec3_soa* p, const vec3_soa* q);
+SPXM_API void vec3_soa_sub(vec3_soa* out, const vec3_soa* p, const vec3_soa* q);
+SPXM_API void vec3_soa_mult(vec3_soa* out, const vec3_soa* p, float n);
+SPXM_API void vec3_soa_prod(vec3_soa* out, const vec3_soa* p, const vec3_soa* q);
+SPXM_API void vec3_soa_lerp(vec3_soa* out, const vec3_soa* p, const vec3_soa* q, float t);
+SPXM_API void vec3_soa_norm(vec3_soa* out, const vec3_soa* p);
+SPXM_API void vec3_soa_cross(vec3_soa* out, const vec3_soa* p, const vec3_soa* q);
+SPXM_API void vec3_soa_dot(float* out, const vec3_soa* p, const vec3_soa* q);
+SPXM_API void vec3_soa_sqmag(float* out, const vec3_soa* p);
+SPXM_API void vec3_soa_dist(float* out, const vec3_soa* p, const vec3_soa* q);
+SPXM_API void vec3_soa_permute(vec3_soa* out, const vec3_soa* p, const unsigned int* indices);
+
+SPXM_API vec4_soa vec4_soa_create(size_t count);
+SPXM_API void vec4_soa_free(vec4_soa* soa);
+SPXM_API void vec4_soa_from_vec4(vec4_soa* soa, const vec4* in);
+SPXM_API void vec4_soa_to_vec4(const vec4_soa* soa, vec4* out);
+SPXM_API void vec4_soa_add(vec4_soa* out, const vec4_soa* p, const vec4_soa* q);
+SPXM_API void vec4_soa_sub(vec4_soa* out, const vec4_soa* p, const vec4_soa* q);
+SPXM_API void vec4_soa_mult(vec4_soa* out, const vec4_soa* p, float n);
+SPXM_API void vec4_soa_prod(vec4_soa* out, const vec4_soa* p, const vec4_soa* q);
+SPXM_API void vec4_soa_lerp(vec4_soa* out, const vec4_soa* p, const vec4_soa* q, float t);
+SPXM_API void vec4_soa_norm(vec4_soa* out, const vec4_soa* p);
+SPXM_API void vec4_soa_dot(float* out, const vec4_soa* p, const vec4_soa* q);
+SPXM_API void vec4_soa_sqmag(float* out, const vec4_soa* p);
+SPXM_API void vec4_soa_dist(float* out, const vec4_soa* p, const vec4_soa* q);
+SPXM_API void vec4_soa_permute(vec4_soa* out, const vec4_soa* p, const unsigned int* indices);
+
+SPXM_API plane plane_new(vec3 n, float d);
+SPXM_API plane plane_norm(plane p);
+SPXM_API float plane_dist(plane p, vec3 q);
+SPXM_API frustum frustum_from_mat4(mat4 m);
+SPXM_API int frustum_test_sphere(const frustum* f, sphere s);
+SPXM_API int frustum_test_aabb(const frustum* f, aabb box);
+SPXM_API void frustum_test_spheres(const frustum* f, const vec4_soa* spheres, unsigned int* mask, size_t begin, size_t end);
+SPXM_API void frustum_test_aabbs(const frustum* f, const vec3_soa* mins, const vec3_soa* maxs, unsigned int* mask, size_t begin, size_t end);
+
+SPXM_API transform_hierarchy transform_hierarchy_create(size_t count);
+SPXM_API void transform_hierarchy_free(transform_hierarchy* h);
+SPXM_API void transform_hierarchy_set(transform_hierarchy* h, size_t i, vec3 translation, quat rotation, vec3 scale);
+SPXM_API void transform_hierarchy_set_parent(transform_hierarchy* h, size_t i, int parent);
+SPXM_API void transform_hierarchy_update(transform_hierarchy* h);
+SPXM_API void transform_hierarchy_update_range(transform_hierarchy* h, size_t begin, size_t end);
+SPXM_API void transform_hierarchy_clean(transform_hierarchy* h);
+
+SPXM_API ray ray_new(vec3 origin, vec3 dir);
+SPXM_API vec3 ray_at(ray r, float t);
+SPXM_API int ray_aabb(ray r, aabb box, float tmax, float* t);
+SPXM_API int ray_sphere(ray r, sphere s, float tmax, float* t);
+SPXM_API int ray_triangle(ray r, triangle tri, float tmax, float* t, vec2* uv);
+SPXM_API ray4 ray4_from_rays(const ray* r);
+SPXM_API int ray4_aabb(const ray4* r, aabb box, const float* tmax, float* t);
+SPXM_API int ray4_sphere(const ray4* r, sphere s, const float* tmax, float* t);
+SPXM_API int ray4_triangle(const ray4* r, triangle tri, const float* tmax, float* t, float* u, float* v);
+SPXM_API ray8 ray8_from_rays(const ray* r);
+SPXM_API int ray8_aabb(const ray8* r, aabb box, const float* tmax, float* t);
+SPXM_API int ray8_sphere(const ray8* r, sphere s, const float* tmax, float* t);
+SPXM_API int ray8_triangle(const ray8* r, triangle tri, const float* tmax, float* t, float* u, float* v);
+
+SPXM_API aabb aabb_from_triangle(triangle tri);
+SPXM_API bvh bvh_create(size_t count);
+SPXM_API void bvh_free(bvh* b);
+SPXM_API void bvh_build(bvh* b, const aabb* boxes);
+SPXM_API size_t bvh_build_split(bvh* b, const aabb* boxes, size_t tasks);
+SPXM_API void bvh_build_task(bvh* b, const aabb* boxes, size_t task);
+SPXM_API void bvh_refit(bvh* b, const aabb* boxes);
+SPXM_API size_t bvh_query_aabb(const bvh* b, const aabb* boxes, aabb box, unsigned int* out, size_t max);
+SPXM_API size_t bvh_query_ray(const bvh* b, const aabb* boxes, ray r, float tmax, unsigned int* out, size_t max);
+SPXM_API int bvh_raycast_triangles(const bvh* b, const triangle* tris, ray r, float tmax, float* t, unsigned int* prim);
+
+SPXM_API spatial_hash spatial_hash_create(size_t capacity, size_t table_size, float cell_size);
+SPXM_API void spatial_hash_free(spatial_hash* h);
+SPXM_API ivec3 spatial_hash_cell(const spatial_hash* h, vec3 p);
+SPXM_API unsigned int spatial_hash_bucket(const spatial_hash* h, ivec3 cell);
+SPXM_API void spatial_hash_build(spatial_hash* h, const vec3_soa* points);
+SPXM_API void spatial_hash_keys_range(spatial_hash* h, const vec3_soa* points, size_t begin, size_t end);
+SPXM_API void spatial_hash_sort(spatial_hash* h, const vec3_soa* points);
+SPXM_API size_t spatial_hash_query_radius(const spatial_hash* h, vec3 p, float radius, unsigned int* out, size_t max);
+SPXM_API size_t spatial_hash_query_knn(const spatial_hash* h, vec3 p, size_t k, float radius, unsigned int* out, float* sqdist);
+
+SPXM_API unsigned int morton2_encode(ivec2 p);
+SPXM_API ivec2 morton2_decode(unsigned int code);
+SPXM_API unsigned int morton3_encode(ivec3 p);
+SPXM_API ivec3 morton3_decode(unsigned int code);
+SPXM_API unsigned int morton2_from_vec2(vec2 p, vec2 min, vec2 max);
+SPXM_API unsigned int morton3_from_vec3(vec3 p, vec3 min, vec3 max);
+SPXM_API void morton3_from_vec3_soa(const vec3_soa* points, vec3 min, vec3 max, unsigned int* keys, size_t begin, size_t end);
+SPXM_API void radix_sort(unsigned int* keys, unsigned int* values, unsigned int* tmp_keys, unsigned int* tmp_values, size_t count);
+SPXM_API void radix_sort_count(const unsigned int* keys, size_t begin, size_t end, int pass, size_t* counts);
+SPXM_API void radix_sort_offsets(size_t* counts, size_t parts);
+SPXM_API void radix_sort_scatter(const unsigned int* keys, const unsigned int* values, size_t begin, size_t end, int pass,
+    size_t* offsets, unsigned int* out_keys, unsigned int* out_values);
+
+SPXM_API unsigned short half_from_float(float n);
+SPXM_API float float_from_half(unsigned short n);
+SPXM_API void half_array_from_float(const float* in, unsigned short* out, size_t count);
+SPXM_API void float_array_from_half(const unsigned short* in, float* out, size_t count);
+SPXM_API unsigned char unorm8_from_float(float n);
+SPXM_API signed char snorm8_from_float(float n);
+SPXM_API unsigned short unorm16_from_float(float n);
+SPXM_API short snorm16_from_float(float n);
+SPXM_API float float_from_unorm8(unsigned char n);
+SPXM_API float float_from_snorm8(signed char n);
+SPXM_API float float_from_unorm16(unsigned short n);
+SPXM_API float float_from_snorm16(short n);
+SPXM_API void unorm8_array_from_float(const float* in, unsigned char* out, size_t count);
+SPXM_API void snorm8_array_from_float(const float* in, signed char* out, size_t count);
+SPXM_API void unorm16_array_from_float(const float* in, unsigned short* out, size_t count);
+SPXM_API void snorm16_array_from_float(const float* in, short* out, size_t count);
+SPXM_API void float_array_from_unorm8(const unsigned char* in, float* out, size_t count);
+SPXM_API void float_array_from_snorm8(const signed char* in, float* out, size_t count);
+SPXM_API void float_array_from_unorm16(const unsigned short* in, float* out, size_t count);
+SPXM_API void float_array_from_snorm16(const short* in, float* out, size_t count);
+SPXM_API vec2 oct_from_vec3(vec3 n);
+SPXM_API vec3 vec3_from_oct(vec2 p);
+SPXM_API unsigned int oct32_from_vec3(vec3 n);
+SPXM_API vec3 vec3_from_oct32(unsigned int n);
+SPXM_API void oct32_array_from_vec3(const vec3* in, unsigned int* out, size_t count);
+SPXM_API void vec3_array_from_oct32(const unsigned int* in, vec3* out, size_t count);
+SPXM_API unsigned int unorm1010102_from_vec4(vec4 p);
+SPXM_API vec4 vec4_from_unorm1010102(unsigned int n);
+SPXM_API unsigned int snorm1010102_from_vec4(vec4 p);
+SPXM_API vec4 vec4_from_snorm1010102(unsigned int n);
+SPXM_API void unorm1010102_array_from_vec4(const vec4* in, unsigned int* out, size_t count);
+SPXM_API void vec4_array_from_unorm1010102(const unsigned int* in, vec4* out, size_t count);
+SPXM_API void snorm1010102_array_from_vec4(const vec4* in, unsigned int* out, size_t count);
+SPXM_API void vec4_array_from_snorm1010102(const unsigned int* in, vec4* out, size_t count);
 
 #ifdef SPXM_APPLICATION
 
@@ -250,793 +991,7164 @@ ivec4 ivec4_from_vec4(vec4 p);
 
 #include <math.h>
 
-/* useful utilities and functions */
-
-float absf(float n)
+#ifndef SPXM_MALLOC
+#include <stdlib.h>
+#define SPXM_MALLOC(size) malloc(size)
+#define SPXM_FREE(ptr) free(ptr)
+#endif /* SPXM_MALLOC */
+
+#if defined(SPXM_SSE)
+#include <immintrin.h>
+#elif defined(SPXM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* internal 4-wide float vector abstraction used by the SIMD paths */
+
+#if defined(SPXM_SSE)
+
+typedef __m128 spxm_f4;
+
+#define SPXM_F4_LOADU(p) _mm_loadu_ps(p)
+#define SPXM_F4_STOREU(p, a) _mm_storeu_ps(p, a)
+#define SPXM_F4_SET1(n) _mm_set1_ps(n)
+#define SPXM_F4_ZERO() _mm_setzero_ps()
+#define SPXM_F4_ADD(a, b) _mm_add_ps(a, b)
+#define SPXM_F4_SUB(a, b) _mm_sub_ps(a, b)
+#define SPXM_F4_MUL(a, b) _mm_mul_ps(a, b)
+#define SPXM_F4_DIV(a, b) _mm_div_ps(a, b)
+#define SPXM_F4_SQRT(a) _mm_sqrt_ps(a)
+#define SPXM_F4_MIN(a, b) _mm_min_ps(a, b)
+#define SPXM_F4_MAX(a, b) _mm_max_ps(a, b)
+#define SPXM_F4_SPLAT(a, i) _mm_shuffle_ps(a, a, _MM_SHUFFLE(i, i, i, i))
+#define SPXM_F4_STORE3(p, a) do { _mm_storel_pi((__m64*)(void*)(p), a); \
+    _mm_store_ss((p) + 2, _mm_movehl_ps(a, a)); } while (0)
+#define SPXM_F4_TRANSPOSE(a, b, c, d) _MM_TRANSPOSE4_PS(a, b, c, d)
+
+typedef __m128 spxm_m4;
+
+#define SPXM_F4_CMPEQ(a, b) _mm_cmpeq_ps(a, b)
+#define SPXM_F4_CMPLT(a, b) _mm_cmplt_ps(a, b)
+#define SPXM_F4_CMPLE(a, b) _mm_cmple_ps(a, b)
+#define SPXM_F4_CMPGT(a, b) _mm_cmpgt_ps(a, b)
+#define SPXM_F4_CMPGE(a, b) _mm_cmpge_ps(a, b)
+#define SPXM_F4_SELECT(m, a, b) _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+#define SPXM_M4_AND(m, n) _mm_and_ps(m, n)
+#define SPXM_M4_OR(m, n) _mm_or_ps(m, n)
+#define SPXM_M4_MASK(m) _mm_movemask_ps(m)
+
+typedef __m128i spxm_i4;
+
+#define SPXM_I4_LOADU(p) _mm_loadu_si128((const __m128i*)(const void*)(p))
+#define SPXM_I4_STOREU(p, a) _mm_storeu_si128((__m128i*)(void*)(p), a)
+#define SPXM_I4_SET1(n) _mm_set1_epi32((int)(n))
+#define SPXM_I4_ADD(a, b) _mm_add_epi32(a, b)
+#define SPXM_I4_SUB(a, b) _mm_sub_epi32(a, b)
+#define SPXM_I4_AND(a, b) _mm_and_si128(a, b)
+#define SPXM_I4_OR(a, b) _mm_or_si128(a, b)
+#define SPXM_I4_XOR(a, b) _mm_xor_si128(a, b)
+#define SPXM_I4_SHL(a, n) _mm_slli_epi32(a, n)
+#define SPXM_I4_SHR(a, n) _mm_srli_epi32(a, n)
+#define SPXM_I4_TO_F4(a) _mm_cvtepi32_ps(a)
+#define SPXM_I4_CMPEQ(a, b) _mm_castsi128_ps(_mm_cmpeq_epi32(a, b))
+#define SPXM_F4_TO_I4(a) _mm_cvttps_epi32(a)
+#define SPXM_F4_ROUND_I4(a) _mm_cvtps_epi32(a)
+#define SPXM_F4_AS_I4(a) _mm_castps_si128(a)
+#define SPXM_I4_AS_F4(a) _mm_castsi128_ps(a)
+#define SPXM_M4_AS_I4(m) _mm_castps_si128(m)
+
+#ifdef __SSE4_1__
+#define SPXM_I4_MUL(a, b) _mm_mullo_epi32(a, b)
+#else
+
+/* SSE2 has no 32 bit low multiply, build it from two 32 x 32 -> 64 products */
+
+static __m128i spxm_sse_mullo(__m128i a, __m128i b)
 {
-	return n < 0.0F ? -n : n;
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+        _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
 }
 
-float signf(float n)
+#define SPXM_I4_MUL(a, b) spxm_sse_mullo(a, b)
+#endif /* __SSE4_1__ */
+
+#elif defined(SPXM_NEON)
+
+typedef float32x4_t spxm_f4;
+
+#define SPXM_F4_LOADU(p) vld1q_f32(p)
+#define SPXM_F4_STOREU(p, a) vst1q_f32(p, a)
+#define SPXM_F4_SET1(n) vdupq_n_f32(n)
+#define SPXM_F4_ZERO() vdupq_n_f32(0.0F)
+#define SPXM_F4_ADD(a, b) vaddq_f32(a, b)
+#define SPXM_F4_SUB(a, b) vsubq_f32(a, b)
+#define SPXM_F4_MUL(a, b) vmulq_f32(a, b)
+#define SPXM_F4_MIN(a, b) vminq_f32(a, b)
+#define SPXM_F4_MAX(a, b) vmaxq_f32(a, b)
+#define SPXM_F4_SPLAT(a, i) vdupq_n_f32(vgetq_lane_f32(a, i))
+#define SPXM_F4_STORE3(p, a) do { vst1_f32(p, vget_low_f32(a)); \
+    vst1q_lane_f32((p) + 2, a, 2); } while (0)
+#define SPXM_F4_TRANSPOSE(a, b, c, d) do { \
+    float32x4x2_t spxm_t0_ = vtrnq_f32(a, b), spxm_t1_ = vtrnq_f32(c, d); \
+    a = vcombine_f32(vget_low_f32(spxm_t0_.val[0]), vget_low_f32(spxm_t1_.val[0])); \
+    b = vcombine_f32(vget_low_f32(spxm_t0_.val[1]), vget_low_f32(spxm_t1_.val[1])); \
+    c = vcombine_f32(vget_high_f32(spxm_t0_.val[0]), vget_high_f32(spxm_t1_.val[0])); \
+    d = vcombine_f32(vget_high_f32(spxm_t0_.val[1]), vget_high_f32(spxm_t1_.val[1])); } while (0)
+
+typedef uint32x4_t spxm_m4;
+
+#define SPXM_F4_CMPEQ(a, b) vceqq_f32(a, b)
+#define SPXM_F4_CMPLT(a, b) vcltq_f32(a, b)
+#define SPXM_F4_CMPLE(a, b) vcleq_f32(a, b)
+#define SPXM_F4_CMPGT(a, b) vcgtq_f32(a, b)
+#define SPXM_F4_CMPGE(a, b) vcgeq_f32(a, b)
+#define SPXM_F4_SELECT(m, a, b) vbslq_f32(m, a, b)
+#define SPXM_M4_AND(m, n) vandq_u32(m, n)
+#define SPXM_M4_OR(m, n) vorrq_u32(m, n)
+#define SPXM_M4_MASK(m) ((int)((vgetq_lane_u32(m, 0) & 1) | (vgetq_lane_u32(m, 1) & 2) | \
+    (vgetq_lane_u32(m, 2) & 4) | (vgetq_lane_u32(m, 3) & 8)))
+
+typedef uint32x4_t spxm_i4;
+
+#define SPXM_I4_LOADU(p) vld1q_u32((const uint32_t*)(const void*)(p))
+#define SPXM_I4_STOREU(p, a) vst1q_u32((uint32_t*)(void*)(p), a)
+#define SPXM_I4_SET1(n) vdupq_n_u32((uint32_t)(n))
+#define SPXM_I4_ADD(a, b) vaddq_u32(a, b)
+#define SPXM_I4_SUB(a, b) vsubq_u32(a, b)
+#define SPXM_I4_MUL(a, b) vmulq_u32(a, b)
+#define SPXM_I4_AND(a, b) vandq_u32(a, b)
+#define SPXM_I4_OR(a, b) vorrq_u32(a, b)
+#define SPXM_I4_XOR(a, b) veorq_u32(a, b)
+#define SPXM_I4_SHL(a, n) vshlq_n_u32(a, n)
+#define SPXM_I4_SHR(a, n) vshrq_n_u32(a, n)
+#define SPXM_I4_TO_F4(a) vcvtq_f32_s32(vreinterpretq_s32_u32(a))
+#define SPXM_I4_CMPEQ(a, b) vceqq_u32(a, b)
+#define SPXM_F4_TO_I4(a) vreinterpretq_u32_s32(vcvtq_s32_f32(a))
+#define SPXM_F4_AS_I4(a) vreinterpretq_u32_f32(a)
+#define SPXM_I4_AS_F4(a) vreinterpretq_f32_u32(a)
+#define SPXM_M4_AS_I4(m) (m)
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#define SPXM_F4_DIV(a, b) vdivq_f32(a, b)
+#define SPXM_F4_SQRT(a) vsqrtq_f32(a)
+#define SPXM_F4_ROUND_I4(a) vreinterpretq_u32_s32(vcvtnq_s32_f32(a))
+
+#else
+
+/* ARMv7 NEON only converts with truncation, round to nearest even by adding
+and subtracting 2^23 to the magnitude, larger floats are already integers */
+
+static uint32x4_t spxm_neon_round(float32x4_t a)
 {
-	return n < 0.0F ? -1.0F : 1.0F;
+    float32x4_t big = vdupq_n_f32(8388608.0F), r = vabsq_f32(a);
+    r = vbslq_f32(vcltq_f32(r, big), vsubq_f32(vaddq_f32(r, big), big), r);
+    r = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(r),
+        vandq_u32(vreinterpretq_u32_f32(a), vdupq_n_u32(0x80000000U))));
+    return vreinterpretq_u32_s32(vcvtq_s32_f32(r));
 }
 
-float minf(float n, float m)
+#define SPXM_F4_ROUND_I4(a) spxm_neon_round(a)
+
+/* ARMv7 NEON has no vector divide or square root, use correctly rounded
+scalar operations lane by lane to keep results identical to the C code */
+
+static float32x4_t spxm_neon_div(float32x4_t a, float32x4_t b)
 {
-	return n < m ? n : m;
+    float p[4], q[4];
+    vst1q_f32(p, a);
+    vst1q_f32(q, b);
+    p[0] /= q[0];
+    p[1] /= q[1];
+    p[2] /= q[2];
+    p[3] /= q[3];
+    return vld1q_f32(p);
 }
 
-float maxf(float n, float m)
+static float32x4_t spxm_neon_sqrt(float32x4_t a)
 {
-	return n > m ? n : m;
+    float p[4];
+    vst1q_f32(p, a);
+    p[0] = sqrtf(p[0]);
+    p[1] = sqrtf(p[1]);
+    p[2] = sqrtf(p[2]);
+    p[3] = sqrtf(p[3]);
+    return vld1q_f32(p);
 }
 
-float clampf(float n, float min, float max)
+#define SPXM_F4_DIV(a, b) spxm_neon_div(a, b)
+#define SPXM_F4_SQRT(a) spxm_neon_sqrt(a)
+
+#endif /* __aarch64__ */
+
+#endif /* SPXM_SSE */
+
+#ifdef SPXM_SIMD
+
+#define SPXM_F4_AND(a, b) SPXM_I4_AS_F4(SPXM_I4_AND(SPXM_F4_AS_I4(a), SPXM_F4_AS_I4(b)))
+#define SPXM_F4_XOR(a, b) SPXM_I4_AS_F4(SPXM_I4_XOR(SPXM_F4_AS_I4(a), SPXM_F4_AS_I4(b)))
+#define SPXM_F4_SIGNMASK() SPXM_I4_AS_F4(SPXM_I4_SET1(0x80000000))
+#define SPXM_F4_ABS(a) SPXM_I4_AS_F4(SPXM_I4_AND(SPXM_F4_AS_I4(a), SPXM_I4_SET1(0x7fffffff)))
+
+/* reciprocal square root estimate with Newton steps, 12 bits of precision
+from SSE need one step and 8 bits from NEON need two, the same steps and
+results as rsqrtf_fast */
+
+static spxm_f4 spxm_f4_rsqrt_step(spxm_f4 half, spxm_f4 y)
 {
-	return n > max ? max : n < min ? min : n;
+    spxm_f4 t = SPXM_F4_MUL(SPXM_F4_MUL(half, y), y);
+    return SPXM_F4_MUL(y, SPXM_F4_SUB(SPXM_F4_SET1(1.5F), t));
 }
 
-float lerpf(float a, float b, float t)
+static spxm_f4 spxm_f4_rsqrt(spxm_f4 a)
 {
-	return a + t * (b - a);
+    spxm_f4 half = SPXM_F4_MUL(a, SPXM_F4_SET1(0.5F));
+#if defined(SPXM_SSE)
+    spxm_f4 y = _mm_rsqrt_ps(a);
+#else
+    spxm_f4 y = spxm_f4_rsqrt_step(half, vrsqrteq_f32(a));
+#endif /* SPXM_SSE */
+    return spxm_f4_rsqrt_step(half, y);
 }
 
-float smoothlerpf(float a, float b, float t)
+#ifdef SPXM_FAST_MATH
+#define SPXM_F4_RSQRT(a) spxm_f4_rsqrt(a)
+#else
+#define SPXM_F4_RSQRT(a) SPXM_F4_DIV(SPXM_F4_SET1(1.0F), SPXM_F4_SQRT(a))
+#endif /* SPXM_FAST_MATH */
+
+/* interleaved loads and stores of 4 vectors held as one register per component */
+
+static void spxm_f4_load_vec2(const float* p, spxm_f4* x, spxm_f4* y)
 {
-	return a + (t * t * (3.0 - 2.0 * t)) * (b - a);
+#if defined(SPXM_SSE)
+    __m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4);
+    *x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    *y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+#else
+    float32x4x2_t v = vld2q_f32(p);
+    *x = v.val[0];
+    *y = v.val[1];
+#endif /* SPXM_SSE */
 }
 
-float ilerpf(float min, float max, float n)
+static void spxm_f4_load_vec3(const float* p, spxm_f4* x, spxm_f4* y, spxm_f4* z)
 {
-	return (max - min) != 0.0F ? (n - min) / (max - min) : 0.0F;
+#if defined(SPXM_SSE)
+    __m128 a, b, c, t0, t1;
+    a = _mm_loadu_ps(p);
+    b = _mm_loadu_ps(p + 4);
+    c = _mm_loadu_ps(p + 8);
+    t0 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0));
+    t1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+    *x = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+    t0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+    t1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+    *y = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+    t0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+    t1 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+    *z = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+#else
+    float32x4x3_t v = vld3q_f32(p);
+    *x = v.val[0];
+    *y = v.val[1];
+    *z = v.val[2];
+#endif /* SPXM_SSE */
 }
 
-float remapf(float min, float max, float a, float b, float n)
+static void spxm_f4_load_vec4(const float* p, spxm_f4* x, spxm_f4* y, spxm_f4* z, spxm_f4* w)
 {
-	return lerpf(a, b, ilerpf(min, max, n));
+#if defined(SPXM_SSE)
+    __m128 a, b, c, d;
+    a = _mm_loadu_ps(p);
+    b = _mm_loadu_ps(p + 4);
+    c = _mm_loadu_ps(p + 8);
+    d = _mm_loadu_ps(p + 12);
+    SPXM_F4_TRANSPOSE(a, b, c, d);
+    *x = a;
+    *y = b;
+    *z = c;
+    *w = d;
+#else
+    float32x4x4_t v = vld4q_f32(p);
+    *x = v.val[0];
+    *y = v.val[1];
+    *z = v.val[2];
+    *w = v.val[3];
+#endif /* SPXM_SSE */
 }
 
-float rad2deg(float rad)
+static void spxm_f4_store_vec2(float* p, spxm_f4 x, spxm_f4 y)
 {
-	return rad * (180.0F / M_PI);
+#if defined(SPXM_SSE)
+    _mm_storeu_ps(p, _mm_unpacklo_ps(x, y));
+    _mm_storeu_ps(p + 4, _mm_unpackhi_ps(x, y));
+#else
+    float32x4x2_t v;
+    v.val[0] = x;
+    v.val[1] = y;
+    vst2q_f32(p, v);
+#endif /* SPXM_SSE */
 }
 
-float deg2rad(float deg)
+static void spxm_f4_store_vec3(float* p, spxm_f4 x, spxm_f4 y, spxm_f4 z)
 {
-	return deg / (180.0F / M_PI);
+#if defined(SPXM_SSE)
+    __m128 t0, t1;
+    t0 = _mm_unpacklo_ps(x, y);
+    t1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+    _mm_storeu_ps(p, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 1, 0)));
+    t0 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+    t1 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+    t0 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+    t1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+    _mm_storeu_ps(p + 8, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+#else
+    float32x4x3_t v;
+    v.val[0] = x;
+    v.val[1] = y;
+    v.val[2] = z;
+    vst3q_f32(p, v);
+#endif /* SPXM_SSE */
 }
 
-/* platform independent pseudo random number generator functions */
+static void spxm_f4_store_vec4(float* p, spxm_f4 x, spxm_f4 y, spxm_f4 z, spxm_f4 w)
+{
+#if defined(SPXM_SSE)
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(p, x);
+    _mm_storeu_ps(p + 4, y);
+    _mm_storeu_ps(p + 8, z);
+    _mm_storeu_ps(p + 12, w);
+#else
+    float32x4x4_t v;
+    v.val[0] = x;
+    v.val[1] = y;
+    v.val[2] = z;
+    v.val[3] = w;
+    vst4q_f32(p, v);
+#endif /* SPXM_SSE */
+}
 
-static unsigned int spxseed = 0;
+/* vectorized sine and cosine with the Cephes sinf/cosf range reduction and
+polynomials, max error about 2 ulp for |x| < 8192 */
 
-void spxrand_seed_set(unsigned int n) 
+static void spxm_f4_sincos(spxm_f4 x, spxm_f4* s, spxm_f4* c)
 {
-    spxseed = n;
+    spxm_f4 y, z, ps, pc, sign_sin, sign_cos;
+    spxm_m4 poly;
+    spxm_i4 j;
+
+    sign_sin = SPXM_F4_AND(x, SPXM_F4_SIGNMASK());
+    x = SPXM_F4_ABS(x);
+
+    j = SPXM_F4_TO_I4(SPXM_F4_MUL(x, SPXM_F4_SET1(1.27323954473516F)));
+    j = SPXM_I4_AND(SPXM_I4_ADD(j, SPXM_I4_SET1(1)), SPXM_I4_SET1(~1));
+    y = SPXM_I4_TO_F4(j);
+
+    sign_sin = SPXM_F4_XOR(sign_sin, SPXM_I4_AS_F4(SPXM_I4_SHL(SPXM_I4_AND(j, SPXM_I4_SET1(4)), 29)));
+    sign_cos = SPXM_I4_AS_F4(SPXM_I4_SHL(SPXM_I4_AND(SPXM_I4_XOR(SPXM_I4_SUB(j, SPXM_I4_SET1(2)),
+        SPXM_I4_SET1(~0)), SPXM_I4_SET1(4)), 29));
+    poly = SPXM_I4_CMPEQ(SPXM_I4_AND(j, SPXM_I4_SET1(2)), SPXM_I4_SET1(0));
+
+    x = SPXM_F4_SUB(x, SPXM_F4_MUL(y, SPXM_F4_SET1(0.78515625F)));
+    x = SPXM_F4_SUB(x, SPXM_F4_MUL(y, SPXM_F4_SET1(2.4187564849853515625e-4F)));
+    x = SPXM_F4_SUB(x, SPXM_F4_MUL(y, SPXM_F4_SET1(3.77489497744594108e-8F)));
+    z = SPXM_F4_MUL(x, x);
+
+    pc = SPXM_F4_ADD(SPXM_F4_MUL(SPXM_F4_SET1(2.443315711809948e-5F), z), SPXM_F4_SET1(-1.388731625493765e-3F));
+    pc = SPXM_F4_ADD(SPXM_F4_MUL(pc, z), SPXM_F4_SET1(4.166664568298827e-2F));
+    pc = SPXM_F4_MUL(SPXM_F4_MUL(pc, z), z);
+    pc = SPXM_F4_ADD(SPXM_F4_SUB(pc, SPXM_F4_MUL(z, SPXM_F4_SET1(0.5F))), SPXM_F4_SET1(1.0F));
+
+    ps = SPXM_F4_ADD(SPXM_F4_MUL(SPXM_F4_SET1(-1.9515295891e-4F), z), SPXM_F4_SET1(8.3321608736e-3F));
+    ps = SPXM_F4_ADD(SPXM_F4_MUL(ps, z), SPXM_F4_SET1(-1.6666654611e-1F));
+    ps = SPXM_F4_ADD(SPXM_F4_MUL(SPXM_F4_MUL(ps, z), x), x);
+
+    *s = SPXM_F4_XOR(SPXM_F4_SELECT(poly, ps, pc), sign_sin);
+    *c = SPXM_F4_XOR(SPXM_F4_SELECT(poly, pc, ps), sign_cos);
 }
 
-unsigned int spxrand_seed_get(void)
+/* four lanes of vec2_from_rad_fast, same operations in the same order so
+the results are bit exact with it */
+
+static void spxm_f4_sincos_pi(spxm_f4 x, spxm_f4* s, spxm_f4* c)
 {
-    return spxseed;
+    spxm_f4 q, y, z, p, sign;
+
+    q = SPXM_F4_ADD(SPXM_F4_MUL(x, SPXM_F4_SET1(0.318309886F)), SPXM_F4_SET1(12582912.0F));
+    y = SPXM_F4_SUB(q, SPXM_F4_SET1(12582912.0F));
+    x = SPXM_F4_SUB(x, SPXM_F4_MUL(y, SPXM_F4_SET1(3.140625F)));
+    x = SPXM_F4_SUB(x, SPXM_F4_MUL(y, SPXM_F4_SET1(9.67502593994140625e-4F)));
+    x = SPXM_F4_SUB(x, SPXM_F4_MUL(y, SPXM_F4_SET1(1.509957990978376432e-7F)));
+    sign = SPXM_I4_AS_F4(SPXM_I4_SHL(SPXM_F4_AS_I4(q), 31));
+    z = SPXM_F4_MUL(x, x);
+
+    p = SPXM_F4_SUB(SPXM_F4_MUL(SPXM_F4_SET1(2.60190313e-6F), z), SPXM_F4_SET1(1.98074194e-4F));
+    p = SPXM_F4_ADD(SPXM_F4_MUL(p, z), SPXM_F4_SET1(8.3330255e-3F));
+    p = SPXM_F4_SUB(SPXM_F4_MUL(p, z), SPXM_F4_SET1(1.66666567e-1F));
+    *s = SPXM_F4_XOR(SPXM_F4_ADD(SPXM_F4_MUL(SPXM_F4_MUL(p, z), x), x), sign);
+
+    p = SPXM_F4_ADD(SPXM_F4_MUL(SPXM_F4_SET1(-2.60514952e-7F), z), SPXM_F4_SET1(2.4760162e-5F));
+    p = SPXM_F4_SUB(SPXM_F4_MUL(p, z), SPXM_F4_SET1(1.38883619e-3F));
+    p = SPXM_F4_ADD(SPXM_F4_MUL(p, z), SPXM_F4_SET1(4.16666381e-2F));
+    p = SPXM_F4_SUB(SPXM_F4_MUL(p, z), SPXM_F4_SET1(0.5F));
+    *c = SPXM_F4_XOR(SPXM_F4_ADD(SPXM_F4_MUL(p, z), SPXM_F4_SET1(1.0F)), sign);
 }
 
-unsigned int spxrand(void)
+/* four lanes of atan2f_fast, the octant masks become selects and the
+results are bit exact with it */
+
+static spxm_f4 spxm_f4_atan2(spxm_f4 y, spxm_f4 x)
 {
-    return spxrand_hash(spxseed++);
+    spxm_f4 ax, ay, mn, mx, r, s, t, zero = SPXM_F4_ZERO();
+    spxm_i4 sign_x, sign_y;
+    spxm_m4 swap;
+
+    sign_x = SPXM_I4_AND(SPXM_F4_AS_I4(x), SPXM_I4_SET1(0x80000000));
+    sign_y = SPXM_I4_AND(SPXM_F4_AS_I4(y), SPXM_I4_SET1(0x80000000));
+    ax = SPXM_F4_ABS(x);
+    ay = SPXM_F4_ABS(y);
+
+    swap = SPXM_F4_CMPGT(ay, ax);
+    mn = SPXM_F4_SELECT(swap, ax, ay);
+    mx = SPXM_F4_SELECT(swap, ay, ax);
+    mx = SPXM_F4_SELECT(SPXM_I4_CMPEQ(SPXM_F4_AS_I4(mx), SPXM_I4_SET1(0)), SPXM_I4_AS_F4(SPXM_I4_SET1(1)), mx);
+    r = SPXM_F4_DIV(mn, mx);
+
+    s = SPXM_F4_MUL(r, r);
+    t = SPXM_F4_ADD(SPXM_F4_MUL(SPXM_F4_SET1(-0.01172120F), s), SPXM_F4_SET1(0.05265332F));
+    t = SPXM_F4_SUB(SPXM_F4_MUL(t, s), SPXM_F4_SET1(0.11643287F));
+    t = SPXM_F4_ADD(SPXM_F4_MUL(t, s), SPXM_F4_SET1(0.19354346F));
+    t = SPXM_F4_SUB(SPXM_F4_MUL(t, s), SPXM_F4_SET1(0.33262347F));
+    r = SPXM_F4_MUL(SPXM_F4_ADD(SPXM_F4_MUL(t, s), SPXM_F4_SET1(0.99997726F)), r);
+
+    r = SPXM_F4_XOR(r, SPXM_F4_SELECT(swap, SPXM_F4_SIGNMASK(), zero));
+    r = SPXM_F4_ADD(r, SPXM_F4_SELECT(swap, SPXM_I4_AS_F4(SPXM_I4_SET1(0x3fc90fdb)), zero));
+    r = SPXM_F4_XOR(r, SPXM_I4_AS_F4(sign_x));
+    r = SPXM_F4_ADD(r, SPXM_F4_SELECT(SPXM_I4_CMPEQ(sign_x, SPXM_I4_SET1(0)), zero,
+        SPXM_I4_AS_F4(SPXM_I4_SET1(0x40490fdb))));
+    return SPXM_F4_XOR(r, SPXM_I4_AS_F4(sign_y));
 }
 
-unsigned int spxrand_hash(unsigned int n)
+/* vectorized natural logarithm with the Cephes logf polynomial, valid for
+positive normal inputs with a max error about 1 ulp */
+
+static spxm_f4 spxm_f4_log(spxm_f4 x)
 {
-    n = (n << 13) ^ n;
-    return ((n * (n * n * 15731 + 789221) + 1376312589) & SPXM_RANDMAX);
+    spxm_f4 e, y, z, tmp, one = SPXM_F4_SET1(1.0F);
+    spxm_m4 mask;
+    spxm_i4 i = SPXM_F4_AS_I4(x);
+
+    e = SPXM_I4_TO_F4(SPXM_I4_SUB(SPXM_I4_SHR(i, 23), SPXM_I4_SET1(0x7e)));
+    x = SPXM_I4_AS_F4(SPXM_I4_OR(SPXM_I4_AND(i, SPXM_I4_SET1(0x007fffff)), SPXM_I4_SET1(0x3f000000)));
+
+    mask = SPXM_F4_CMPLT(x, SPXM_F4_SET1(0.707106781186547524F));
+    tmp = SPXM_F4_SELECT(mask, x, SPXM_F4_ZERO());
+    x = SPXM_F4_ADD(SPXM_F4_SUB(x, one), tmp);
+    e = SPXM_F4_SUB(e, SPXM_F4_SELECT(mask, one, SPXM_F4_ZERO()));
+    z = SPXM_F4_MUL(x, x);
+
+    y = SPXM_F4_SET1(7.0376836292e-2F);
+    y = SPXM_F4_ADD(SPXM_F4_MUL(y, x), SPXM_F4_SET1(-1.1514610310e-1F));
+    y = SPXM_F4_ADD(SPXM_F4_MUL(y, x), SPXM_F4_SET1(1.1676998740e-1F));
+    y = SPXM_F4_ADD(SPXM_F4_MUL(y, x), SPXM_F4_SET1(-1.2420140846e-1F));
+    y = SPXM_F4_ADD(SPXM_F4_MUL(y, x), SPXM_F4_SET1(1.4249322787e-1F));
+    y = SPXM_F4_ADD(SPXM_F4_MUL(y, x), SPXM_F4_SET1(-1.6668057665e-1F));
+    y = SPXM_F4_ADD(SPXM_F4_MUL(y, x), SPXM_F4_SET1(2.0000714765e-1F));
+    y = SPXM_F4_ADD(SPXM_F4_MUL(y, x), SPXM_F4_SET1(-2.4999993993e-1F));
+    y = SPXM_F4_ADD(SPXM_F4_MUL(y, x), SPXM_F4_SET1(3.3333331174e-1F));
+    y = SPXM_F4_MUL(SPXM_F4_MUL(y, x), z);
+
+    y = SPXM_F4_ADD(y, SPXM_F4_MUL(e, SPXM_F4_SET1(-2.12194440e-4F)));
+    y = SPXM_F4_SUB(y, SPXM_F4_MUL(z, SPXM_F4_SET1(0.5F)));
+    x = SPXM_F4_ADD(x, y);
+    return SPXM_F4_ADD(x, SPXM_F4_MUL(e, SPXM_F4_SET1(0.693359375F)));
 }
 
-unsigned int spxrand_between(unsigned int min, unsigned int max)
+#endif /* SPXM_SIMD */
+
+/* arrays of vectors are treated as flat arrays of floats by batch functions */
+
+typedef char spxm_vec2_packed[sizeof(vec2) == 2 * sizeof(float) ? 1 : -1];
+typedef char spxm_vec3_packed[sizeof(vec3) == 3 * sizeof(float) ? 1 : -1];
+typedef char spxm_vec4_packed[sizeof(vec4) == 4 * sizeof(float) ? 1 : -1];
+typedef char spxm_quat_packed[sizeof(quat) == 4 * sizeof(float) ? 1 : -1];
+typedef char spxm_vec3a_packed[sizeof(vec3a) == 4 * sizeof(float) ? 1 : -1];
+typedef char spxm_ivec2_packed[sizeof(ivec2) == 2 * sizeof(int) ? 1 : -1];
+typedef char spxm_ivec3_packed[sizeof(ivec3) == 3 * sizeof(int) ? 1 : -1];
+typedef char spxm_ivec4_packed[sizeof(ivec4) == 4 * sizeof(int) ? 1 : -1];
+typedef char spxm_int_float[sizeof(int) == sizeof(float) ? 1 : -1];
+
+/* useful utilities and functions */
+
+SPXM_API float absf(float n)
 {
-    return min + (spxrand() % (max - min));
+	return n < 0.0F ? -n : n;
 }
 
-float spxrandf(void)
+SPXM_API float signf(float n)
 {
-    return (float)spxrand_hash(spxseed++) / (float)SPXM_RANDMAX;
+	return n < 0.0F ? -1.0F : 1.0F;
 }
 
-float spxrandf_hash(unsigned int hash)
+SPXM_API float minf(float n, float m)
 {
-    return (float)spxrand_hash(hash) / (float)SPXM_RANDMAX;
+	return n < m ? n : m;
 }
 
-float spxrandf_between(float min, float max)
+SPXM_API float maxf(float n, float m)
 {
-    return min + spxrandf() * (max - min);
+	return n > m ? n : m;
 }
 
-/* vec2 implementation */
+SPXM_API float clampf(float n, float min, float max)
+{
+	return n > max ? max : n < min ? min : n;
+}
 
-vec2 vec2_uni(float n)
+SPXM_API float lerpf(float a, float b, float t)
 {
-    vec2 p;
-    p.x = n;
-    p.y = n;
-    return p;
+	return a + t * (b - a);
 }
 
-vec2 vec2_new(float x, float y)
-{ 
-    vec2 p;
-    p.x = x;
-    p.y = y; 
-    return p;
+SPXM_API float smoothlerpf(float a, float b, float t)
+{
+	return a + (t * t * (3.0 - 2.0 * t)) * (b - a);
 }
 
-vec2 vec2_rand(void)
+SPXM_API float ilerpf(float min, float max, float n)
 {
-    vec2 p;
-    p.x = spxrandf();
-    p.y = spxrandf();
-    return p;
+	return (max - min) != 0.0F ? (n - min) / (max - min) : 0.0F;
 }
 
-vec2 vec2_add(vec2 p, vec2 q)
+SPXM_API float remapf(float min, float max, float a, float b, float n)
 {
-    p.x += q.x;
-    p.y += q.y;
-    return p;
+	return lerpf(a, b, ilerpf(min, max, n));
 }
 
-vec2 vec2_sub(vec2 p, vec2 q)
+SPXM_API float rad2deg(float rad)
 {
-	p.x -= q.x;
-    p.y -= q.y;
-    return p;
+	return rad * (180.0F / M_PI);
 }
 
-vec2 vec2_mult(vec2 p, float n)
+SPXM_API float deg2rad(float deg)
 {
-    p.x *= n;
-    p.y *= n;
-    return p;
+	return deg / (180.0F / M_PI);
 }
 
-vec2 vec2_div(vec2 p, float n)
+/* approximate math, error bounds are measured against the C math library
+and checked by make check */
+
+/* hardware reciprocal square root estimate refined with Newton steps, one
+for the 12 bit SSE estimate, two for the 8 bit NEON estimate and three for
+the integer estimate in portable C, max relative error 3e-7 */
+
+SPXM_API float rsqrtf_fast(float n)
 {
-	n = n == 0.0F ? 0.0F : 1.0F / n; 
-    p.x *= n;
-    p.y *= n;
-    return p;
+    float y;
+#if defined(SPXM_SSE)
+    y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(n)));
+#elif defined(SPXM_NEON)
+    y = vget_lane_f32(vrsqrte_f32(vdup_n_f32(n)), 0);
+    y = y * (1.5F - 0.5F * n * y * y);
+#else
+    union { float f; unsigned int i; } u;
+    u.f = n;
+    u.i = 0x5f375a86 - (u.i >> 1);
+    y = u.f;
+    y = y * (1.5F - 0.5F * n * y * y);
+    y = y * (1.5F - 0.5F * n * y * y);
+#endif /* SPXM_SSE */
+    return y * (1.5F - 0.5F * n * y * y);
 }
 
-vec2 vec2_norm(vec2 p)
+/* minimax polynomials for sine and cosine on [-pi/2, pi/2], the sine with
+relative error 5e-9 and the cosine with absolute error 2e-10 before rounding */
+
+static float spxm_sinf_poly(float x)
 {
-    float n = sqrtf(p.x * p.x + p.y * p.y);
-    n = n == 0.0F ? 0.0F : 1.0F / n;
-    p.x *= n;
-    p.y *= n;
-    return p;
+    float z = x * x;
+    float p = 2.60190313e-6F * z - 1.98074194e-4F;
+    p = p * z + 8.3330255e-3F;
+    p = p * z - 1.66666567e-1F;
+    return p * z * x + x;
 }
 
-vec2 vec2_cross(vec2 p, vec2 q)
+static float spxm_cosf_poly(float x)
 {
-	float y = p.x - q.x;
-    p.x = -(p.y - q.y),
-    p.y = y;
-    return p;
+    float z = x * x;
+    float p = -2.60514952e-7F * z + 2.4760162e-5F;
+    p = p * z - 1.38883619e-3F;
+    p = p * z + 4.16666381e-2F;
+    p = p * z - 0.5F;
+    return p * z + 1.0F;
 }
 
-vec2 vec2_prod(vec2 p, vec2 q)
+/* Cody-Waite reduction to [-pi/2, pi/2] by multiples of pi, rounded with
+the 1.5 * 2^23 trick instead of conversions, and the sign of odd multiples
+flipped with a mask instead of a branch that random angles mispredict.
+Max absolute error 1.25e-7 for |x| < 8192, meaningless for |x| > 2^22. */
+
+#define SPXM_PI_REDUCE(x, y) ((((x) - (y) * 3.140625F) - (y) * 9.67502593994140625e-4F) \
+    - (y) * 1.509957990978376432e-7F)
+
+SPXM_API float sinf_fast(float rad)
 {
-    p.x *= q.x;
-    p.y *= q.y;
-    return p;
+    union { float f; unsigned int i; } q, r;
+    float y;
+    q.f = rad * 0.318309886F + 12582912.0F;
+    y = q.f - 12582912.0F;
+    r.f = spxm_sinf_poly(SPXM_PI_REDUCE(rad, y));
+    r.i ^= q.i << 31;
+    return r.f;
 }
 
-vec2 vec2_lerp(vec2 p, vec2 q, float t)
+/* cos(x) = -sin(x - (k + 1/2) pi) for even k */
+
+SPXM_API float cosf_fast(float rad)
 {
-    p.x += t * (q.x - p.x);
-    p.y += t * (q.y - p.y);
-    return p;
+    union { float f; unsigned int i; } q, r;
+    float y;
+    q.f = (rad * 0.318309886F - 0.5F) + 12582912.0F;
+    y = (q.f - 12582912.0F) + 0.5F;
+    r.f = spxm_sinf_poly(SPXM_PI_REDUCE(rad, y));
+    r.i ^= ~q.i << 31;
+    return r.f;
 }
 
-vec2 vec2_from_rad(float rad)
+/* one division and an odd minimax polynomial for atan on [0, 1], max
+absolute error 2e-6 radians. The octant is resolved on the bits with masks,
+branches on it mispredict for random directions. */
+
+SPXM_API float atan2f_fast(float y, float x)
 {
-	vec2 p;
-    p.x = cosf(rad);
-    p.y = sinf(rad);
-    return p;
+    union { float f; unsigned int i; } u, v, mn, mx, c;
+    unsigned int sign_x, sign_y, swap;
+    float r, s, t;
+
+    u.f = x;
+    v.f = y;
+    sign_x = u.i & 0x80000000U;
+    sign_y = v.i & 0x80000000U;
+    u.i ^= sign_x;
+    v.i ^= sign_y;
+
+    /* non negative floats compare like their bits */
+    swap = 0U - (unsigned int)(v.i > u.i);
+    mn.i = v.i ^ ((u.i ^ v.i) & swap);
+    mx.i = u.i ^ ((u.i ^ v.i) & swap);
+    mx.i |= (unsigned int)(mx.i == 0);
+    r = mn.f / mx.f;
+
+    s = r * r;
+    t = -0.01172120F * s + 0.05265332F;
+    t = t * s - 0.11643287F;
+    t = t * s + 0.19354346F;
+    t = t * s - 0.33262347F;
+    u.f = (t * s + 0.99997726F) * r;
+
+    /* pi / 2 - r above the diagonal, pi - r for negative x */
+    u.i ^= swap & 0x80000000U;
+    c.i = 0x3fc90fdbU & swap;
+    u.f += c.f;
+    u.i ^= sign_x;
+    c.i = 0x40490fdbU & (0U - (sign_x >> 31));
+    u.f += c.f;
+    u.i ^= sign_y;
+    return u.f;
 }
 
-float vec2_sqmag(vec2 p)
+/* sine and cosine with one shared range reduction, within 1.5e-7 absolute
+for |rad| <= pi and 1.8e-7 up to 8192, the C math library above, where the
+reduction loses bits. The error is absolute, near the zeros of sine and
+cosine it is far more ulp than sinf and cosf. */
+
+SPXM_API void spxm_sincosf(float rad, float* s, float* c)
 {
-	return p.x * p.x + p.y * p.y;
+    if (absf(rad) > 8192.0F) {
+        *s = sinf(rad);
+        *c = cosf(rad);
+    } else {
+        vec2 p = vec2_from_rad_fast(rad);
+        *s = p.y;
+        *c = p.x;
+    }
 }
 
-float vec2_mag(vec2 p)
+/* spxm_sincosf over a whole array, s or c may point to rad */
+
+SPXM_API void spxm_sincosf_array(const float* rad, float* s, float* c, size_t count)
 {
-	return sqrtf(p.x * p.x + p.y * p.y);
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x = SPXM_F4_LOADU(rad + i), vs, vc;
+        if (SPXM_M4_MASK(SPXM_F4_CMPGT(SPXM_F4_ABS(x), SPXM_F4_SET1(8192.0F)))) {
+            size_t j;
+            for (j = i; j < i + 4; ++j) {
+                spxm_sincosf(rad[j], s + j, c + j);
+            }
+            continue;
+        }
+        spxm_f4_sincos_pi(x, &vs, &vc);
+        SPXM_F4_STOREU(s + i, vs);
+        SPXM_F4_STOREU(c + i, vc);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        spxm_sincosf(rad[i], s + i, c + i);
+    }
 }
 
-float vec2_sqdist(vec2 p, vec2 q)
+/* sine and cosine tables for angles quantized to size steps per turn, the
+cosine is read a quarter turn ahead in the same table */
+
+SPXM_API sincos_lut sincos_lut_create(unsigned int size)
 {
-    p.x -= q.x;
-    p.y -= q.y;
-	return p.x * p.x + p.y * p.y;
+    sincos_lut lut;
+    unsigned int i, n = 4, quarter;
+
+    while (n < size && n < 0x40000000U) {
+        n <<= 1;
+    }
+
+    quarter = n / 4;
+    lut.sin = (float*)SPXM_MALLOC((n + quarter) * sizeof(float));
+    if (!lut.sin) {
+        lut.size = lut.mask = 0;
+        lut.steps_per_rad = 0.0F;
+        return lut;
+    }
+
+    lut.size = n;
+    lut.mask = n - 1;
+    lut.steps_per_rad = (float)((double)n / (2.0 * M_PI));
+
+    /* one quadrant from the C math library, the rest by symmetry so the
+    axis aligned steps are exactly 0 and 1 */
+    for (i = 0; i <= quarter; ++i) {
+        lut.sin[i] = (float)sin(2.0 * M_PI * (double)i / (double)n);
+    }
+    lut.sin[quarter] = 1.0F;
+    for (i = 1; i < quarter; ++i) {
+        lut.sin[quarter * 2 - i] = lut.sin[i];
+    }
+    lut.sin[quarter * 2] = 0.0F;
+    for (i = 1; i <= quarter * 2; ++i) {
+        lut.sin[quarter * 2 + i] = 0.0F - lut.sin[i];
+    }
+    for (i = 1; i < quarter; ++i) {
+        lut.sin[n + i] = lut.sin[i];
+    }
+    return lut;
 }
 
-float vec2_dist(vec2 p, vec2 q)
+SPXM_API void sincos_lut_free(sincos_lut* lut)
 {
-    p.x -= q.x;
-    p.y -= q.y;
-	return sqrtf(p.x * p.x + p.y * p.y);
+    if (lut->sin) {
+        SPXM_FREE(lut->sin);
+    }
+    lut->sin = NULL;
+    lut->size = lut->mask = 0;
+    lut->steps_per_rad = 0.0F;
 }
 
-float vec2_dot(vec2 p, vec2 q)
+/* cosine and sine of step * 2 pi / size, like vec2_from_rad */
+
+SPXM_API vec2 sincos_lut_step(const sincos_lut* lut, unsigned int step)
 {
-	return p.x * q.x + p.y * q.y;
+    vec2 p;
+    step &= lut->mask;
+    p.x = lut->sin[step + lut->size / 4];
+    p.y = lut->sin[step];
+    return p;
 }
 
-float vec2_rads(vec2 p)
+/* rad rounded to the nearest step, |rad * size / 2 pi| must fit a long */
+
+SPXM_API vec2 sincos_lut_rad(const sincos_lut* lut, float rad)
 {
-	return atan2f(p.y, p.x);
+    float x = rad * lut->steps_per_rad;
+    long k = (long)(x < 0.0F ? x - 0.5F : x + 0.5F);
+    return sincos_lut_step(lut, (unsigned int)k);
 }
 
-/* vec3 implementation */
+/* SPXM_FAST_MATH routes the normalizations and rotations of the library
+through the approximations above */
+
+#ifdef SPXM_FAST_MATH
+#define SPXM_RSQRTF(n) rsqrtf_fast(n)
+#define SPXM_SINCOSF(a, s, c) spxm_sincosf(a, s, c)
+#define SPXM_ATAN2F(y, x) atan2f_fast(y, x)
+#else
+#define SPXM_RSQRTF(n) (1.0F / sqrtf(n))
+#define SPXM_SINCOSF(a, s, c) do { *(s) = sinf(a); *(c) = cosf(a); } while (0)
+#define SPXM_ATAN2F(y, x) atan2f(y, x)
+#endif /* SPXM_FAST_MATH */
 
-vec3 vec3_rand(void)
+#ifdef SPXM_SIMD
+
+/* four lanes of SPXM_SINCOSF. With SPXM_FAST_MATH the lanes beyond the
+reduction range of spxm_sincosf go through it one by one, otherwise every
+lane calls sinf and cosf to stay bit exact with the scalar functions. */
+
+static void spxm_f4_sincosf(spxm_f4 x, spxm_f4* s, spxm_f4* c)
 {
-    vec3 p;
-    p.x = spxrandf();
-    p.y = spxrandf();
-    p.z = spxrandf();
-    return p;
+    float t[4], ts[4], tc[4];
+    int j;
+#ifdef SPXM_FAST_MATH
+    spxm_f4_sincos_pi(x, s, c);
+    if (!SPXM_M4_MASK(SPXM_F4_CMPGT(SPXM_F4_ABS(x), SPXM_F4_SET1(8192.0F)))) {
+        return;
+    }
+#endif /* SPXM_FAST_MATH */
+    SPXM_F4_STOREU(t, x);
+    for (j = 0; j < 4; ++j) {
+        SPXM_SINCOSF(t[j], ts + j, tc + j);
+    }
+    *s = SPXM_F4_LOADU(ts);
+    *c = SPXM_F4_LOADU(tc);
 }
 
-vec3 vec3_uni(float n)
+#endif /* SPXM_SIMD */
+
+/* platform independent pseudo random number generator functions */
+
+static SPXM_TLS unsigned int spxseed = 0;
+
+SPXM_API void spxrand_seed_set(unsigned int n) 
 {
-    vec3 p;
-    p.x = n;
-    p.y = n;
-    p.z = n;
-    return p;
+    spxseed = n;
 }
 
-vec3 vec3_new(float x, float y, float z)
+SPXM_API unsigned int spxrand_seed_get(void)
 {
-    vec3 p;
-    p.x = x;
-    p.y = y;
-    p.z = z;
-    return p;
+    return spxseed;
 }
 
-vec3 vec3_add(vec3 p, vec3 q)
+SPXM_API unsigned int spxrand(void)
 {
-    p.x += q.x;
-    p.y += q.y;
-    p.z += q.z;
-    return p;
+    return spxrand_hash(spxseed++);
 }
 
-vec3 vec3_sub(vec3 p, vec3 q)
+SPXM_API unsigned int spxrand_hash(unsigned int n)
 {
-    p.x -= q.x;
-    p.y -= q.y;
-    p.z -= q.z;
-    return p;
+    n = (n << 13) ^ n;
+    return ((n * (n * n * 15731 + 789221) + 1376312589) & SPXM_RANDMAX);
 }
 
-vec3 vec3_mult(vec3 p, float n)
+SPXM_API unsigned int spxrand_between(unsigned int min, unsigned int max)
 {
-    p.x *= n;
-    p.y *= n;
-    p.z *= n;
-    return p;
+    return min + (spxrand() % (max - min));
 }
 
-vec3 vec3_div(vec3 p, float n)
+SPXM_API float spxrandf(void)
 {
-    n = n == 0.0F ? 0.0F : 1.0F / n;
-    p.x *= n;
-    p.y *= n;
-    p.z *= n;
-    return p;
+    return (float)spxrand_hash(spxseed++) / (float)SPXM_RANDMAX;
 }
 
-vec3 vec3_norm(vec3 p)
+SPXM_API float spxrandf_hash(unsigned int hash)
 {
-    float n = sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
-    n = n == 0.0F ? 0.0F : 1.0F / n;
-    p.x *= n;
-    p.y *= n;
-    p.z *= n;
-    return p;
+    return (float)spxrand_hash(hash) / (float)SPXM_RANDMAX;
 }
 
-vec3 vec3_cross(vec3 p, vec3 q)
+SPXM_API float spxrandf_between(float min, float max)
 {
-    vec3 v;
-    v.x = p.y * q.z - q.y * p.z;
-    v.y = p.z * q.x - q.z * p.x;
-    v.z = p.x * q.y - q.x * p.y;
-    return v;
+    return min + spxrandf() * (max - min);
 }
 
-vec3 vec3_prod(vec3 p, vec3 q)
+/* batch generation: out[i] is the value spxrand_hash(n + i) would give,
+so the fill functions produce exactly the sequence of repeated calls */
+
+#ifdef SPXM_SIMD
+
+static const unsigned int spxm_lane_index[4] = {0, 1, 2, 3};
+
+static spxm_i4 spxm_i4_rand_hash(spxm_i4 n)
 {
-    p.x *= q.x;
-    p.y *= q.y;
-    p.z *= q.z;
-    return p;
+    spxm_i4 m;
+    n = SPXM_I4_XOR(SPXM_I4_SHL(n, 13), n);
+    m = SPXM_I4_ADD(SPXM_I4_MUL(SPXM_I4_MUL(n, n), SPXM_I4_SET1(15731)), SPXM_I4_SET1(789221));
+    m = SPXM_I4_ADD(SPXM_I4_MUL(n, m), SPXM_I4_SET1(1376312589));
+    return SPXM_I4_AND(m, SPXM_I4_SET1(SPXM_RANDMAX));
 }
 
-vec3 vec3_lerp(vec3 p, vec3 q, float t)
+#endif /* SPXM_SIMD */
+
+SPXM_API void spxrand_hash_fill(unsigned int n, unsigned int* out, size_t count)
 {
-    p.x += t * (q.x - p.x);
-    p.y += t * (q.y - p.y);
-    p.z += t * (q.z - p.z);
-    return p;
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    spxm_i4 seed = SPXM_I4_ADD(SPXM_I4_SET1(n), SPXM_I4_LOADU(spxm_lane_index));
+    spxm_i4 step = SPXM_I4_SET1(4);
+    for (; i < (count & ~(size_t)3); i += 4) {
+        SPXM_I4_STOREU(out + i, spxm_i4_rand_hash(seed));
+        seed = SPXM_I4_ADD(seed, step);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = spxrand_hash(n + (unsigned int)i);
+    }
 }
 
-float vec3_sqmag(vec3 p)
+/* the hash is at most 2^31 - 1, so it converts exactly through a signed
+integer and the scale by 2^-31 equals the division by (float)SPXM_RANDMAX */
+
+SPXM_API void spxrandf_hash_fill(unsigned int n, float* out, size_t count)
 {
-    return p.x * p.x + p.y * p.y + p.z * p.z; 
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    spxm_i4 seed = SPXM_I4_ADD(SPXM_I4_SET1(n), SPXM_I4_LOADU(spxm_lane_index));
+    spxm_i4 step = SPXM_I4_SET1(4);
+    spxm_f4 scale = SPXM_F4_SET1(1.0F / (float)SPXM_RANDMAX);
+    for (; i < (count & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out + i, SPXM_F4_MUL(SPXM_I4_TO_F4(spxm_i4_rand_hash(seed)), scale));
+        seed = SPXM_I4_ADD(seed, step);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = spxrandf_hash(n + (unsigned int)i);
+    }
 }
 
-float vec3_mag(vec3 p)
+SPXM_API void spxrand_fill(unsigned int* out, size_t count)
 {
-    return sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+    spxrand_hash_fill(spxseed, out, count);
+    spxseed += (unsigned int)count;
 }
 
-float vec3_sqdist(vec3 p, vec3 q)
+SPXM_API void spxrandf_fill(float* out, size_t count)
 {
-    p.x -= q.x;
-    p.y -= q.y;
-    p.z -= q.z;
-    return p.x * p.x + p.y * p.y + p.z * p.z; 
+    spxrandf_hash_fill(spxseed, out, count);
+    spxseed += (unsigned int)count;
 }
 
-float vec3_dist(vec3 p, vec3 q)
+/* explicit generator state, each spxrng produces the same sequence as
+the global functions would after spxrand_seed_set(rng.seed) */
+
+SPXM_API spxrng spxrng_new(unsigned int seed)
 {
-    p.x -= q.x;
-    p.y -= q.y;
-    p.z -= q.z; 
-    return sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+    spxrng rng;
+    rng.seed = seed;
+    rng.type = SPXRNG_HASH;
+    rng.index = 0;
+    rng.buffer[0] = rng.buffer[1] = rng.buffer[2] = rng.buffer[3] = 0;
+    rng.state[0] = rng.state[1] = rng.state[2] = rng.state[3] = 0;
+    return rng;
 }
 
-float vec3_dot(vec3 p, vec3 q)
+/* reproducible independent streams for parallel work: stream i starts
+i * SPXM_RNG_STREAM_SIZE values after seed, so streams never overlap
+while each draws fewer than SPXM_RNG_STREAM_SIZE values */
+
+SPXM_API spxrng spxrng_stream(unsigned int seed, unsigned int stream)
 {
-    return p.x * q.x + p.y * q.y + p.z * q.z;
+    return spxrng_new(seed + stream * (unsigned int)SPXM_RNG_STREAM_SIZE);
 }
 
-/* vec4 implementation */
+/* alternative backends with full 32 and 64 bit output and long periods:
+xoshiro128+ (2^128 - 1), xoshiro256** (2^256 - 1), PCG32 XSH RR (2^64 per
+stream) and Philox4x32-10 (counter based, 2^128 per key) */
 
-vec4 vec4_uni(float n)
+static unsigned int spxrng_rotl32(unsigned int x, int k)
 {
-    vec4 p;
+    return (x << k) | (x >> (32 - k));
+}
+
+static spxu64 spxrng_rotl64(spxu64 x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static spxu64 spxrng_splitmix64(spxu64* x)
+{
+    spxu64 z = (*x += SPXM_U64(0x9e3779b9, 0x7f4a7c15));
+    z = (z ^ (z >> 30)) * SPXM_U64(0xbf58476d, 0x1ce4e5b9);
+    z = (z ^ (z >> 27)) * SPXM_U64(0x94d049bb, 0x133111eb);
+    return z ^ (z >> 31);
+}
+
+static unsigned int spxrng_xoshiro128p(spxrng* rng)
+{
+    unsigned int s0 = (unsigned int)rng->state[0], s1 = (unsigned int)rng->state[1];
+    unsigned int s2 = (unsigned int)rng->state[2], s3 = (unsigned int)rng->state[3];
+    unsigned int r = s0 + s3, t = s1 << 9;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = spxrng_rotl32(s3, 11);
+    rng->state[0] = s0;
+    rng->state[1] = s1;
+    rng->state[2] = s2;
+    rng->state[3] = s3;
+    return r;
+}
+
+static spxu64 spxrng_xoshiro256ss(spxrng* rng)
+{
+    spxu64* s = rng->state;
+    spxu64 r = spxrng_rotl64(s[1] * 5, 7) * 9, t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = spxrng_rotl64(s[3], 45);
+    return r;
+}
+
+static unsigned int spxrng_pcg32(spxrng* rng)
+{
+    spxu64 old = rng->state[0];
+    unsigned int x, rot;
+    rng->state[0] = old * SPXM_U64(0x5851f42d, 0x4c957f2d) + rng->state[1];
+    x = (unsigned int)(((old >> 18) ^ old) >> 27);
+    rot = (unsigned int)(old >> 59);
+    return (x >> rot) | (x << ((0U - rot) & 31));
+}
+
+static void spxrng_philox(spxrng* rng)
+{
+    unsigned int c0 = (unsigned int)rng->state[0], c1 = (unsigned int)(rng->state[0] >> 32);
+    unsigned int c2 = (unsigned int)rng->state[1], c3 = (unsigned int)(rng->state[1] >> 32);
+    unsigned int k0 = (unsigned int)rng->state[2], k1 = (unsigned int)(rng->state[2] >> 32);
+    int i;
+    for (i = 0; i < 10; ++i) {
+        spxu64 p0 = (spxu64)0xD2511F53 * c0, p1 = (spxu64)0xCD9E8D57 * c2;
+        c0 = (unsigned int)(p1 >> 32) ^ c1 ^ k0;
+        c2 = (unsigned int)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (unsigned int)p1;
+        c3 = (unsigned int)p0;
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+    }
+    rng->buffer[0] = c0;
+    rng->buffer[1] = c1;
+    rng->buffer[2] = c2;
+    rng->buffer[3] = c3;
+    rng->index = 0;
+    if (++rng->state[0] == 0) {
+        ++rng->state[1];
+    }
+}
+
+static void spxrng_jump(spxrng* rng)
+{
+    static const unsigned int jump128[4] = {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b};
+    static const unsigned int jump256[8] = {
+        0x3cfd0aba, 0x180ec6d3, 0xf0c9392c, 0xd5a61266,
+        0xe03fc9aa, 0xa9582618, 0x29b1661c, 0x39abdc45
+    };
+    spxu64 s[4] = {0, 0, 0, 0};
+    int i, b;
+
+    if (rng->type == SPXRNG_XOSHIRO128P) {
+        for (i = 0; i < 4; ++i) {
+            for (b = 0; b < 32; ++b) {
+                if (jump128[i] & (1U << b)) {
+                    s[0] ^= rng->state[0];
+                    s[1] ^= rng->state[1];
+                    s[2] ^= rng->state[2];
+                    s[3] ^= rng->state[3];
+                }
+                spxrng_xoshiro128p(rng);
+            }
+        }
+    } else {
+        for (i = 0; i < 8; ++i) {
+            for (b = 0; b < 32; ++b) {
+                if (jump256[i] & (1U << b)) {
+                    s[0] ^= rng->state[0];
+                    s[1] ^= rng->state[1];
+                    s[2] ^= rng->state[2];
+                    s[3] ^= rng->state[3];
+                }
+                spxrng_xoshiro256ss(rng);
+            }
+        }
+    }
+
+    rng->state[0] = s[0];
+    rng->state[1] = s[1];
+    rng->state[2] = s[2];
+    rng->state[3] = s[3];
+}
+
+/* create a generator of any backend, different streams of the same seed
+are statistically independent: xoshiro streams are 2^64 (xoshiro128+) or
+2^128 (xoshiro256**) values apart, PCG32 streams use distinct increments
+and Philox streams use the upper half of the 128 bit counter. The xoshiro
+streams cost one jump per stream index, 128 or 256 generator steps each, so
+creating stream n is O(n). PCG32 and Philox create any stream in O(1). */
+
+SPXM_API spxrng spxrng_create(unsigned int type, spxu64 seed, spxu64 stream)
+{
+    spxrng rng = spxrng_new((unsigned int)seed);
+    spxu64 i, x = seed;
+    rng.type = type;
+
+    switch (type) {
+        case SPXRNG_XOSHIRO128P:
+        case SPXRNG_XOSHIRO256SS:
+            do {
+                rng.state[0] = spxrng_splitmix64(&x);
+                rng.state[1] = spxrng_splitmix64(&x);
+                rng.state[2] = spxrng_splitmix64(&x);
+                rng.state[3] = spxrng_splitmix64(&x);
+                if (type == SPXRNG_XOSHIRO128P) {
+                    rng.state[0] &= 0xffffffff;
+                    rng.state[1] &= 0xffffffff;
+                    rng.state[2] &= 0xffffffff;
+                    rng.state[3] &= 0xffffffff;
+                }
+            } while (!(rng.state[0] | rng.state[1] | rng.state[2] | rng.state[3]));
+            for (i = 0; i < stream; ++i) {
+                spxrng_jump(&rng);
+            }
+            break;
+        case SPXRNG_PCG32:
+            rng.state[0] = 0;
+            rng.state[1] = (stream << 1) | 1;
+            spxrng_pcg32(&rng);
+            rng.state[0] += seed;
+            spxrng_pcg32(&rng);
+            break;
+        case SPXRNG_PHILOX:
+            rng.state[0] = 0;
+            rng.state[1] = stream;
+            rng.state[2] = seed;
+            rng.index = 4;
+            break;
+        default:
+            rng.type = SPXRNG_HASH;
+            rng.seed = (unsigned int)seed + (unsigned int)stream * (unsigned int)SPXM_RNG_STREAM_SIZE;
+            break;
+    }
+    return rng;
+}
+
+/* full 32 bit output of any backend, the 31 bit hash backend combines
+two consecutive values of spxrand_hash for every 32 bit value */
+
+SPXM_API unsigned int spxrand32_r(spxrng* rng)
+{
+    unsigned int n;
+    switch (rng->type) {
+        case SPXRNG_XOSHIRO128P:
+            return spxrng_xoshiro128p(rng);
+        case SPXRNG_XOSHIRO256SS:
+            return (unsigned int)(spxrng_xoshiro256ss(rng) >> 32);
+        case SPXRNG_PCG32:
+            return spxrng_pcg32(rng);
+        case SPXRNG_PHILOX:
+            if (rng->index >= 4) {
+                spxrng_philox(rng);
+            }
+            return rng->buffer[rng->index++];
+        default:
+            n = spxrand_hash(rng->seed++);
+            return n ^ (spxrand_hash(rng->seed++) << 16);
+    }
+}
+
+SPXM_API spxu64 spxrand64_r(spxrng* rng)
+{
+    spxu64 n;
+    if (rng->type == SPXRNG_XOSHIRO256SS) {
+        return spxrng_xoshiro256ss(rng);
+    }
+    n = spxrand32_r(rng);
+    return (n << 32) | spxrand32_r(rng);
+}
+
+/* unbiased integer in [0, range) with Lemire's multiply and reject */
+
+SPXM_API unsigned int spxrand_bounded_r(spxrng* rng, unsigned int range)
+{
+    spxu64 m = (spxu64)spxrand32_r(rng) * range;
+    unsigned int low = (unsigned int)m, t;
+    if (low < range) {
+        t = (0U - range) % range;
+        while (low < t) {
+            m = (spxu64)spxrand32_r(rng) * range;
+            low = (unsigned int)m;
+        }
+    }
+    return (unsigned int)(m >> 32);
+}
+
+/* uniform float in [0, 1) from the top 24 bits, without a divide */
+
+SPXM_API float spxrandf_bits(unsigned int bits)
+{
+    return (float)(bits >> 8) * (1.0F / 16777216.0F);
+}
+
+/* the hash backend keeps the exact legacy sequences of spxrand, spxrandf
+and spxrand_between, other backends use spxrand32_r, spxrandf_bits and
+the unbiased spxrand_bounded_r */
+
+SPXM_API unsigned int spxrand_r(spxrng* rng)
+{
+    if (rng->type == SPXRNG_HASH) {
+        return spxrand_hash(rng->seed++);
+    }
+    return spxrand32_r(rng) >> 1;
+}
+
+SPXM_API unsigned int spxrand_between_r(spxrng* rng, unsigned int min, unsigned int max)
+{
+    if (rng->type == SPXRNG_HASH) {
+        return min + (spxrand_r(rng) % (max - min));
+    }
+    return min + spxrand_bounded_r(rng, max - min);
+}
+
+SPXM_API float spxrandf_r(spxrng* rng)
+{
+    if (rng->type == SPXRNG_HASH) {
+        return (float)spxrand_hash(rng->seed++) / (float)SPXM_RANDMAX;
+    }
+    return spxrandf_bits(spxrand32_r(rng));
+}
+
+SPXM_API float spxrandf_between_r(spxrng* rng, float min, float max)
+{
+    return min + spxrandf_r(rng) * (max - min);
+}
+
+SPXM_API void spxrand_fill_r(spxrng* rng, unsigned int* out, size_t count)
+{
+    size_t i;
+    if (rng->type == SPXRNG_HASH) {
+        spxrand_hash_fill(rng->seed, out, count);
+        rng->seed += (unsigned int)count;
+        return;
+    }
+    for (i = 0; i < count; ++i) {
+        out[i] = spxrand32_r(rng) >> 1;
+    }
+}
+
+SPXM_API void spxrandf_fill_r(spxrng* rng, float* out, size_t count)
+{
+    size_t i;
+    if (rng->type == SPXRNG_HASH) {
+        spxrandf_hash_fill(rng->seed, out, count);
+        rng->seed += (unsigned int)count;
+        return;
+    }
+    for (i = 0; i < count; ++i) {
+        out[i] = spxrandf_bits(spxrand32_r(rng));
+    }
+}
+
+/* random distribution samplers, every sample consumes a fixed number of
+uniform values from the generator and is never rejected */
+
+#define SPXM_SAMPLER_CHUNK 256
+
+#define SPXM_SAMPLER_GLOBAL(call) do { \
+    spxrng rng = spxrng_new(spxseed); call; spxseed = rng.seed; } while (0)
+
+/* standard normal distribution, Box-Muller transform on pairs of values */
+
+SPXM_API void spxrandf_normal_fill_r(spxrng* rng, float* out, size_t count)
+{
+    float u[SPXM_SAMPLER_CHUNK];
+    size_t i, j, n;
+    while (count) {
+        n = count < SPXM_SAMPLER_CHUNK ? count : SPXM_SAMPLER_CHUNK;
+        spxrandf_fill_r(rng, u, (n + 1) & ~(size_t)1);
+        i = 0;
+#ifdef SPXM_SIMD
+        for (; i < (n & ~(size_t)7); i += 8) {
+            spxm_f4 r, s, c, u1 = SPXM_F4_SUB(SPXM_F4_SET1(1.0F), SPXM_F4_LOADU(u + i));
+            u1 = SPXM_F4_MAX(u1, SPXM_F4_SET1(1e-30F));
+            r = SPXM_F4_SQRT(SPXM_F4_MUL(SPXM_F4_SET1(-2.0F), spxm_f4_log(u1)));
+            spxm_f4_sincos(SPXM_F4_MUL(SPXM_F4_LOADU(u + i + 4), SPXM_F4_SET1(2.0F * (float)M_PI)), &s, &c);
+            SPXM_F4_STOREU(out + i, SPXM_F4_MUL(r, c));
+            SPXM_F4_STOREU(out + i + 4, SPXM_F4_MUL(r, s));
+        }
+#endif /* SPXM_SIMD */
+        for (; i < (n & ~(size_t)7); i += 8) {
+            for (j = i; j < i + 4; ++j) {
+                float r = sqrtf(-2.0F * logf(maxf(1.0F - u[j], 1e-30F)));
+                float t = u[j + 4] * 2.0F * (float)M_PI;
+                out[j] = r * cosf(t);
+                out[j + 4] = r * sinf(t);
+            }
+        }
+        for (; i < n; i += 2) {
+            float r = sqrtf(-2.0F * logf(maxf(1.0F - u[i], 1e-30F)));
+            float t = u[i + 1] * 2.0F * (float)M_PI;
+            out[i] = r * cosf(t);
+            if (i + 1 < n) {
+                out[i + 1] = r * sinf(t);
+            }
+        }
+        out += n;
+        count -= n;
+    }
+}
+
+SPXM_API void spxrandf_normal_fill(float* out, size_t count)
+{
+    SPXM_SAMPLER_GLOBAL(spxrandf_normal_fill_r(&rng, out, count));
+}
+
+/* uniform distribution on the unit disk, sqrt(u) radius and uniform angle */
+
+SPXM_API void vec2_rand_disk_fill_r(spxrng* rng, vec2* out, size_t count)
+{
+    float u[SPXM_SAMPLER_CHUNK * 2];
+    size_t i, n;
+    while (count) {
+        n = count < SPXM_SAMPLER_CHUNK ? count : SPXM_SAMPLER_CHUNK;
+        spxrandf_fill_r(rng, u, n * 2);
+        i = 0;
+#ifdef SPXM_SIMD
+        for (; i < (n & ~(size_t)3); i += 4) {
+            spxm_f4 r, s, c;
+            r = SPXM_F4_SQRT(SPXM_F4_LOADU(u + i));
+            spxm_f4_sincos(SPXM_F4_MUL(SPXM_F4_LOADU(u + n + i), SPXM_F4_SET1(2.0F * (float)M_PI)), &s, &c);
+            spxm_f4_store_vec2(&out[i].x, SPXM_F4_MUL(r, c), SPXM_F4_MUL(r, s));
+        }
+#endif /* SPXM_SIMD */
+        for (; i < n; ++i) {
+            float r = sqrtf(u[i]), t = u[n + i] * 2.0F * (float)M_PI;
+            out[i].x = r * cosf(t);
+            out[i].y = r * sinf(t);
+        }
+        out += n;
+        count -= n;
+    }
+}
+
+SPXM_API void vec2_rand_disk_fill(vec2* out, size_t count)
+{
+    SPXM_SAMPLER_GLOBAL(vec2_rand_disk_fill_r(&rng, out, count));
+}
+
+/* uniform distribution on the surface of the unit sphere */
+
+SPXM_API void vec3_rand_sphere_fill_r(spxrng* rng, vec3* out, size_t count)
+{
+    float u[SPXM_SAMPLER_CHUNK * 2];
+    size_t i, n;
+    while (count) {
+        n = count < SPXM_SAMPLER_CHUNK ? count : SPXM_SAMPLER_CHUNK;
+        spxrandf_fill_r(rng, u, n * 2);
+        i = 0;
+#ifdef SPXM_SIMD
+        for (; i < (n & ~(size_t)3); i += 4) {
+            spxm_f4 z, r, s, c, one = SPXM_F4_SET1(1.0F);
+            z = SPXM_F4_SUB(one, SPXM_F4_MUL(SPXM_F4_LOADU(u + i), SPXM_F4_SET1(2.0F)));
+            r = SPXM_F4_SQRT(SPXM_F4_MAX(SPXM_F4_SUB(one, SPXM_F4_MUL(z, z)), SPXM_F4_ZERO()));
+            spxm_f4_sincos(SPXM_F4_MUL(SPXM_F4_LOADU(u + n + i), SPXM_F4_SET1(2.0F * (float)M_PI)), &s, &c);
+            spxm_f4_store_vec3(&out[i].x, SPXM_F4_MUL(r, c), SPXM_F4_MUL(r, s), z);
+        }
+#endif /* SPXM_SIMD */
+        for (; i < n; ++i) {
+            float z = 1.0F - u[i] * 2.0F, t = u[n + i] * 2.0F * (float)M_PI;
+            float r = sqrtf(maxf(1.0F - z * z, 0.0F));
+            out[i].x = r * cosf(t);
+            out[i].y = r * sinf(t);
+            out[i].z = z;
+        }
+        out += n;
+        count -= n;
+    }
+}
+
+SPXM_API void vec3_rand_sphere_fill(vec3* out, size_t count)
+{
+    SPXM_SAMPLER_GLOBAL(vec3_rand_sphere_fill_r(&rng, out, count));
+}
+
+/* cosine weighted distribution on the hemisphere around +z, a disk
+sample projected up to the unit sphere */
+
+SPXM_API void vec3_rand_hemisphere_fill_r(spxrng* rng, vec3* out, size_t count)
+{
+    float u[SPXM_SAMPLER_CHUNK * 2];
+    size_t i, n;
+    while (count) {
+        n = count < SPXM_SAMPLER_CHUNK ? count : SPXM_SAMPLER_CHUNK;
+        spxrandf_fill_r(rng, u, n * 2);
+        i = 0;
+#ifdef SPXM_SIMD
+        for (; i < (n & ~(size_t)3); i += 4) {
+            spxm_f4 a, r, z, s, c;
+            a = SPXM_F4_LOADU(u + i);
+            r = SPXM_F4_SQRT(a);
+            z = SPXM_F4_SQRT(SPXM_F4_MAX(SPXM_F4_SUB(SPXM_F4_SET1(1.0F), a), SPXM_F4_ZERO()));
+            spxm_f4_sincos(SPXM_F4_MUL(SPXM_F4_LOADU(u + n + i), SPXM_F4_SET1(2.0F * (float)M_PI)), &s, &c);
+            spxm_f4_store_vec3(&out[i].x, SPXM_F4_MUL(r, c), SPXM_F4_MUL(r, s), z);
+        }
+#endif /* SPXM_SIMD */
+        for (; i < n; ++i) {
+            float r = sqrtf(u[i]), t = u[n + i] * 2.0F * (float)M_PI;
+            out[i].x = r * cosf(t);
+            out[i].y = r * sinf(t);
+            out[i].z = sqrtf(maxf(1.0F - u[i], 0.0F));
+        }
+        out += n;
+        count -= n;
+    }
+}
+
+SPXM_API void vec3_rand_hemisphere_fill(vec3* out, size_t count)
+{
+    SPXM_SAMPLER_GLOBAL(vec3_rand_hemisphere_fill_r(&rng, out, count));
+}
+
+/* uniformly distributed unit quaternions (x, y, z, w) with Shoemake's method */
+
+SPXM_API void vec4_rand_rotation_fill_r(spxrng* rng, vec4* out, size_t count)
+{
+    float u[SPXM_SAMPLER_CHUNK * 3];
+    size_t i, n;
+    while (count) {
+        n = count < SPXM_SAMPLER_CHUNK ? count : SPXM_SAMPLER_CHUNK;
+        spxrandf_fill_r(rng, u, n * 3);
+        i = 0;
+#ifdef SPXM_SIMD
+        for (; i < (n & ~(size_t)3); i += 4) {
+            spxm_f4 a, r1, r2, s1, c1, s2, c2, tau = SPXM_F4_SET1(2.0F * (float)M_PI);
+            a = SPXM_F4_LOADU(u + i);
+            r1 = SPXM_F4_SQRT(SPXM_F4_MAX(SPXM_F4_SUB(SPXM_F4_SET1(1.0F), a), SPXM_F4_ZERO()));
+            r2 = SPXM_F4_SQRT(a);
+            spxm_f4_sincos(SPXM_F4_MUL(SPXM_F4_LOADU(u + n + i), tau), &s1, &c1);
+            spxm_f4_sincos(SPXM_F4_MUL(SPXM_F4_LOADU(u + n * 2 + i), tau), &s2, &c2);
+            spxm_f4_store_vec4(&out[i].x, SPXM_F4_MUL(r1, s1), SPXM_F4_MUL(r1, c1),
+                SPXM_F4_MUL(r2, s2), SPXM_F4_MUL(r2, c2));
+        }
+#endif /* SPXM_SIMD */
+        for (; i < n; ++i) {
+            float r1 = sqrtf(maxf(1.0F - u[i], 0.0F)), r2 = sqrtf(u[i]);
+            float t1 = u[n + i] * 2.0F * (float)M_PI, t2 = u[n * 2 + i] * 2.0F * (float)M_PI;
+            out[i].x = r1 * sinf(t1);
+            out[i].y = r1 * cosf(t1);
+            out[i].z = r2 * sinf(t2);
+            out[i].w = r2 * cosf(t2);
+        }
+        out += n;
+        count -= n;
+    }
+}
+
+SPXM_API void vec4_rand_rotation_fill(vec4* out, size_t count)
+{
+    SPXM_SAMPLER_GLOBAL(vec4_rand_rotation_fill_r(&rng, out, count));
+}
+
+/* vec2 implementation */
+
+SPXM_API vec2 vec2_uni(float n)
+{
+    vec2 p;
     p.x = n;
     p.y = n;
-    p.z = n;
-    p.w = n;
     return p;
 }
 
-vec4 vec4_new(float x, float y, float z, float w)
-{
-    vec4 p;
+SPXM_API vec2 vec2_new(float x, float y)
+{ 
+    vec2 p;
     p.x = x;
-    p.y = y;
-    p.z = z;
-    p.w = w;
+    p.y = y; 
     return p;
 }
 
-vec4 vec4_rand(void)
+SPXM_API vec2 vec2_rand(void)
 {
-    vec4 p;
+    vec2 p;
     p.x = spxrandf();
     p.y = spxrandf();
-    p.z = spxrandf();
-    p.w = spxrandf();
     return p;
 }
 
-vec4 vec4_add(vec4 p, vec4 q)
+SPXM_API void vec2_rand_fill(vec2* out, size_t count)
+{
+    spxrandf_fill(&out->x, count * 2);
+}
+
+SPXM_API vec2 vec2_rand_r(spxrng* rng)
+{
+    vec2 p;
+    p.x = spxrandf_r(rng);
+    p.y = spxrandf_r(rng);
+    return p;
+}
+
+SPXM_API void vec2_rand_fill_r(spxrng* rng, vec2* out, size_t count)
+{
+    spxrandf_fill_r(rng, &out->x, count * 2);
+}
+
+SPXM_API vec2 vec2_add(vec2 p, vec2 q)
 {
     p.x += q.x;
     p.y += q.y;
-    p.z += q.z;
-    p.w += q.w;
     return p;
 }
 
-vec4 vec4_sub(vec4 p, vec4 q)
+SPXM_API vec2 vec2_sub(vec2 p, vec2 q)
+{
+	p.x -= q.x;
+    p.y -= q.y;
+    return p;
+}
+
+SPXM_API vec2 vec2_mult(vec2 p, float n)
+{
+    p.x *= n;
+    p.y *= n;
+    return p;
+}
+
+SPXM_API vec2 vec2_div(vec2 p, float n)
+{
+	n = n == 0.0F ? 0.0F : 1.0F / n; 
+    p.x *= n;
+    p.y *= n;
+    return p;
+}
+
+SPXM_API vec2 vec2_norm(vec2 p)
+{
+    float n = p.x * p.x + p.y * p.y;
+    n = n == 0.0F ? 0.0F : SPXM_RSQRTF(n);
+    p.x *= n;
+    p.y *= n;
+    return p;
+}
+
+SPXM_API vec2 vec2_norm_fast(vec2 p)
+{
+    float n = p.x * p.x + p.y * p.y;
+    n = n == 0.0F ? 0.0F : rsqrtf_fast(n);
+    p.x *= n;
+    p.y *= n;
+    return p;
+}
+
+SPXM_API vec2 vec2_cross(vec2 p, vec2 q)
+{
+	float y = p.x - q.x;
+    p.x = -(p.y - q.y),
+    p.y = y;
+    return p;
+}
+
+SPXM_API vec2 vec2_prod(vec2 p, vec2 q)
+{
+    p.x *= q.x;
+    p.y *= q.y;
+    return p;
+}
+
+SPXM_API vec2 vec2_lerp(vec2 p, vec2 q, float t)
+{
+    p.x += t * (q.x - p.x);
+    p.y += t * (q.y - p.y);
+    return p;
+}
+
+SPXM_API vec2 vec2_from_rad(float rad)
+{
+	vec2 p;
+    SPXM_SINCOSF(rad, &p.y, &p.x);
+    return p;
+}
+
+/* sinf_fast and cosf_fast sharing one range reduction */
+
+SPXM_API vec2 vec2_from_rad_fast(float rad)
+{
+    union { float f; unsigned int i; } q, r;
+    float y;
+    vec2 p;
+    q.f = rad * 0.318309886F + 12582912.0F;
+    y = q.f - 12582912.0F;
+    rad = SPXM_PI_REDUCE(rad, y);
+    q.i <<= 31;
+    r.f = spxm_cosf_poly(rad);
+    r.i ^= q.i;
+    p.x = r.f;
+    r.f = spxm_sinf_poly(rad);
+    r.i ^= q.i;
+    p.y = r.f;
+    return p;
+}
+
+/* same as vec2_from_rad for precomputed s = sinf(rad) and c = cosf(rad) */
+
+SPXM_API vec2 vec2_from_sincos(float s, float c)
+{
+    vec2 p;
+    p.x = c;
+    p.y = s;
+    return p;
+}
+
+SPXM_API float vec2_sqmag(vec2 p)
+{
+	return p.x * p.x + p.y * p.y;
+}
+
+SPXM_API float vec2_mag(vec2 p)
+{
+	return sqrtf(p.x * p.x + p.y * p.y);
+}
+
+SPXM_API float vec2_sqdist(vec2 p, vec2 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+	return p.x * p.x + p.y * p.y;
+}
+
+SPXM_API float vec2_dist(vec2 p, vec2 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+	return sqrtf(p.x * p.x + p.y * p.y);
+}
+
+SPXM_API float vec2_dot(vec2 p, vec2 q)
+{
+	return p.x * q.x + p.y * q.y;
+}
+
+SPXM_API float vec2_rads(vec2 p)
+{
+	return SPXM_ATAN2F(p.y, p.x);
+}
+
+SPXM_API float vec2_rads_fast(vec2 p)
+{
+	return atan2f_fast(p.y, p.x);
+}
+
+/* counterclockwise rotation, the sine and cosine of vec2_from_rad */
+
+SPXM_API vec2 vec2_rotate(vec2 p, float rad)
+{
+    vec2 q, r = vec2_from_rad(rad);
+    q.x = r.x * p.x - r.y * p.y;
+    q.y = r.y * p.x + r.x * p.y;
+    return q;
+}
+
+/* batch 2D kernels, results match the scalar functions element by element
+and out may point to the input arrays */
+
+SPXM_API void vec2_array_rotate(const vec2* in, const float* rad, vec2* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, s, c;
+        spxm_f4_load_vec2(&in[i].x, &x, &y);
+        spxm_f4_sincosf(SPXM_F4_LOADU(rad + i), &s, &c);
+        spxm_f4_store_vec2(&out[i].x, SPXM_F4_SUB(SPXM_F4_MUL(c, x), SPXM_F4_MUL(s, y)),
+            SPXM_F4_ADD(SPXM_F4_MUL(s, x), SPXM_F4_MUL(c, y)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = vec2_rotate(in[i], rad[i]);
+    }
+}
+
+/* vec2_from_rad(rad[i]) scaled by mag[i], unit vectors if mag is NULL */
+
+SPXM_API void vec2_array_from_polar(const float* rad, const float* mag, vec2* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 s, c, r;
+        spxm_f4_sincosf(SPXM_F4_LOADU(rad + i), &s, &c);
+        if (mag) {
+            r = SPXM_F4_LOADU(mag + i);
+            s = SPXM_F4_MUL(s, r);
+            c = SPXM_F4_MUL(c, r);
+        }
+        spxm_f4_store_vec2(&out[i].x, c, s);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        vec2 p = vec2_from_rad(rad[i]);
+        if (mag) {
+            p.x *= mag[i];
+            p.y *= mag[i];
+        }
+        out[i] = p;
+    }
+}
+
+/* vec2_rads and vec2_mag of every element, the angles are only vectorized
+with SPXM_FAST_MATH or in vec2_array_to_polar_fast */
+
+SPXM_API void vec2_array_to_polar(const vec2* in, float* rad, float* mag, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y;
+        spxm_f4_load_vec2(&in[i].x, &x, &y);
+#ifdef SPXM_FAST_MATH
+        SPXM_F4_STOREU(rad + i, spxm_f4_atan2(y, x));
+#else
+        {
+            size_t j;
+            for (j = i; j < i + 4; ++j) {
+                rad[j] = atan2f(in[j].y, in[j].x);
+            }
+        }
+#endif /* SPXM_FAST_MATH */
+        SPXM_F4_STOREU(mag + i, SPXM_F4_SQRT(SPXM_F4_ADD(SPXM_F4_MUL(x, x), SPXM_F4_MUL(y, y))));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        vec2 p = in[i];
+        rad[i] = vec2_rads(p);
+        mag[i] = vec2_mag(p);
+    }
+}
+
+SPXM_API void vec2_array_to_polar_fast(const vec2* in, float* rad, float* mag, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y;
+        spxm_f4_load_vec2(&in[i].x, &x, &y);
+        SPXM_F4_STOREU(rad + i, spxm_f4_atan2(y, x));
+        SPXM_F4_STOREU(mag + i, SPXM_F4_SQRT(SPXM_F4_ADD(SPXM_F4_MUL(x, x), SPXM_F4_MUL(y, y))));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        vec2 p = in[i];
+        rad[i] = vec2_rads_fast(p);
+        mag[i] = vec2_mag(p);
+    }
+}
+
+SPXM_API void vec2_array_norm(const vec2* in, vec2* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, n, zero = SPXM_F4_ZERO();
+        spxm_f4_load_vec2(&in[i].x, &x, &y);
+        n = SPXM_F4_ADD(SPXM_F4_MUL(x, x), SPXM_F4_MUL(y, y));
+        n = SPXM_F4_SELECT(SPXM_F4_CMPEQ(n, zero), zero, SPXM_F4_RSQRT(n));
+        spxm_f4_store_vec2(&out[i].x, SPXM_F4_MUL(x, n), SPXM_F4_MUL(y, n));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = vec2_norm(in[i]);
+    }
+}
+
+SPXM_API void vec2_array_norm_fast(const vec2* in, vec2* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, n, zero = SPXM_F4_ZERO();
+        spxm_f4_load_vec2(&in[i].x, &x, &y);
+        n = SPXM_F4_ADD(SPXM_F4_MUL(x, x), SPXM_F4_MUL(y, y));
+        n = SPXM_F4_SELECT(SPXM_F4_CMPEQ(n, zero), zero, spxm_f4_rsqrt(n));
+        spxm_f4_store_vec2(&out[i].x, SPXM_F4_MUL(x, n), SPXM_F4_MUL(y, n));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = vec2_norm_fast(in[i]);
+    }
+}
+
+/* vec2_cross(p[i], q[i]), the perpendicular of p[i] - q[i], or of p[i]
+itself if q is NULL */
+
+SPXM_API void vec2_array_cross(const vec2* p, const vec2* q, vec2* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 px, py, qx, qy;
+        spxm_f4_load_vec2(&p[i].x, &px, &py);
+        if (q) {
+            spxm_f4_load_vec2(&q[i].x, &qx, &qy);
+            px = SPXM_F4_SUB(px, qx);
+            py = SPXM_F4_SUB(py, qy);
+        }
+        spxm_f4_store_vec2(&out[i].x, SPXM_F4_XOR(py, SPXM_F4_SIGNMASK()), px);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        vec2 r = p[i];
+        if (q) {
+            r = vec2_cross(r, q[i]);
+        } else {
+            float y = r.x;
+            r.x = -r.y;
+            r.y = y;
+        }
+        out[i] = r;
+    }
+}
+
+/* vec3 implementation */
+
+SPXM_API vec3 vec3_rand(void)
+{
+    vec3 p;
+    p.x = spxrandf();
+    p.y = spxrandf();
+    p.z = spxrandf();
+    return p;
+}
+
+SPXM_API void vec3_rand_fill(vec3* out, size_t count)
+{
+    spxrandf_fill(&out->x, count * 3);
+}
+
+SPXM_API vec3 vec3_rand_r(spxrng* rng)
+{
+    vec3 p;
+    p.x = spxrandf_r(rng);
+    p.y = spxrandf_r(rng);
+    p.z = spxrandf_r(rng);
+    return p;
+}
+
+SPXM_API void vec3_rand_fill_r(spxrng* rng, vec3* out, size_t count)
+{
+    spxrandf_fill_r(rng, &out->x, count * 3);
+}
+
+SPXM_API vec3 vec3_uni(float n)
+{
+    vec3 p;
+    p.x = n;
+    p.y = n;
+    p.z = n;
+    return p;
+}
+
+SPXM_API vec3 vec3_new(float x, float y, float z)
+{
+    vec3 p;
+    p.x = x;
+    p.y = y;
+    p.z = z;
+    return p;
+}
+
+SPXM_API vec3 vec3_add(vec3 p, vec3 q)
+{
+    p.x += q.x;
+    p.y += q.y;
+    p.z += q.z;
+    return p;
+}
+
+SPXM_API vec3 vec3_sub(vec3 p, vec3 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+    p.z -= q.z;
+    return p;
+}
+
+SPXM_API vec3 vec3_mult(vec3 p, float n)
+{
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    return p;
+}
+
+SPXM_API vec3 vec3_div(vec3 p, float n)
+{
+    n = n == 0.0F ? 0.0F : 1.0F / n;
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    return p;
+}
+
+SPXM_API vec3 vec3_norm(vec3 p)
+{
+    float n = p.x * p.x + p.y * p.y + p.z * p.z;
+    n = n == 0.0F ? 0.0F : SPXM_RSQRTF(n);
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    return p;
+}
+
+SPXM_API vec3 vec3_norm_fast(vec3 p)
+{
+    float n = p.x * p.x + p.y * p.y + p.z * p.z;
+    n = n == 0.0F ? 0.0F : rsqrtf_fast(n);
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    return p;
+}
+
+SPXM_API vec3 vec3_cross(vec3 p, vec3 q)
+{
+    vec3 v;
+    v.x = p.y * q.z - q.y * p.z;
+    v.y = p.z * q.x - q.z * p.x;
+    v.z = p.x * q.y - q.x * p.y;
+    return v;
+}
+
+SPXM_API vec3 vec3_prod(vec3 p, vec3 q)
+{
+    p.x *= q.x;
+    p.y *= q.y;
+    p.z *= q.z;
+    return p;
+}
+
+SPXM_API vec3 vec3_lerp(vec3 p, vec3 q, float t)
+{
+    p.x += t * (q.x - p.x);
+    p.y += t * (q.y - p.y);
+    p.z += t * (q.z - p.z);
+    return p;
+}
+
+SPXM_API float vec3_sqmag(vec3 p)
+{
+    return p.x * p.x + p.y * p.y + p.z * p.z; 
+}
+
+SPXM_API float vec3_mag(vec3 p)
+{
+    return sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+}
+
+SPXM_API float vec3_sqdist(vec3 p, vec3 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+    p.z -= q.z;
+    return p.x * p.x + p.y * p.y + p.z * p.z; 
+}
+
+SPXM_API float vec3_dist(vec3 p, vec3 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+    p.z -= q.z; 
+    return sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+}
+
+SPXM_API float vec3_dot(vec3 p, vec3 q)
+{
+    return p.x * q.x + p.y * q.y + p.z * q.z;
+}
+
+/* vec4 implementation */
+
+SPXM_API vec4 vec4_uni(float n)
+{
+    vec4 p;
+    p.x = n;
+    p.y = n;
+    p.z = n;
+    p.w = n;
+    return p;
+}
+
+SPXM_API vec4 vec4_new(float x, float y, float z, float w)
+{
+    vec4 p;
+    p.x = x;
+    p.y = y;
+    p.z = z;
+    p.w = w;
+    return p;
+}
+
+SPXM_API vec4 vec4_rand(void)
+{
+    vec4 p;
+    p.x = spxrandf();
+    p.y = spxrandf();
+    p.z = spxrandf();
+    p.w = spxrandf();
+    return p;
+}
+
+SPXM_API void vec4_rand_fill(vec4* out, size_t count)
+{
+    spxrandf_fill(&out->x, count * 4);
+}
+
+SPXM_API vec4 vec4_rand_r(spxrng* rng)
+{
+    vec4 p;
+    p.x = spxrandf_r(rng);
+    p.y = spxrandf_r(rng);
+    p.z = spxrandf_r(rng);
+    p.w = spxrandf_r(rng);
+    return p;
+}
+
+SPXM_API void vec4_rand_fill_r(spxrng* rng, vec4* out, size_t count)
+{
+    spxrandf_fill_r(rng, &out->x, count * 4);
+}
+
+SPXM_API vec4 vec4_add(vec4 p, vec4 q)
+{
+    p.x += q.x;
+    p.y += q.y;
+    p.z += q.z;
+    p.w += q.w;
+    return p;
+}
+
+SPXM_API vec4 vec4_sub(vec4 p, vec4 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+    p.z -= q.z;
+    p.w -= q.w;
+    return p;
+}
+
+SPXM_API vec4 vec4_mult(vec4 p, float n)
+{
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    p.w *= n;
+    return p;
+}
+
+SPXM_API vec4 vec4_div(vec4 p, float n)
+{
+    n = n == 0.0F ? 0.0F : 1.0F / n; 
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    p.w *= n;
+    return p;
+}
+
+SPXM_API vec4 vec4_norm(vec4 p)
+{
+    float n = p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w;
+    n = n == 0.0F ? 0.0F : SPXM_RSQRTF(n);
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    p.w *= n;
+    return p;
+}
+
+SPXM_API vec4 vec4_norm_fast(vec4 p)
+{
+    float n = p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w;
+    n = n == 0.0F ? 0.0F : rsqrtf_fast(n);
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    p.w *= n;
+    return p;
+}
+
+SPXM_API vec4 vec4_prod(vec4 p, vec4 q)
+{
+    p.x *= q.x;
+    p.y *= q.y;
+    p.z *= q.z;
+    p.w *= q.w;
+    return p;
+}
+
+SPXM_API vec4 vec4_lerp(vec4 p, vec4 q, float t)
+{ 
+    p.x += t * (q.x - p.x);
+    p.y += t * (q.y - p.y);
+    p.z += t * (q.z - p.z);
+    p.w += t * (q.w - p.w);
+    return p;
+}
+
+SPXM_API float vec4_sqmag(vec4 p)
+{
+    return p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w;
+}
+
+SPXM_API float vec4_mag(vec4 p)
+{
+    return sqrtf(p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w);
+}
+
+SPXM_API float vec4_sqdist(vec4 p, vec4 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+    p.z -= q.z;
+    p.w -= q.w;
+    return p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w;
+}
+
+SPXM_API float vec4_dist(vec4 p, vec4 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+    p.z -= q.z;
+    p.w -= q.w;
+    return sqrtf(p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w);
+}
+
+SPXM_API float vec4_dot(vec4 p, vec4 q)
+{
+    return p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w;
+}
+
+SPXM_API vec4 vec4_mult_mat4(vec4 p, mat4 m)
+{
+    vec4 q;
+    q.x = p.x * m.data[0][0] + p.y * m.data[1][0] + p.z * m.data[2][0] + p.w * m.data[3][0];
+    q.y = p.x * m.data[0][1] + p.y * m.data[1][1] + p.z * m.data[2][1] + p.w * m.data[3][1];
+    q.z = p.x * m.data[0][2] + p.y * m.data[1][2] + p.z * m.data[2][2] + p.w * m.data[3][2];
+    q.w = p.x * m.data[0][3] + p.y * m.data[1][3] + p.z * m.data[2][3] + p.w * m.data[3][3];
+    return q;
+}
+
+/* pointer versions of the vec4 operations, out must not overlap the inputs */
+
+SPXM_API void vec4_add_to(vec4* SPXM_RESTRICT out, const vec4* p, const vec4* q)
+{
+    out->x = p->x + q->x;
+    out->y = p->y + q->y;
+    out->z = p->z + q->z;
+    out->w = p->w + q->w;
+}
+
+SPXM_API void vec4_sub_to(vec4* SPXM_RESTRICT out, const vec4* p, const vec4* q)
+{
+    out->x = p->x - q->x;
+    out->y = p->y - q->y;
+    out->z = p->z - q->z;
+    out->w = p->w - q->w;
+}
+
+SPXM_API void vec4_mult_to(vec4* SPXM_RESTRICT out, const vec4* p, float n)
+{
+    out->x = p->x * n;
+    out->y = p->y * n;
+    out->z = p->z * n;
+    out->w = p->w * n;
+}
+
+SPXM_API void vec4_prod_to(vec4* SPXM_RESTRICT out, const vec4* p, const vec4* q)
+{
+    out->x = p->x * q->x;
+    out->y = p->y * q->y;
+    out->z = p->z * q->z;
+    out->w = p->w * q->w;
+}
+
+SPXM_API void vec4_lerp_to(vec4* SPXM_RESTRICT out, const vec4* p, const vec4* q, float t)
+{
+    out->x = p->x + t * (q->x - p->x);
+    out->y = p->y + t * (q->y - p->y);
+    out->z = p->z + t * (q->z - p->z);
+    out->w = p->w + t * (q->w - p->w);
+}
+
+SPXM_API void vec4_norm_to(vec4* SPXM_RESTRICT out, const vec4* p)
+{
+    *out = vec4_norm(*p);
+}
+
+SPXM_API void vec4_mult_mat4_to(vec4* SPXM_RESTRICT out, const vec4* p, const mat4* m)
+{
+#if defined(SPXM_SIMD)
+    spxm_f4 r = SPXM_F4_MUL(SPXM_F4_LOADU(m->data[0]), SPXM_F4_SET1(p->x));
+    r = SPXM_F4_ADD(r, SPXM_F4_MUL(SPXM_F4_LOADU(m->data[1]), SPXM_F4_SET1(p->y)));
+    r = SPXM_F4_ADD(r, SPXM_F4_MUL(SPXM_F4_LOADU(m->data[2]), SPXM_F4_SET1(p->z)));
+    r = SPXM_F4_ADD(r, SPXM_F4_MUL(SPXM_F4_LOADU(m->data[3]), SPXM_F4_SET1(p->w)));
+    SPXM_F4_STOREU(&out->x, r);
+#else
+    *out = vec4_mult_mat4(*p, *m);
+#endif /* SPXM_SIMD */
+}
+
+/* batch transforms: in and out may be the same buffer, strides are in bytes */
+
+SPXM_API void vec4_array_mult_mat4(const mat4* m, const vec4* in, vec4* out, size_t count)
+{
+    vec4_array_mult_mat4_stride(m, in, sizeof(vec4), out, sizeof(vec4), count);
+}
+
+SPXM_API void vec3_array_mult_mat4_point(const mat4* m, const vec3* in, vec3* out, size_t count)
+{
+    vec3_array_mult_mat4_point_stride(m, in, sizeof(vec3), out, sizeof(vec3), count);
+}
+
+SPXM_API void vec3_array_mult_mat4_dir(const mat4* m, const vec3* in, vec3* out, size_t count)
+{
+    vec3_array_mult_mat4_dir_stride(m, in, sizeof(vec3), out, sizeof(vec3), count);
+}
+
+SPXM_API void vec4_array_mult_mat4_stride(const mat4* m, const void* in, size_t in_stride, void* out, size_t out_stride, size_t count)
+{
+    size_t i = 0;
+    const unsigned char* src = (const unsigned char*)in;
+    unsigned char* dst = (unsigned char*)out;
+#if defined(SPXM_AVX)
+    __m256 c0, c1, c2, c3, v, r;
+    c0 = _mm256_castps128_ps256(_mm_loadu_ps(m->data[0]));
+    c1 = _mm256_castps128_ps256(_mm_loadu_ps(m->data[1]));
+    c2 = _mm256_castps128_ps256(_mm_loadu_ps(m->data[2]));
+    c3 = _mm256_castps128_ps256(_mm_loadu_ps(m->data[3]));
+    c0 = _mm256_insertf128_ps(c0, _mm256_castps256_ps128(c0), 1);
+    c1 = _mm256_insertf128_ps(c1, _mm256_castps256_ps128(c1), 1);
+    c2 = _mm256_insertf128_ps(c2, _mm256_castps256_ps128(c2), 1);
+    c3 = _mm256_insertf128_ps(c3, _mm256_castps256_ps128(c3), 1);
+    for (; i < (count & ~(size_t)1); i += 2) {
+        const float* p = (const float*)(const void*)(src + i * in_stride);
+        const float* q = (const float*)(const void*)(src + (i + 1) * in_stride);
+        float* a = (float*)(void*)(dst + i * out_stride);
+        float* b = (float*)(void*)(dst + (i + 1) * out_stride);
+        v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(q), 1);
+        r = _mm256_mul_ps(c0, _mm256_shuffle_ps(v, v, 0x00));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c1, _mm256_shuffle_ps(v, v, 0x55)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c2, _mm256_shuffle_ps(v, v, 0xAA)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c3, _mm256_shuffle_ps(v, v, 0xFF)));
+        _mm_storeu_ps(a, _mm256_castps256_ps128(r));
+        _mm_storeu_ps(b, _mm256_extractf128_ps(r, 1));
+    }
+#endif /* SPXM_AVX */
+#if defined(SPXM_SIMD)
+    {
+        spxm_f4 m0, m1, m2, m3, v4, r4;
+        m0 = SPXM_F4_LOADU(m->data[0]);
+        m1 = SPXM_F4_LOADU(m->data[1]);
+        m2 = SPXM_F4_LOADU(m->data[2]);
+        m3 = SPXM_F4_LOADU(m->data[3]);
+        for (; i < count; ++i) {
+            v4 = SPXM_F4_LOADU((const float*)(const void*)(src + i * in_stride));
+            r4 = SPXM_F4_MUL(m0, SPXM_F4_SPLAT(v4, 0));
+            r4 = SPXM_F4_ADD(r4, SPXM_F4_MUL(m1, SPXM_F4_SPLAT(v4, 1)));
+            r4 = SPXM_F4_ADD(r4, SPXM_F4_MUL(m2, SPXM_F4_SPLAT(v4, 2)));
+            r4 = SPXM_F4_ADD(r4, SPXM_F4_MUL(m3, SPXM_F4_SPLAT(v4, 3)));
+            SPXM_F4_STOREU((float*)(void*)(dst + i * out_stride), r4);
+        }
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        vec4 p = *(const vec4*)(const void*)(src + i * in_stride);
+        *(vec4*)(void*)(dst + i * out_stride) = vec4_mult_mat4(p, *m);
+    }
+}
+
+SPXM_API void vec3_array_mult_mat4_point_stride(const mat4* m, const void* in, size_t in_stride, void* out, size_t out_stride, size_t count)
+{
+    size_t i = 0;
+    const unsigned char* src = (const unsigned char*)in;
+    unsigned char* dst = (unsigned char*)out;
+#if defined(SPXM_SIMD)
+    spxm_f4 m0, m1, m2, m3, r;
+    m0 = SPXM_F4_LOADU(m->data[0]);
+    m1 = SPXM_F4_LOADU(m->data[1]);
+    m2 = SPXM_F4_LOADU(m->data[2]);
+    m3 = SPXM_F4_LOADU(m->data[3]);
+    for (; i < count; ++i) {
+        const float* p = (const float*)(const void*)(src + i * in_stride);
+        r = SPXM_F4_MUL(m0, SPXM_F4_SET1(p[0]));
+        r = SPXM_F4_ADD(r, SPXM_F4_MUL(m1, SPXM_F4_SET1(p[1])));
+        r = SPXM_F4_ADD(r, SPXM_F4_MUL(m2, SPXM_F4_SET1(p[2])));
+        r = SPXM_F4_ADD(r, m3);
+        SPXM_F4_STORE3((float*)(void*)(dst + i * out_stride), r);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        vec3 p = *(const vec3*)(const void*)(src + i * in_stride);
+        vec3* q = (vec3*)(void*)(dst + i * out_stride);
+        q->x = p.x * m->data[0][0] + p.y * m->data[1][0] + p.z * m->data[2][0] + m->data[3][0];
+        q->y = p.x * m->data[0][1] + p.y * m->data[1][1] + p.z * m->data[2][1] + m->data[3][1];
+        q->z = p.x * m->data[0][2] + p.y * m->data[1][2] + p.z * m->data[2][2] + m->data[3][2];
+    }
+}
+
+SPXM_API void vec3_array_mult_mat4_dir_stride(const mat4* m, const void* in, size_t in_stride, void* out, size_t out_stride, size_t count)
+{
+    size_t i = 0;
+    const unsigned char* src = (const unsigned char*)in;
+    unsigned char* dst = (unsigned char*)out;
+#if defined(SPXM_SIMD)
+    spxm_f4 m0, m1, m2, r;
+    m0 = SPXM_F4_LOADU(m->data[0]);
+    m1 = SPXM_F4_LOADU(m->data[1]);
+    m2 = SPXM_F4_LOADU(m->data[2]);
+    for (; i < count; ++i) {
+        const float* p = (const float*)(const void*)(src + i * in_stride);
+        r = SPXM_F4_MUL(m0, SPXM_F4_SET1(p[0]));
+        r = SPXM_F4_ADD(r, SPXM_F4_MUL(m1, SPXM_F4_SET1(p[1])));
+        r = SPXM_F4_ADD(r, SPXM_F4_MUL(m2, SPXM_F4_SET1(p[2])));
+        SPXM_F4_STORE3((float*)(void*)(dst + i * out_stride), r);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        vec3 p = *(const vec3*)(const void*)(src + i * in_stride);
+        vec3* q = (vec3*)(void*)(dst + i * out_stride);
+        q->x = p.x * m->data[0][0] + p.y * m->data[1][0] + p.z * m->data[2][0];
+        q->y = p.x * m->data[0][1] + p.y * m->data[1][1] + p.z * m->data[2][1];
+        q->z = p.x * m->data[0][2] + p.y * m->data[1][2] + p.z * m->data[2][2];
+    }
+}
+
+/* 4 x 4 matrix operations */
+
+SPXM_API mat4 mat4_id(void)
+{
+    mat4 m = {{
+        {1.0F, 0.0F, 0.0F, 0.0F},
+        {0.0F, 1.0F, 0.0F, 0.0F},
+        {0.0F, 0.0F, 1.0F, 0.0F},
+        {0.0F, 0.0F, 0.0F, 1.0F}
+    }};
+    return m;
+}
+
+SPXM_API mat4 mat4_zero(void)
+{
+    mat4 m = {{{0.0F}}};
+    return m;
+}
+
+SPXM_API mat4 mat4_translate(mat4 m, vec3 p)
+{
+    m.data[3][0] = p.x;
+    m.data[3][1] = p.y;
+    m.data[3][2] = p.z;
+    return m;
+}
+
+SPXM_API mat4 mat4_mult(mat4 m1, mat4 m2)
+{
+    mat4 m;
+    mat4_mult_to(&m, &m1, &m2);
+    return m;
+}
+
+/* Every column of the result is accumulated in the same order as the
+scalar path without fused multiply-add, so all paths are bit-identical
+unless the compiler itself contracts the products (-ffp-contract=fast),
+in which case results differ by at most the rounding of each product.
+out must not point to m1 or m2, see mat4_mult_inplace. */
+
+SPXM_API void mat4_mult_to(mat4* SPXM_RESTRICT out, const mat4* m1, const mat4* m2)
+{
+#if defined(SPXM_AVX)
+    int i;
+    __m256 c0, c1, c2, c3, r, m;
+    c0 = _mm256_castps128_ps256(_mm_loadu_ps(m1->data[0]));
+    c1 = _mm256_castps128_ps256(_mm_loadu_ps(m1->data[1]));
+    c2 = _mm256_castps128_ps256(_mm_loadu_ps(m1->data[2]));
+    c3 = _mm256_castps128_ps256(_mm_loadu_ps(m1->data[3]));
+    c0 = _mm256_insertf128_ps(c0, _mm256_castps256_ps128(c0), 1);
+    c1 = _mm256_insertf128_ps(c1, _mm256_castps256_ps128(c1), 1);
+    c2 = _mm256_insertf128_ps(c2, _mm256_castps256_ps128(c2), 1);
+    c3 = _mm256_insertf128_ps(c3, _mm256_castps256_ps128(c3), 1);
+    for (i = 0; i < 4; i += 2) {
+        r = _mm256_loadu_ps(m2->data[i]);
+        m = _mm256_mul_ps(c0, _mm256_shuffle_ps(r, r, 0x00));
+        m = _mm256_add_ps(m, _mm256_mul_ps(c1, _mm256_shuffle_ps(r, r, 0x55)));
+        m = _mm256_add_ps(m, _mm256_mul_ps(c2, _mm256_shuffle_ps(r, r, 0xAA)));
+        m = _mm256_add_ps(m, _mm256_mul_ps(c3, _mm256_shuffle_ps(r, r, 0xFF)));
+        _mm256_storeu_ps(out->data[i], m);
+    }
+#elif defined(SPXM_SIMD)
+    int i;
+    spxm_f4 c0, c1, c2, c3, r, m;
+    c0 = SPXM_F4_LOADU(m1->data[0]);
+    c1 = SPXM_F4_LOADU(m1->data[1]);
+    c2 = SPXM_F4_LOADU(m1->data[2]);
+    c3 = SPXM_F4_LOADU(m1->data[3]);
+    for (i = 0; i < 4; ++i) {
+        r = SPXM_F4_LOADU(m2->data[i]);
+        m = SPXM_F4_MUL(c0, SPXM_F4_SPLAT(r, 0));
+        m = SPXM_F4_ADD(m, SPXM_F4_MUL(c1, SPXM_F4_SPLAT(r, 1)));
+        m = SPXM_F4_ADD(m, SPXM_F4_MUL(c2, SPXM_F4_SPLAT(r, 2)));
+        m = SPXM_F4_ADD(m, SPXM_F4_MUL(c3, SPXM_F4_SPLAT(r, 3)));
+        SPXM_F4_STOREU(out->data[i], m);
+    }
+#else
+    int i;
+    for (i = 0; i < 4; ++i) {
+        out->data[i][0] = m1->data[0][0] * m2->data[i][0] + m1->data[1][0] * m2->data[i][1] + m1->data[2][0] * m2->data[i][2] + m1->data[3][0] * m2->data[i][3];
+        out->data[i][1] = m1->data[0][1] * m2->data[i][0] + m1->data[1][1] * m2->data[i][1] + m1->data[2][1] * m2->data[i][2] + m1->data[3][1] * m2->data[i][3];
+        out->data[i][2] = m1->data[0][2] * m2->data[i][0] + m1->data[1][2] * m2->data[i][1] + m1->data[2][2] * m2->data[i][2] + m1->data[3][2] * m2->data[i][3];
+        out->data[i][3] = m1->data[0][3] * m2->data[i][0] + m1->data[1][3] * m2->data[i][1] + m1->data[2][3] * m2->data[i][2] + m1->data[3][3] * m2->data[i][3];
+    }
+#endif
+}
+
+/* m1 = m1 * m2, m2 may point to m1 */
+
+SPXM_API void mat4_mult_inplace(mat4* m1, const mat4* m2)
+{
+    mat4 m;
+    mat4_mult_to(&m, m1, m2);
+    *m1 = m;
+}
+
+SPXM_API mat4 mat4_mult_vec4(mat4 m, vec4 p)
+{
+    m.data[0][0] *= p.x;
+    m.data[0][1] *= p.x;
+    m.data[0][2] *= p.x;
+    m.data[0][3] *= p.x;
+    m.data[1][0] *= p.y;
+    m.data[1][1] *= p.y;
+    m.data[1][2] *= p.y;
+    m.data[1][3] *= p.y;
+    m.data[2][0] *= p.z;
+    m.data[2][1] *= p.z;
+    m.data[2][2] *= p.z;
+    m.data[2][3] *= p.z;
+    m.data[3][0] *= p.w;
+    m.data[3][1] *= p.w;
+    m.data[3][2] *= p.w;
+    m.data[3][3] *= p.w;
+    return m;
+}
+
+SPXM_API mat4 mat4_mult_vec3(mat4 m, vec3 p)
+{
+    m.data[0][0] *= p.x;
+    m.data[0][1] *= p.x;
+    m.data[0][2] *= p.x;
+    m.data[0][3] *= p.x;
+    m.data[1][0] *= p.y;
+    m.data[1][1] *= p.y;
+    m.data[1][2] *= p.y;
+    m.data[1][3] *= p.y;
+    m.data[2][0] *= p.z;
+    m.data[2][1] *= p.z;
+    m.data[2][2] *= p.z;
+    m.data[2][3] *= p.z;
+    return m;
+}
+
+SPXM_API mat4 mat4_scale(mat4 m, vec3 p)
+{
+    mat4 M = {{{0.0F}}};
+    M.data[0][0] = p.x;
+    M.data[1][1] = p.y;
+    M.data[2][2] = p.z;
+    M.data[3][3] = 1.0F;
+    return mat4_mult(M, m);
+}
+
+SPXM_API mat4 mat4_rot(mat4 mat, float deg, vec3 rot_axis)
+{
+    float c, s;
+    SPXM_SINCOSF(deg, &s, &c);
+    return mat4_rot_sincos(mat, s, c, rot_axis);
+}
+
+/* mat4_rot with precomputed s = sinf(deg) and c = cosf(deg), for angles
+shared by many matrices or read from a sincos_lut */
+
+SPXM_API mat4 mat4_rot_sincos(mat4 mat, float s, float c, vec3 rot_axis)
+{
+    vec3 axis, temp;
+    mat4 rot = {{{0.0F}}}, m = {{{0.0F}}};
+
+    axis = vec3_norm(rot_axis);
+	temp = vec3_mult(axis, 1.0f - c);
+
+    rot.data[0][0] = c + temp.x * axis.x;
+    rot.data[0][1] = temp.x * axis.y + s * axis.z;
+    rot.data[0][2] = temp.x * axis.z - s * axis.y;
+    rot.data[1][0] = temp.y * axis.x - s * axis.z;
+    rot.data[1][1] = c + temp.y * axis.y;
+    rot.data[1][2] = temp.y * axis.z + s * axis.x;
+    rot.data[2][0] = temp.z * axis.x + s * axis.y;
+    rot.data[2][1] = temp.z * axis.y - s * axis.x;
+    rot.data[2][2] = c + temp.z * axis.z;
+
+    m.data[0][0] = mat.data[0][0] * rot.data[0][0] + mat.data[1][0] * rot.data[0][1] + mat.data[2][0] * rot.data[0][2];
+    m.data[0][1] = mat.data[0][1] * rot.data[0][0] + mat.data[1][1] * rot.data[0][1] + mat.data[2][1] * rot.data[0][2];
+    m.data[0][2] = mat.data[0][2] * rot.data[0][0] + mat.data[1][2] * rot.data[0][1] + mat.data[2][2] * rot.data[0][2];
+    m.data[1][0] = mat.data[0][0] * rot.data[1][0] + mat.data[1][0] * rot.data[1][1] + mat.data[2][0] * rot.data[1][2];
+    m.data[1][1] = mat.data[0][1] * rot.data[1][0] + mat.data[1][1] * rot.data[1][1] + mat.data[2][1] * rot.data[1][2];
+    m.data[1][2] = mat.data[0][2] * rot.data[1][0] + mat.data[1][2] * rot.data[1][1] + mat.data[2][2] * rot.data[1][2];
+    m.data[2][0] = mat.data[0][0] * rot.data[2][0] + mat.data[1][0] * rot.data[2][1] + mat.data[2][0] * rot.data[2][2];
+    m.data[2][1] = mat.data[0][1] * rot.data[2][0] + mat.data[1][1] * rot.data[2][1] + mat.data[2][1] * rot.data[2][2];
+    m.data[2][2] = mat.data[0][2] * rot.data[2][0] + mat.data[1][2] * rot.data[2][1] + mat.data[2][2] * rot.data[2][2];
+    m.data[3][0] = mat.data[3][0];
+    m.data[3][1] = mat.data[3][1];
+    m.data[3][2] = mat.data[3][2];
+    m.data[3][3] = mat.data[3][3];
+    return m;
+}
+
+SPXM_API mat4 mat4_perspective_RH(float fov, float aspect, float near, float far)
+{
+    mat4 m = {{{0.0F}}};
+    float tan_half_fov = tanf(fov / 2.0f);
+    m.data[0][0] = 1.0f / (aspect * tan_half_fov);
+    m.data[1][1] = 1.0f / tan_half_fov;
+    m.data[2][2] = (far + near) / (far - near);
+    m.data[2][3] = 1.0f;
+    m.data[3][2] = (2.0f * far * near) / (far - near);
+    return m;
+}
+
+SPXM_API mat4 mat4_perspective_LH(float fov, float aspect, float near, float far)
+{
+    mat4 m = {{{0.0F}}};
+    float tan_half_fov = tanf(fov / 2.0f);
+    m.data[0][0] = 1.0f / (aspect * tan_half_fov);
+    m.data[1][1] = 1.0f / tan_half_fov;
+    m.data[2][2] = (far + near) / (far - near);
+    m.data[2][3] = 1.0f;
+    m.data[3][2] = - (2.0f * far * near) / (far - near);
+    return m;
+}
+
+SPXM_API mat4 mat4_look_at_RH(vec3 eye_position, vec3 eye_direction, vec3 eye_up)
+{
+    vec3 f, s, u;
+    mat4 m = {{{0.0F}}};
+    f = vec3_norm(vec3_sub(eye_direction, eye_position));
+    s = vec3_norm(vec3_cross(f, eye_up));
+    u = vec3_cross(s, f);
+    m.data[0][0] = s.x;
+    m.data[1][0] = s.y;
+    m.data[2][0] = s.z;
+    m.data[0][1] = u.x;
+    m.data[1][1] = u.y;
+    m.data[2][1] = u.z;
+    m.data[0][2] = -f.x;
+    m.data[1][2] = -f.y;
+    m.data[2][2] = -f.z;
+    m.data[3][0] = -vec3_dot(s, eye_position);
+    m.data[3][1] = -vec3_dot(u, eye_position);
+    m.data[3][2] = vec3_dot(f, eye_position);
+    m.data[3][3] = 1.0f;
+    return m;
+}
+
+SPXM_API mat4 mat4_look_at_LH(vec3 eye_position, vec3 eye_direction, vec3 eye_up)
+{
+    vec3 f, s, u;
+    mat4 m = {{{0.0F}}};
+    f = vec3_norm(vec3_sub(eye_direction, eye_position));
+    s = vec3_norm(vec3_cross(eye_up, f));
+    u = vec3_cross(f, s);
+    m.data[0][0] = s.x;
+    m.data[1][0] = s.y;
+    m.data[2][0] = s.z;
+    m.data[0][1] = u.x;
+    m.data[1][1] = u.y;
+    m.data[2][1] = u.z;
+    m.data[0][2] = f.x;
+    m.data[1][2] = f.y;
+    m.data[2][2] = f.z;
+    m.data[3][0] = -vec3_dot(s, eye_position);
+    m.data[3][1] = -vec3_dot(u, eye_position);
+    m.data[3][2] = -vec3_dot(f, eye_position);
+    m.data[3][3] = 1.0f;
+    return m;
+}
+
+SPXM_API mat4 mat4_ortho(float left, float right, float bottom, float top)
+{
+    mat4 ret = mat4_id();
+    ret.data[0][0] = 2.0f / (right - left);
+    ret.data[1][1] = 2.0f / (top - bottom);
+    ret.data[2][2] = - 1.0f;
+    ret.data[3][0] = - (right + left) / (right - left);
+    ret.data[3][1] = - (top + bottom) / (top - bottom);
+    return ret;
+}
+
+SPXM_API mat4 mat4_perspective(float fov, float aspect, float near, float far)
+{
+    return mat4_perspective_RH(fov, aspect, near, far);
+}
+
+SPXM_API mat4 mat4_look_at(vec3 eye_position, vec3 eye_direction, vec3 eye_up)
+{
+    return mat4_look_at_RH(eye_position, eye_direction, eye_up);
+}
+
+SPXM_API mat4 mat4_model(vec3 translation, vec3 scale, vec3 rot_axis, float rot_degs)
+{
+    mat4 model = mat4_scale(mat4_id(), scale);
+    model = mat4_rot(model, rot_degs, rot_axis);
+    model = mat4_translate(model, translation);
+    return model;
+}
+
+SPXM_API void mat4_model_to(mat4* SPXM_RESTRICT out, vec3 translation, vec3 scale, vec3 rot_axis, float rot_degs)
+{
+    *out = mat4_id();
+    mat4_scale_inplace(out, scale);
+    mat4_rot_inplace(out, rot_degs, rot_axis);
+    mat4_translate_inplace(out, translation);
+}
+
+/* in place versions of mat4_translate, mat4_scale and mat4_rot, the results
+match the by-value functions for affine matrices */
+
+SPXM_API void mat4_translate_inplace(mat4* m, vec3 p)
+{
+    m->data[3][0] = p.x;
+    m->data[3][1] = p.y;
+    m->data[3][2] = p.z;
+}
+
+SPXM_API void mat4_scale_inplace(mat4* m, vec3 p)
+{
+    int i;
+    for (i = 0; i < 4; ++i) {
+        m->data[i][0] *= p.x;
+        m->data[i][1] *= p.y;
+        m->data[i][2] *= p.z;
+    }
+}
+
+SPXM_API void mat4_rot_inplace(mat4* m, float deg, vec3 rot_axis)
+{
+    float c, s;
+    SPXM_SINCOSF(deg, &s, &c);
+    mat4_rot_sincos_inplace(m, s, c, rot_axis);
+}
+
+SPXM_API void mat4_rot_sincos_inplace(mat4* m, float s, float c, vec3 rot_axis)
+{
+    vec3 axis, temp;
+    float rot[3][3];
+
+    axis = vec3_norm(rot_axis);
+    temp = vec3_mult(axis, 1.0F - c);
+
+    rot[0][0] = c + temp.x * axis.x;
+    rot[0][1] = temp.x * axis.y + s * axis.z;
+    rot[0][2] = temp.x * axis.z - s * axis.y;
+    rot[1][0] = temp.y * axis.x - s * axis.z;
+    rot[1][1] = c + temp.y * axis.y;
+    rot[1][2] = temp.y * axis.z + s * axis.x;
+    rot[2][0] = temp.z * axis.x + s * axis.y;
+    rot[2][1] = temp.z * axis.y - s * axis.x;
+    rot[2][2] = c + temp.z * axis.z;
+
+#if defined(SPXM_SIMD)
+    {
+        int i;
+        spxm_f4 c0, c1, c2, r[3];
+        c0 = SPXM_F4_LOADU(m->data[0]);
+        c1 = SPXM_F4_LOADU(m->data[1]);
+        c2 = SPXM_F4_LOADU(m->data[2]);
+        for (i = 0; i < 3; ++i) {
+            r[i] = SPXM_F4_MUL(c0, SPXM_F4_SET1(rot[i][0]));
+            r[i] = SPXM_F4_ADD(r[i], SPXM_F4_MUL(c1, SPXM_F4_SET1(rot[i][1])));
+            r[i] = SPXM_F4_ADD(r[i], SPXM_F4_MUL(c2, SPXM_F4_SET1(rot[i][2])));
+        }
+        SPXM_F4_STOREU(m->data[0], r[0]);
+        SPXM_F4_STOREU(m->data[1], r[1]);
+        SPXM_F4_STOREU(m->data[2], r[2]);
+    }
+#else
+    {
+        int i, j;
+        float col[3][4];
+        for (i = 0; i < 3; ++i) {
+            for (j = 0; j < 4; ++j) {
+                col[i][j] = m->data[0][j] * rot[i][0] + m->data[1][j] * rot[i][1] + m->data[2][j] * rot[i][2];
+            }
+        }
+        for (i = 0; i < 3; ++i) {
+            for (j = 0; j < 4; ++j) {
+                m->data[i][j] = col[i][j];
+            }
+        }
+    }
+#endif /* SPXM_SIMD */
+}
+
+/* Affine matrices have a bottom row of (0, 0, 0, 1), which is the case for
+everything built from mat4_translate, mat4_scale, mat4_rot and mat4_look_at.
+The affine functions assume it for their inputs and always write it exactly. */
+
+SPXM_API mat4 mat4_mult_affine(mat4 m1, mat4 m2)
+{
+    mat4 m;
+    mat4_mult_affine_to(&m, &m1, &m2);
+    return m;
+}
+
+SPXM_API void mat4_mult_affine_to(mat4* out, const mat4* m1, const mat4* m2)
+{
+#if defined(SPXM_SIMD)
+    int i;
+    spxm_f4 c0, c1, c2, c3, r, m;
+    spxm_m4 w = SPXM_I4_CMPEQ(SPXM_I4_LOADU(spxm_lane_index), SPXM_I4_SET1(3));
+    c0 = SPXM_F4_LOADU(m1->data[0]);
+    c1 = SPXM_F4_LOADU(m1->data[1]);
+    c2 = SPXM_F4_LOADU(m1->data[2]);
+    c3 = SPXM_F4_LOADU(m1->data[3]);
+    r = SPXM_F4_LOADU(m2->data[3]);
+    m = SPXM_F4_MUL(c0, SPXM_F4_SPLAT(r, 0));
+    m = SPXM_F4_ADD(m, SPXM_F4_MUL(c1, SPXM_F4_SPLAT(r, 1)));
+    m = SPXM_F4_ADD(m, SPXM_F4_MUL(c2, SPXM_F4_SPLAT(r, 2)));
+    c3 = SPXM_F4_SELECT(w, SPXM_F4_SET1(1.0F), SPXM_F4_ADD(m, c3));
+    for (i = 0; i < 3; ++i) {
+        r = SPXM_F4_LOADU(m2->data[i]);
+        m = SPXM_F4_MUL(c0, SPXM_F4_SPLAT(r, 0));
+        m = SPXM_F4_ADD(m, SPXM_F4_MUL(c1, SPXM_F4_SPLAT(r, 1)));
+        m = SPXM_F4_ADD(m, SPXM_F4_MUL(c2, SPXM_F4_SPLAT(r, 2)));
+        SPXM_F4_STOREU(out->data[i], SPXM_F4_SELECT(w, SPXM_F4_ZERO(), m));
+    }
+    SPXM_F4_STOREU(out->data[3], c3);
+#else
+    int i;
+    mat4 m;
+    for (i = 0; i < 4; ++i) {
+        m.data[i][0] = m1->data[0][0] * m2->data[i][0] + m1->data[1][0] * m2->data[i][1] + m1->data[2][0] * m2->data[i][2];
+        m.data[i][1] = m1->data[0][1] * m2->data[i][0] + m1->data[1][1] * m2->data[i][1] + m1->data[2][1] * m2->data[i][2];
+        m.data[i][2] = m1->data[0][2] * m2->data[i][0] + m1->data[1][2] * m2->data[i][1] + m1->data[2][2] * m2->data[i][2];
+        m.data[i][3] = 0.0F;
+    }
+    m.data[3][0] += m1->data[3][0];
+    m.data[3][1] += m1->data[3][1];
+    m.data[3][2] += m1->data[3][2];
+    m.data[3][3] = 1.0F;
+    *out = m;
+#endif
+}
+
+/* inverse of the 3 x 3 part through its adjugate, translation is -inv(A) t,
+a singular matrix gives a zero 3 x 3 part like SPXM_DIV does */
+
+SPXM_API mat4 mat4_inverse_affine(mat4 m)
+{
+    mat4 r;
+    float det;
+    r.data[0][0] = m.data[1][1] * m.data[2][2] - m.data[2][1] * m.data[1][2];
+    r.data[0][1] = m.data[2][1] * m.data[0][2] - m.data[0][1] * m.data[2][2];
+    r.data[0][2] = m.data[0][1] * m.data[1][2] - m.data[1][1] * m.data[0][2];
+    r.data[1][0] = m.data[2][0] * m.data[1][2] - m.data[1][0] * m.data[2][2];
+    r.data[1][1] = m.data[0][0] * m.data[2][2] - m.data[2][0] * m.data[0][2];
+    r.data[1][2] = m.data[1][0] * m.data[0][2] - m.data[0][0] * m.data[1][2];
+    r.data[2][0] = m.data[1][0] * m.data[2][1] - m.data[2][0] * m.data[1][1];
+    r.data[2][1] = m.data[2][0] * m.data[0][1] - m.data[0][0] * m.data[2][1];
+    r.data[2][2] = m.data[0][0] * m.data[1][1] - m.data[1][0] * m.data[0][1];
+    det = m.data[0][0] * r.data[0][0] + m.data[1][0] * r.data[0][1] + m.data[2][0] * r.data[0][2];
+    det = SPXM_DIV(det);
+
+    r.data[0][0] *= det;
+    r.data[0][1] *= det;
+    r.data[0][2] *= det;
+    r.data[1][0] *= det;
+    r.data[1][1] *= det;
+    r.data[1][2] *= det;
+    r.data[2][0] *= det;
+    r.data[2][1] *= det;
+    r.data[2][2] *= det;
+
+    r.data[3][0] = -(r.data[0][0] * m.data[3][0] + r.data[1][0] * m.data[3][1] + r.data[2][0] * m.data[3][2]);
+    r.data[3][1] = -(r.data[0][1] * m.data[3][0] + r.data[1][1] * m.data[3][1] + r.data[2][1] * m.data[3][2]);
+    r.data[3][2] = -(r.data[0][2] * m.data[3][0] + r.data[1][2] * m.data[3][1] + r.data[2][2] * m.data[3][2]);
+    r.data[0][3] = 0.0F;
+    r.data[1][3] = 0.0F;
+    r.data[2][3] = 0.0F;
+    r.data[3][3] = 1.0F;
+    return r;
+}
+
+/* rotation and translation only, the inverse rotation is the transpose */
+
+SPXM_API mat4 mat4_inverse_rigid(mat4 m)
+{
+    mat4 r;
+    r.data[0][0] = m.data[0][0];
+    r.data[0][1] = m.data[1][0];
+    r.data[0][2] = m.data[2][0];
+    r.data[1][0] = m.data[0][1];
+    r.data[1][1] = m.data[1][1];
+    r.data[1][2] = m.data[2][1];
+    r.data[2][0] = m.data[0][2];
+    r.data[2][1] = m.data[1][2];
+    r.data[2][2] = m.data[2][2];
+    r.data[3][0] = -(m.data[0][0] * m.data[3][0] + m.data[0][1] * m.data[3][1] + m.data[0][2] * m.data[3][2]);
+    r.data[3][1] = -(m.data[1][0] * m.data[3][0] + m.data[1][1] * m.data[3][1] + m.data[1][2] * m.data[3][2]);
+    r.data[3][2] = -(m.data[2][0] * m.data[3][0] + m.data[2][1] * m.data[3][1] + m.data[2][2] * m.data[3][2]);
+    r.data[0][3] = 0.0F;
+    r.data[1][3] = 0.0F;
+    r.data[2][3] = 0.0F;
+    r.data[3][3] = 1.0F;
+    return r;
+}
+
+/* General inverse through cofactors built from 2 x 2 sub-determinants.
+A singular matrix gives the zero matrix, consistent with SPXM_DIV. The SIMD
+paths evaluate the same expressions in the same order. */
+
+static void spxm_mat4_inverse(mat4* out, const mat4* m, float* det)
+{
+    const float (*a)[4] = m->data;
+    float s0, s1, s2, s3, s4, s5, c0, c1, c2, c3, c4, c5, d;
+    mat4 r;
+
+    s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+    s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+    s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+    s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+    s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+    c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+    c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+    c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+    c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+    c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+    c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+    d = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (det) {
+        *det = d;
+    }
+    if (!out) {
+        return;
+    }
+    d = SPXM_DIV(d);
+
+    r.data[0][0] = (a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * d;
+    r.data[0][1] = -(a[0][1] * c5 - a[0][2] * c4 + a[0][3] * c3) * d;
+    r.data[0][2] = (a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * d;
+    r.data[0][3] = -(a[2][1] * s5 - a[2][2] * s4 + a[2][3] * s3) * d;
+    r.data[1][0] = -(a[1][0] * c5 - a[1][2] * c2 + a[1][3] * c1) * d;
+    r.data[1][1] = (a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * d;
+    r.data[1][2] = -(a[3][0] * s5 - a[3][2] * s2 + a[3][3] * s1) * d;
+    r.data[1][3] = (a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * d;
+    r.data[2][0] = (a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * d;
+    r.data[2][1] = -(a[0][0] * c4 - a[0][1] * c2 + a[0][3] * c0) * d;
+    r.data[2][2] = (a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * d;
+    r.data[2][3] = -(a[2][0] * s4 - a[2][1] * s2 + a[2][3] * s0) * d;
+    r.data[3][0] = -(a[1][0] * c3 - a[1][1] * c1 + a[1][2] * c0) * d;
+    r.data[3][1] = (a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * d;
+    r.data[3][2] = -(a[3][0] * s3 - a[3][1] * s1 + a[3][2] * s0) * d;
+    r.data[3][3] = (a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * d;
+    *out = r;
+}
+
+#if defined(SPXM_SSE)
+
+/* spxm_mat4_inverse one column at a time. t[i] holds the elements i of the
+columns 1, 0, 3, 2 and k[i] the sub-determinants (ci, ci, si, si), so every
+lane of a result column runs the scalar formula in the same order and the
+results match it and mat4_array_inverse bit for bit. Returns the
+determinant in lane 2. */
+
+static __m128 spxm_sse_mat4_cofactors(const mat4* m, __m128* t, __m128* k)
+{
+    __m128 u[4], v[4], d;
+    __m128 c0 = _mm_loadu_ps(m->data[0]), c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]), c3 = _mm_loadu_ps(m->data[3]);
+    u[0] = _mm_shuffle_ps(c2, c0, _MM_SHUFFLE(0, 0, 0, 0));
+    u[1] = _mm_shuffle_ps(c2, c0, _MM_SHUFFLE(1, 1, 1, 1));
+    u[2] = _mm_shuffle_ps(c2, c0, _MM_SHUFFLE(2, 2, 2, 2));
+    u[3] = _mm_shuffle_ps(c2, c0, _MM_SHUFFLE(3, 3, 3, 3));
+    v[0] = _mm_shuffle_ps(c3, c1, _MM_SHUFFLE(0, 0, 0, 0));
+    v[1] = _mm_shuffle_ps(c3, c1, _MM_SHUFFLE(1, 1, 1, 1));
+    v[2] = _mm_shuffle_ps(c3, c1, _MM_SHUFFLE(2, 2, 2, 2));
+    v[3] = _mm_shuffle_ps(c3, c1, _MM_SHUFFLE(3, 3, 3, 3));
+    t[0] = c1;
+    t[1] = c0;
+    t[2] = c3;
+    t[3] = c2;
+    SPXM_F4_TRANSPOSE(t[0], t[1], t[2], t[3]);
+    k[0] = _mm_sub_ps(_mm_mul_ps(u[0], v[1]), _mm_mul_ps(v[0], u[1]));
+    k[1] = _mm_sub_ps(_mm_mul_ps(u[0], v[2]), _mm_mul_ps(v[0], u[2]));
+    k[2] = _mm_sub_ps(_mm_mul_ps(u[0], v[3]), _mm_mul_ps(v[0], u[3]));
+    k[3] = _mm_sub_ps(_mm_mul_ps(u[1], v[2]), _mm_mul_ps(v[1], u[2]));
+    k[4] = _mm_sub_ps(_mm_mul_ps(u[1], v[3]), _mm_mul_ps(v[1], u[3]));
+    k[5] = _mm_sub_ps(_mm_mul_ps(u[2], v[3]), _mm_mul_ps(v[2], u[3]));
+
+    d = _mm_sub_ps(_mm_mul_ps(k[0], SPXM_F4_SPLAT(k[5], 0)), _mm_mul_ps(k[1], SPXM_F4_SPLAT(k[4], 0)));
+    d = _mm_add_ps(d, _mm_mul_ps(k[2], SPXM_F4_SPLAT(k[3], 0)));
+    d = _mm_add_ps(d, _mm_mul_ps(k[3], SPXM_F4_SPLAT(k[2], 0)));
+    d = _mm_sub_ps(d, _mm_mul_ps(k[4], SPXM_F4_SPLAT(k[1], 0)));
+    return _mm_add_ps(d, _mm_mul_ps(k[5], SPXM_F4_SPLAT(k[0], 0)));
+}
+
+/* (a * x - b * y + c * z) * d with the sign flipped in the lanes of neg */
+
+static __m128 spxm_sse_cofactor(__m128 a, __m128 x, __m128 b, __m128 y, __m128 c, __m128 z, __m128 neg, __m128 d)
+{
+    __m128 r = _mm_sub_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y));
+    r = _mm_add_ps(r, _mm_mul_ps(c, z));
+    return _mm_mul_ps(_mm_xor_ps(r, neg), d);
+}
+
+#endif /* SPXM_SSE */
+
+SPXM_API mat4 mat4_inverse(mat4 m)
+{
+    mat4 r;
+    mat4_inverse_to(&r, &m);
+    return r;
+}
+
+SPXM_API void mat4_inverse_to(mat4* out, const mat4* m)
+{
+#if defined(SPXM_SSE)
+    __m128 t[4], k[6], d, zero = _mm_setzero_ps();
+    __m128 odd = _mm_castsi128_ps(_mm_setr_epi32(0, (int)0x80000000U, 0, (int)0x80000000U));
+    __m128 even = _mm_castsi128_ps(_mm_setr_epi32((int)0x80000000U, 0, (int)0x80000000U, 0));
+    d = spxm_sse_mat4_cofactors(m, t, k);
+    d = SPXM_F4_SPLAT(d, 2);
+    d = _mm_andnot_ps(_mm_cmpeq_ps(d, zero), _mm_div_ps(_mm_set1_ps(1.0F), d));
+    _mm_storeu_ps(out->data[0], spxm_sse_cofactor(t[1], k[5], t[2], k[4], t[3], k[3], odd, d));
+    _mm_storeu_ps(out->data[1], spxm_sse_cofactor(t[0], k[5], t[2], k[2], t[3], k[1], even, d));
+    _mm_storeu_ps(out->data[2], spxm_sse_cofactor(t[0], k[4], t[1], k[2], t[3], k[0], odd, d));
+    _mm_storeu_ps(out->data[3], spxm_sse_cofactor(t[0], k[3], t[1], k[1], t[2], k[0], even, d));
+#else
+    spxm_mat4_inverse(out, m, NULL);
+#endif /* SPXM_SSE */
+}
+
+SPXM_API mat4 mat4_transpose(mat4 m)
+{
+#if defined(SPXM_SIMD)
+    spxm_f4 c0, c1, c2, c3;
+    c0 = SPXM_F4_LOADU(m.data[0]);
+    c1 = SPXM_F4_LOADU(m.data[1]);
+    c2 = SPXM_F4_LOADU(m.data[2]);
+    c3 = SPXM_F4_LOADU(m.data[3]);
+    SPXM_F4_TRANSPOSE(c0, c1, c2, c3);
+    SPXM_F4_STOREU(m.data[0], c0);
+    SPXM_F4_STOREU(m.data[1], c1);
+    SPXM_F4_STOREU(m.data[2], c2);
+    SPXM_F4_STOREU(m.data[3], c3);
+    return m;
+#else
+    mat4 r;
+    int i;
+    for (i = 0; i < 4; ++i) {
+        r.data[i][0] = m.data[0][i];
+        r.data[i][1] = m.data[1][i];
+        r.data[i][2] = m.data[2][i];
+        r.data[i][3] = m.data[3][i];
+    }
+    return r;
+#endif /* SPXM_SIMD */
+}
+
+SPXM_API float mat4_det(mat4 m)
+{
+#if defined(SPXM_SSE)
+    __m128 t[4], k[6], d = spxm_sse_mat4_cofactors(&m, t, k);
+    return _mm_cvtss_f32(SPXM_F4_SPLAT(d, 2));
+#else
+    float d;
+    spxm_mat4_inverse(NULL, &m, &d);
+    return d;
+#endif /* SPXM_SSE */
+}
+
+/* The batch SIMD paths transpose 4 matrices so that every register holds
+the same element of 4 different matrices and run the scalar formulas lane
+by lane, results are identical to spxm_mat4_inverse. */
+
+#ifdef SPXM_SIMD
+
+static void spxm_f4_load_mat4(const mat4* m, spxm_f4* a)
+{
+    int i;
+    for (i = 0; i < 4; ++i) {
+        a[i * 4 + 0] = SPXM_F4_LOADU(m[0].data[i]);
+        a[i * 4 + 1] = SPXM_F4_LOADU(m[1].data[i]);
+        a[i * 4 + 2] = SPXM_F4_LOADU(m[2].data[i]);
+        a[i * 4 + 3] = SPXM_F4_LOADU(m[3].data[i]);
+        SPXM_F4_TRANSPOSE(a[i * 4 + 0], a[i * 4 + 1], a[i * 4 + 2], a[i * 4 + 3]);
+    }
+}
+
+static void spxm_f4_mat4_subdets(const spxm_f4* a, spxm_f4* s, spxm_f4* c)
+{
+    s[0] = SPXM_F4_SUB(SPXM_F4_MUL(a[0], a[5]), SPXM_F4_MUL(a[4], a[1]));
+    s[1] = SPXM_F4_SUB(SPXM_F4_MUL(a[0], a[6]), SPXM_F4_MUL(a[4], a[2]));
+    s[2] = SPXM_F4_SUB(SPXM_F4_MUL(a[0], a[7]), SPXM_F4_MUL(a[4], a[3]));
+    s[3] = SPXM_F4_SUB(SPXM_F4_MUL(a[1], a[6]), SPXM_F4_MUL(a[5], a[2]));
+    s[4] = SPXM_F4_SUB(SPXM_F4_MUL(a[1], a[7]), SPXM_F4_MUL(a[5], a[3]));
+    s[5] = SPXM_F4_SUB(SPXM_F4_MUL(a[2], a[7]), SPXM_F4_MUL(a[6], a[3]));
+    c[5] = SPXM_F4_SUB(SPXM_F4_MUL(a[10], a[15]), SPXM_F4_MUL(a[14], a[11]));
+    c[4] = SPXM_F4_SUB(SPXM_F4_MUL(a[9], a[15]), SPXM_F4_MUL(a[13], a[11]));
+    c[3] = SPXM_F4_SUB(SPXM_F4_MUL(a[9], a[14]), SPXM_F4_MUL(a[13], a[10]));
+    c[2] = SPXM_F4_SUB(SPXM_F4_MUL(a[8], a[15]), SPXM_F4_MUL(a[12], a[11]));
+    c[1] = SPXM_F4_SUB(SPXM_F4_MUL(a[8], a[14]), SPXM_F4_MUL(a[12], a[10]));
+    c[0] = SPXM_F4_SUB(SPXM_F4_MUL(a[8], a[13]), SPXM_F4_MUL(a[12], a[9]));
+}
+
+static spxm_f4 spxm_f4_mat4_det(const spxm_f4* s, const spxm_f4* c)
+{
+    spxm_f4 d;
+    d = SPXM_F4_SUB(SPXM_F4_MUL(s[0], c[5]), SPXM_F4_MUL(s[1], c[4]));
+    d = SPXM_F4_ADD(d, SPXM_F4_MUL(s[2], c[3]));
+    d = SPXM_F4_ADD(d, SPXM_F4_MUL(s[3], c[2]));
+    d = SPXM_F4_SUB(d, SPXM_F4_MUL(s[4], c[1]));
+    return SPXM_F4_ADD(d, SPXM_F4_MUL(s[5], c[0]));
+}
+
+/* (a * x - b * y + c * z) * d, negated when neg is the sign mask */
+
+static spxm_f4 spxm_f4_cofactor(spxm_f4 a, spxm_f4 x, spxm_f4 b, spxm_f4 y, spxm_f4 c, spxm_f4 z, spxm_f4 neg, spxm_f4 d)
+{
+    spxm_f4 r = SPXM_F4_SUB(SPXM_F4_MUL(a, x), SPXM_F4_MUL(b, y));
+    r = SPXM_F4_ADD(r, SPXM_F4_MUL(c, z));
+    return SPXM_F4_MUL(SPXM_F4_XOR(r, neg), d);
+}
+
+#endif /* SPXM_SIMD */
+
+SPXM_API void mat4_array_inverse(const mat4* in, mat4* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 a[16], r[16], s[6], c[6], d, zero = SPXM_F4_ZERO(), neg = SPXM_F4_SIGNMASK();
+        int j;
+        spxm_f4_load_mat4(in + i, a);
+        spxm_f4_mat4_subdets(a, s, c);
+        d = spxm_f4_mat4_det(s, c);
+        d = SPXM_F4_SELECT(SPXM_F4_CMPEQ(d, zero), zero, SPXM_F4_DIV(SPXM_F4_SET1(1.0F), d));
+
+        r[0] = spxm_f4_cofactor(a[5], c[5], a[6], c[4], a[7], c[3], zero, d);
+        r[1] = spxm_f4_cofactor(a[1], c[5], a[2], c[4], a[3], c[3], neg, d);
+        r[2] = spxm_f4_cofactor(a[13], s[5], a[14], s[4], a[15], s[3], zero, d);
+        r[3] = spxm_f4_cofactor(a[9], s[5], a[10], s[4], a[11], s[3], neg, d);
+        r[4] = spxm_f4_cofactor(a[4], c[5], a[6], c[2], a[7], c[1], neg, d);
+        r[5] = spxm_f4_cofactor(a[0], c[5], a[2], c[2], a[3], c[1], zero, d);
+        r[6] = spxm_f4_cofactor(a[12], s[5], a[14], s[2], a[15], s[1], neg, d);
+        r[7] = spxm_f4_cofactor(a[8], s[5], a[10], s[2], a[11], s[1], zero, d);
+        r[8] = spxm_f4_cofactor(a[4], c[4], a[5], c[2], a[7], c[0], zero, d);
+        r[9] = spxm_f4_cofactor(a[0], c[4], a[1], c[2], a[3], c[0], neg, d);
+        r[10] = spxm_f4_cofactor(a[12], s[4], a[13], s[2], a[15], s[0], zero, d);
+        r[11] = spxm_f4_cofactor(a[8], s[4], a[9], s[2], a[11], s[0], neg, d);
+        r[12] = spxm_f4_cofactor(a[4], c[3], a[5], c[1], a[6], c[0], neg, d);
+        r[13] = spxm_f4_cofactor(a[0], c[3], a[1], c[1], a[2], c[0], zero, d);
+        r[14] = spxm_f4_cofactor(a[12], s[3], a[13], s[1], a[14], s[0], neg, d);
+        r[15] = spxm_f4_cofactor(a[8], s[3], a[9], s[1], a[10], s[0], zero, d);
+
+        for (j = 0; j < 4; ++j) {
+            SPXM_F4_TRANSPOSE(r[j * 4 + 0], r[j * 4 + 1], r[j * 4 + 2], r[j * 4 + 3]);
+            SPXM_F4_STOREU(out[i + 0].data[j], r[j * 4 + 0]);
+            SPXM_F4_STOREU(out[i + 1].data[j], r[j * 4 + 1]);
+            SPXM_F4_STOREU(out[i + 2].data[j], r[j * 4 + 2]);
+            SPXM_F4_STOREU(out[i + 3].data[j], r[j * 4 + 3]);
+        }
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        spxm_mat4_inverse(out + i, in + i, NULL);
+    }
+}
+
+SPXM_API void mat4_array_transpose(const mat4* in, mat4* out, size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        out[i] = mat4_transpose(in[i]);
+    }
+}
+
+SPXM_API void mat4_array_det(const mat4* in, float* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 a[16], s[6], c[6];
+        spxm_f4_load_mat4(in + i, a);
+        spxm_f4_mat4_subdets(a, s, c);
+        SPXM_F4_STOREU(out + i, spxm_f4_mat4_det(s, c));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        spxm_mat4_inverse(NULL, in + i, out + i);
+    }
+}
+
+/* 3 x 4 affine matrix operations, data[row][col] with the translation in
+column 3, 48 bytes instead of 64 and one row per SIMD register */
+
+SPXM_API mat3x4 mat3x4_id(void)
+{
+    mat3x4 m = {{
+        {1.0F, 0.0F, 0.0F, 0.0F},
+        {0.0F, 1.0F, 0.0F, 0.0F},
+        {0.0F, 0.0F, 1.0F, 0.0F}
+    }};
+    return m;
+}
+
+SPXM_API mat3x4 mat3x4_from_mat4(mat4 m)
+{
+    mat3x4 r;
+    int i;
+    for (i = 0; i < 3; ++i) {
+        r.data[i][0] = m.data[0][i];
+        r.data[i][1] = m.data[1][i];
+        r.data[i][2] = m.data[2][i];
+        r.data[i][3] = m.data[3][i];
+    }
+    return r;
+}
+
+SPXM_API mat4 mat4_from_mat3x4(mat3x4 m)
+{
+    mat4 r;
+    int i;
+    for (i = 0; i < 4; ++i) {
+        r.data[i][0] = m.data[0][i];
+        r.data[i][1] = m.data[1][i];
+        r.data[i][2] = m.data[2][i];
+        r.data[i][3] = 0.0F;
+    }
+    r.data[3][3] = 1.0F;
+    return r;
+}
+
+SPXM_API mat3x4 mat3x4_mult(mat3x4 m1, mat3x4 m2)
+{
+    mat3x4 m;
+    mat3x4_mult_to(&m, &m1, &m2);
+    return m;
+}
+
+/* same product as mat4_mult_affine, out may point to m1 or m2 */
+
+SPXM_API void mat3x4_mult_to(mat3x4* out, const mat3x4* m1, const mat3x4* m2)
+{
+#if defined(SPXM_SIMD)
+    int i;
+    float t[3];
+    spxm_f4 r0, r1, r2, a, m;
+    r0 = SPXM_F4_LOADU(m2->data[0]);
+    r1 = SPXM_F4_LOADU(m2->data[1]);
+    r2 = SPXM_F4_LOADU(m2->data[2]);
+    for (i = 0; i < 3; ++i) {
+        a = SPXM_F4_LOADU(m1->data[i]);
+        t[i] = m1->data[i][3];
+        m = SPXM_F4_MUL(r0, SPXM_F4_SPLAT(a, 0));
+        m = SPXM_F4_ADD(m, SPXM_F4_MUL(r1, SPXM_F4_SPLAT(a, 1)));
+        m = SPXM_F4_ADD(m, SPXM_F4_MUL(r2, SPXM_F4_SPLAT(a, 2)));
+        SPXM_F4_STOREU(out->data[i], m);
+    }
+    out->data[0][3] += t[0];
+    out->data[1][3] += t[1];
+    out->data[2][3] += t[2];
+#else
+    int i;
+    mat3x4 m;
+    for (i = 0; i < 3; ++i) {
+        m.data[i][0] = m1->data[i][0] * m2->data[0][0] + m1->data[i][1] * m2->data[1][0] + m1->data[i][2] * m2->data[2][0];
+        m.data[i][1] = m1->data[i][0] * m2->data[0][1] + m1->data[i][1] * m2->data[1][1] + m1->data[i][2] * m2->data[2][1];
+        m.data[i][2] = m1->data[i][0] * m2->data[0][2] + m1->data[i][1] * m2->data[1][2] + m1->data[i][2] * m2->data[2][2];
+        m.data[i][3] = m1->data[i][0] * m2->data[0][3] + m1->data[i][1] * m2->data[1][3] + m1->data[i][2] * m2->data[2][3] + m1->data[i][3];
+    }
+    *out = m;
+#endif
+}
+
+SPXM_API mat3x4 mat3x4_inverse(mat3x4 m)
+{
+    return mat3x4_from_mat4(mat4_inverse_affine(mat4_from_mat3x4(m)));
+}
+
+SPXM_API vec3 vec3_mult_mat3x4_point(vec3 p, mat3x4 m)
+{
+    vec3 r;
+    r.x = m.data[0][0] * p.x + m.data[0][1] * p.y + m.data[0][2] * p.z + m.data[0][3];
+    r.y = m.data[1][0] * p.x + m.data[1][1] * p.y + m.data[1][2] * p.z + m.data[1][3];
+    r.z = m.data[2][0] * p.x + m.data[2][1] * p.y + m.data[2][2] * p.z + m.data[2][3];
+    return r;
+}
+
+SPXM_API vec3 vec3_mult_mat3x4_dir(vec3 p, mat3x4 m)
+{
+    vec3 r;
+    r.x = m.data[0][0] * p.x + m.data[0][1] * p.y + m.data[0][2] * p.z;
+    r.y = m.data[1][0] * p.x + m.data[1][1] * p.y + m.data[1][2] * p.z;
+    r.z = m.data[2][0] * p.x + m.data[2][1] * p.y + m.data[2][2] * p.z;
+    return r;
+}
+
+/* 3 x 2 affine matrix operations, data[col][row] like mat4 with the
+translation in column 2, 24 bytes for a sprite or 2D body transform */
+
+SPXM_API mat3x2 mat3x2_id(void)
+{
+    mat3x2 m = {{
+        {1.0F, 0.0F},
+        {0.0F, 1.0F},
+        {0.0F, 0.0F}
+    }};
+    return m;
+}
+
+/* scale, then counterclockwise rotation by rad, then translation, which is
+mat4_model about the z axis for uniform scales */
+
+SPXM_API mat3x2 mat3x2_model(vec2 translation, vec2 scale, float rad)
+{
+    mat3x2 m;
+    vec2 r = vec2_from_rad(rad);
+    m.data[0][0] = r.x * scale.x;
+    m.data[0][1] = r.y * scale.x;
+    m.data[1][0] = -r.y * scale.y;
+    m.data[1][1] = r.x * scale.y;
+    m.data[2][0] = translation.x;
+    m.data[2][1] = translation.y;
+    return m;
+}
+
+/* same product as mat4_mult, m2 is applied first */
+
+SPXM_API mat3x2 mat3x2_mult(mat3x2 m1, mat3x2 m2)
+{
+    mat3x2 m;
+    int i;
+    for (i = 0; i < 3; ++i) {
+        m.data[i][0] = m1.data[0][0] * m2.data[i][0] + m1.data[1][0] * m2.data[i][1];
+        m.data[i][1] = m1.data[0][1] * m2.data[i][0] + m1.data[1][1] * m2.data[i][1];
+    }
+    m.data[2][0] += m1.data[2][0];
+    m.data[2][1] += m1.data[2][1];
+    return m;
+}
+
+/* a singular matrix gives the zero matrix */
+
+SPXM_API mat3x2 mat3x2_inverse(mat3x2 m)
+{
+    mat3x2 r;
+    float det = m.data[0][0] * m.data[1][1] - m.data[1][0] * m.data[0][1];
+    det = SPXM_DIV(det);
+    r.data[0][0] = m.data[1][1] * det;
+    r.data[0][1] = -m.data[0][1] * det;
+    r.data[1][0] = -m.data[1][0] * det;
+    r.data[1][1] = m.data[0][0] * det;
+    r.data[2][0] = -(r.data[0][0] * m.data[2][0] + r.data[1][0] * m.data[2][1]);
+    r.data[2][1] = -(r.data[0][1] * m.data[2][0] + r.data[1][1] * m.data[2][1]);
+    return r;
+}
+
+SPXM_API mat4 mat4_from_mat3x2(mat3x2 m)
+{
+    mat4 r = mat4_id();
+    r.data[0][0] = m.data[0][0];
+    r.data[0][1] = m.data[0][1];
+    r.data[1][0] = m.data[1][0];
+    r.data[1][1] = m.data[1][1];
+    r.data[3][0] = m.data[2][0];
+    r.data[3][1] = m.data[2][1];
+    return r;
+}
+
+SPXM_API vec2 vec2_mult_mat3x2_point(vec2 p, mat3x2 m)
+{
+    vec2 r;
+    r.x = m.data[0][0] * p.x + m.data[1][0] * p.y + m.data[2][0];
+    r.y = m.data[0][1] * p.x + m.data[1][1] * p.y + m.data[2][1];
+    return r;
+}
+
+SPXM_API vec2 vec2_mult_mat3x2_dir(vec2 p, mat3x2 m)
+{
+    vec2 r;
+    r.x = m.data[0][0] * p.x + m.data[1][0] * p.y;
+    r.y = m.data[0][1] * p.x + m.data[1][1] * p.y;
+    return r;
+}
+
+/* in and out may be the same buffer */
+
+SPXM_API void vec2_array_mult_mat3x2_point(const mat3x2* m, const vec2* in, vec2* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    spxm_f4 a = SPXM_F4_SET1(m->data[0][0]), b = SPXM_F4_SET1(m->data[0][1]);
+    spxm_f4 c = SPXM_F4_SET1(m->data[1][0]), d = SPXM_F4_SET1(m->data[1][1]);
+    spxm_f4 tx = SPXM_F4_SET1(m->data[2][0]), ty = SPXM_F4_SET1(m->data[2][1]);
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y;
+        spxm_f4_load_vec2(&in[i].x, &x, &y);
+        spxm_f4_store_vec2(&out[i].x,
+            SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(a, x), SPXM_F4_MUL(c, y)), tx),
+            SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(b, x), SPXM_F4_MUL(d, y)), ty));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = vec2_mult_mat3x2_point(in[i], *m);
+    }
+}
+
+/* mat3x2_model of every element, the sines and cosines are computed four at
+a time and the matrices written one by one */
+
+SPXM_API void mat3x2_array_model(const vec2* translation, const vec2* scale, const float* rad, mat3x2* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        float t[6][4];
+        spxm_f4 s, c, sx, sy, tx, ty;
+        size_t j;
+        spxm_f4_sincosf(SPXM_F4_LOADU(rad + i), &s, &c);
+        spxm_f4_load_vec2(&scale[i].x, &sx, &sy);
+        spxm_f4_load_vec2(&translation[i].x, &tx, &ty);
+        SPXM_F4_STOREU(t[0], SPXM_F4_MUL(c, sx));
+        SPXM_F4_STOREU(t[1], SPXM_F4_MUL(s, sx));
+        SPXM_F4_STOREU(t[2], SPXM_F4_MUL(SPXM_F4_XOR(s, SPXM_F4_SIGNMASK()), sy));
+        SPXM_F4_STOREU(t[3], SPXM_F4_MUL(c, sy));
+        SPXM_F4_STOREU(t[4], tx);
+        SPXM_F4_STOREU(t[5], ty);
+        for (j = 0; j < 4; ++j) {
+            mat3x2* m = out + i + j;
+            m->data[0][0] = t[0][j];
+            m->data[0][1] = t[1][j];
+            m->data[1][0] = t[2][j];
+            m->data[1][1] = t[3][j];
+            m->data[2][0] = t[4][j];
+            m->data[2][1] = t[5][j];
+        }
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = mat3x2_model(translation[i], scale[i], rad[i]);
+    }
+}
+
+/* quaternion rotations, q = (x, y, z) sin(a / 2) + w cos(a / 2) */
+
+SPXM_API quat quat_id(void)
+{
+    quat q;
+    q.x = 0.0F;
+    q.y = 0.0F;
+    q.z = 0.0F;
+    q.w = 1.0F;
+    return q;
+}
+
+SPXM_API quat quat_new(float x, float y, float z, float w)
+{
+    quat q;
+    q.x = x;
+    q.y = y;
+    q.z = z;
+    q.w = w;
+    return q;
+}
+
+SPXM_API quat quat_from_axis_angle(vec3 axis, float rad)
+{
+    quat q;
+    float s;
+    SPXM_SINCOSF(rad * 0.5F, &s, &q.w);
+    axis = vec3_norm(axis);
+    q.x = axis.x * s;
+    q.y = axis.y * s;
+    q.z = axis.z * s;
+    return q;
+}
+
+/* rotation part of m, which must not contain scale or shear */
+
+SPXM_API quat quat_from_mat4(mat4 m)
+{
+    quat q;
+    float s, trace = m.data[0][0] + m.data[1][1] + m.data[2][2];
+    if (trace > 0.0F) {
+        s = 0.5F / sqrtf(trace + 1.0F);
+        q.w = 0.25F / s;
+        q.x = (m.data[1][2] - m.data[2][1]) * s;
+        q.y = (m.data[2][0] - m.data[0][2]) * s;
+        q.z = (m.data[0][1] - m.data[1][0]) * s;
+    } else if (m.data[0][0] > m.data[1][1] && m.data[0][0] > m.data[2][2]) {
+        s = 2.0F * sqrtf(1.0F + m.data[0][0] - m.data[1][1] - m.data[2][2]);
+        q.w = (m.data[1][2] - m.data[2][1]) / s;
+        q.x = 0.25F * s;
+        q.y = (m.data[1][0] + m.data[0][1]) / s;
+        q.z = (m.data[2][0] + m.data[0][2]) / s;
+    } else if (m.data[1][1] > m.data[2][2]) {
+        s = 2.0F * sqrtf(1.0F + m.data[1][1] - m.data[0][0] - m.data[2][2]);
+        q.w = (m.data[2][0] - m.data[0][2]) / s;
+        q.x = (m.data[1][0] + m.data[0][1]) / s;
+        q.y = 0.25F * s;
+        q.z = (m.data[2][1] + m.data[1][2]) / s;
+    } else {
+        s = 2.0F * sqrtf(1.0F + m.data[2][2] - m.data[0][0] - m.data[1][1]);
+        q.w = (m.data[0][1] - m.data[1][0]) / s;
+        q.x = (m.data[2][0] + m.data[0][2]) / s;
+        q.y = (m.data[2][1] + m.data[1][2]) / s;
+        q.z = 0.25F * s;
+    }
+    return q;
+}
+
+/* Hamilton product, the rotation q followed by the rotation p */
+
+SPXM_API quat quat_mult(quat p, quat q)
+{
+    quat r;
+    r.x = p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y;
+    r.y = p.w * q.y - p.x * q.z + p.y * q.w + p.z * q.x;
+    r.z = p.w * q.z + p.x * q.y - p.y * q.x + p.z * q.w;
+    r.w = p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z;
+    return r;
+}
+
+SPXM_API quat quat_conj(quat q)
+{
+    q.x = -q.x;
+    q.y = -q.y;
+    q.z = -q.z;
+    return q;
+}
+
+SPXM_API quat quat_norm(quat q)
+{
+    float n = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+    n = n == 0.0F ? 0.0F : SPXM_RSQRTF(n);
+    q.x *= n;
+    q.y *= n;
+    q.z *= n;
+    q.w *= n;
+    return q;
+}
+
+SPXM_API float quat_dot(quat p, quat q)
+{
+    return p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w;
+}
+
+/* both interpolations take the shortest path between p and q */
+
+SPXM_API quat quat_nlerp(quat p, quat q, float t)
+{
+    float s = quat_dot(p, q) < 0.0F ? -t : t;
+    p.x = p.x * (1.0F - t) + q.x * s;
+    p.y = p.y * (1.0F - t) + q.y * s;
+    p.z = p.z * (1.0F - t) + q.z * s;
+    p.w = p.w * (1.0F - t) + q.w * s;
+    return quat_norm(p);
+}
+
+SPXM_API quat quat_slerp(quat p, quat q, float t)
+{
+    float a, b, theta, s, d = quat_dot(p, q);
+    if (d > 0.9995F || d < -0.9995F) {
+        return quat_nlerp(p, q, t);
+    }
+
+    theta = acosf(absf(d));
+    s = 1.0F / sinf(theta);
+    a = sinf((1.0F - t) * theta) * s;
+    b = sinf(t * theta) * s;
+    b = d < 0.0F ? -b : b;
+
+    p.x = p.x * a + q.x * b;
+    p.y = p.y * a + q.y * b;
+    p.z = p.z * a + q.z * b;
+    p.w = p.w * a + q.w * b;
+    return p;
+}
+
+/* v + 2w (u x v) + 2u x (u x v) with u = (x, y, z), q must be normalized */
+
+SPXM_API vec3 quat_rotate_vec3(quat q, vec3 v)
+{
+    vec3 t, r;
+    t.x = 2.0F * (q.y * v.z - q.z * v.y);
+    t.y = 2.0F * (q.z * v.x - q.x * v.z);
+    t.z = 2.0F * (q.x * v.y - q.y * v.x);
+    r.x = v.x + q.w * t.x + (q.y * t.z - q.z * t.y);
+    r.y = v.y + q.w * t.y + (q.z * t.x - q.x * t.z);
+    r.z = v.z + q.w * t.z + (q.x * t.y - q.y * t.x);
+    return r;
+}
+
+/* same rotation as mat4_rot(mat4_id(), rad, axis) for q = quat_from_axis_angle(axis, rad) */
+
+SPXM_API mat4 quat_to_mat4(quat q)
+{
+    mat4 m;
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    m.data[0][0] = 1.0F - 2.0F * (yy + zz);
+    m.data[0][1] = 2.0F * (xy + wz);
+    m.data[0][2] = 2.0F * (xz - wy);
+    m.data[0][3] = 0.0F;
+    m.data[1][0] = 2.0F * (xy - wz);
+    m.data[1][1] = 1.0F - 2.0F * (xx + zz);
+    m.data[1][2] = 2.0F * (yz + wx);
+    m.data[1][3] = 0.0F;
+    m.data[2][0] = 2.0F * (xz + wy);
+    m.data[2][1] = 2.0F * (yz - wx);
+    m.data[2][2] = 1.0F - 2.0F * (xx + yy);
+    m.data[2][3] = 0.0F;
+    m.data[3][0] = 0.0F;
+    m.data[3][1] = 0.0F;
+    m.data[3][2] = 0.0F;
+    m.data[3][3] = 1.0F;
+    return m;
+}
+
+/* same matrix as mat4_model for rot = quat_from_axis_angle(rot_axis, rot_degs)
+without any trigonometry, the rotation is scaled along the parent axes */
+
+SPXM_API mat4 mat4_model_quat(vec3 translation, vec3 scale, quat rot)
+{
+    mat4 m = quat_to_mat4(rot);
+    int i;
+    for (i = 0; i < 3; ++i) {
+        m.data[i][0] *= scale.x;
+        m.data[i][1] *= scale.y;
+        m.data[i][2] *= scale.z;
+    }
+    m.data[3][0] = translation.x;
+    m.data[3][1] = translation.y;
+    m.data[3][2] = translation.z;
+    return m;
+}
+
+/* batch quaternion operations, the SIMD paths process 4 quaternions at a
+time transposed into one register per component, out may alias inputs */
+
+SPXM_API void quat_array_mult(const quat* p, const quat* q, quat* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 px, py, pz, pw, qx, qy, qz, qw, rx, ry, rz, rw;
+        spxm_f4_load_vec4(&p[i].x, &px, &py, &pz, &pw);
+        spxm_f4_load_vec4(&q[i].x, &qx, &qy, &qz, &qw);
+        rx = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(pw, qx), SPXM_F4_MUL(px, qw)), SPXM_F4_MUL(py, qz));
+        rx = SPXM_F4_SUB(rx, SPXM_F4_MUL(pz, qy));
+        ry = SPXM_F4_ADD(SPXM_F4_SUB(SPXM_F4_MUL(pw, qy), SPXM_F4_MUL(px, qz)), SPXM_F4_MUL(py, qw));
+        ry = SPXM_F4_ADD(ry, SPXM_F4_MUL(pz, qx));
+        rz = SPXM_F4_SUB(SPXM_F4_ADD(SPXM_F4_MUL(pw, qz), SPXM_F4_MUL(px, qy)), SPXM_F4_MUL(py, qx));
+        rz = SPXM_F4_ADD(rz, SPXM_F4_MUL(pz, qw));
+        rw = SPXM_F4_SUB(SPXM_F4_SUB(SPXM_F4_MUL(pw, qw), SPXM_F4_MUL(px, qx)), SPXM_F4_MUL(py, qy));
+        rw = SPXM_F4_SUB(rw, SPXM_F4_MUL(pz, qz));
+        spxm_f4_store_vec4(&out[i].x, rx, ry, rz, rw);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = quat_mult(p[i], q[i]);
+    }
+}
+
+#ifdef SPXM_SIMD
+
+static void spxm_f4_quat_norm(spxm_f4* x, spxm_f4* y, spxm_f4* z, spxm_f4* w)
+{
+    spxm_f4 n, zero = SPXM_F4_ZERO();
+    n = SPXM_F4_ADD(SPXM_F4_MUL(*x, *x), SPXM_F4_MUL(*y, *y));
+    n = SPXM_F4_ADD(SPXM_F4_ADD(n, SPXM_F4_MUL(*z, *z)), SPXM_F4_MUL(*w, *w));
+    n = SPXM_F4_SELECT(SPXM_F4_CMPEQ(n, zero), zero, SPXM_F4_RSQRT(n));
+    *x = SPXM_F4_MUL(*x, n);
+    *y = SPXM_F4_MUL(*y, n);
+    *z = SPXM_F4_MUL(*z, n);
+    *w = SPXM_F4_MUL(*w, n);
+}
+
+#endif /* SPXM_SIMD */
+
+SPXM_API void quat_array_nlerp(const quat* p, const quat* q, float t, quat* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    spxm_f4 a = SPXM_F4_SET1(1.0F - t), b = SPXM_F4_SET1(t);
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 px, py, pz, pw, qx, qy, qz, qw, d, s;
+        spxm_f4_load_vec4(&p[i].x, &px, &py, &pz, &pw);
+        spxm_f4_load_vec4(&q[i].x, &qx, &qy, &qz, &qw);
+        d = SPXM_F4_ADD(SPXM_F4_MUL(px, qx), SPXM_F4_MUL(py, qy));
+        d = SPXM_F4_ADD(SPXM_F4_ADD(d, SPXM_F4_MUL(pz, qz)), SPXM_F4_MUL(pw, qw));
+        s = SPXM_F4_XOR(b, SPXM_F4_AND(d, SPXM_F4_SIGNMASK()));
+        px = SPXM_F4_ADD(SPXM_F4_MUL(px, a), SPXM_F4_MUL(qx, s));
+        py = SPXM_F4_ADD(SPXM_F4_MUL(py, a), SPXM_F4_MUL(qy, s));
+        pz = SPXM_F4_ADD(SPXM_F4_MUL(pz, a), SPXM_F4_MUL(qz, s));
+        pw = SPXM_F4_ADD(SPXM_F4_MUL(pw, a), SPXM_F4_MUL(qw, s));
+        spxm_f4_quat_norm(&px, &py, &pz, &pw);
+        spxm_f4_store_vec4(&out[i].x, px, py, pz, pw);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = quat_nlerp(p[i], q[i], t);
+    }
+}
+
+/* the SIMD path evaluates acos with the Abramowitz and Stegun 4.4.46
+polynomial (error below 2e-8) and sin with the vectorized Cephes kernel.
+Like quat_slerp it normalizes only the nearly parallel lanes that fall back
+to quat_nlerp, so both agree within the error of the approximations. */
+
+SPXM_API void quat_array_slerp(const quat* p, const quat* q, float t, quat* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    spxm_f4 ta = SPXM_F4_SET1(1.0F - t), tb = SPXM_F4_SET1(t), one = SPXM_F4_SET1(1.0F);
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 px, py, pz, pw, qx, qy, qz, qw, d, sign, ad, theta, a, b, s, c, sa, sb;
+        spxm_f4 nx, ny, nz, nw;
+        spxm_m4 linear;
+        spxm_f4_load_vec4(&p[i].x, &px, &py, &pz, &pw);
+        spxm_f4_load_vec4(&q[i].x, &qx, &qy, &qz, &qw);
+        d = SPXM_F4_ADD(SPXM_F4_MUL(px, qx), SPXM_F4_MUL(py, qy));
+        d = SPXM_F4_ADD(SPXM_F4_ADD(d, SPXM_F4_MUL(pz, qz)), SPXM_F4_MUL(pw, qw));
+        sign = SPXM_F4_AND(d, SPXM_F4_SIGNMASK());
+        ad = SPXM_F4_MIN(SPXM_F4_ABS(d), one);
+        linear = SPXM_F4_CMPGT(ad, SPXM_F4_SET1(0.9995F));
+
+        theta = SPXM_F4_SET1(-0.0012624911F);
+        theta = SPXM_F4_ADD(SPXM_F4_MUL(theta, ad), SPXM_F4_SET1(0.0066700901F));
+        theta = SPXM_F4_ADD(SPXM_F4_MUL(theta, ad), SPXM_F4_SET1(-0.0170881256F));
+        theta = SPXM_F4_ADD(SPXM_F4_MUL(theta, ad), SPXM_F4_SET1(0.0308918810F));
+        theta = SPXM_F4_ADD(SPXM_F4_MUL(theta, ad), SPXM_F4_SET1(-0.0501743046F));
+        theta = SPXM_F4_ADD(SPXM_F4_MUL(theta, ad), SPXM_F4_SET1(0.0889789874F));
+        theta = SPXM_F4_ADD(SPXM_F4_MUL(theta, ad), SPXM_F4_SET1(-0.2145988016F));
+        theta = SPXM_F4_ADD(SPXM_F4_MUL(theta, ad), SPXM_F4_SET1(1.5707963050F));
+        theta = SPXM_F4_MUL(theta, SPXM_F4_SQRT(SPXM_F4_SUB(one, ad)));
+
+        spxm_f4_sincos(theta, &s, &c);
+        s = SPXM_F4_SELECT(linear, one, s);
+        spxm_f4_sincos(SPXM_F4_MUL(ta, theta), &sa, &c);
+        spxm_f4_sincos(SPXM_F4_MUL(tb, theta), &sb, &c);
+        a = SPXM_F4_DIV(sa, s);
+        b = SPXM_F4_DIV(sb, s);
+
+        a = SPXM_F4_SELECT(linear, ta, a);
+        b = SPXM_F4_XOR(SPXM_F4_SELECT(linear, tb, b), sign);
+
+        px = SPXM_F4_ADD(SPXM_F4_MUL(px, a), SPXM_F4_MUL(qx, b));
+        py = SPXM_F4_ADD(SPXM_F4_MUL(py, a), SPXM_F4_MUL(qy, b));
+        pz = SPXM_F4_ADD(SPXM_F4_MUL(pz, a), SPXM_F4_MUL(qz, b));
+        pw = SPXM_F4_ADD(SPXM_F4_MUL(pw, a), SPXM_F4_MUL(qw, b));
+        nx = px;
+        ny = py;
+        nz = pz;
+        nw = pw;
+        spxm_f4_quat_norm(&nx, &ny, &nz, &nw);
+        px = SPXM_F4_SELECT(linear, nx, px);
+        py = SPXM_F4_SELECT(linear, ny, py);
+        pz = SPXM_F4_SELECT(linear, nz, pz);
+        pw = SPXM_F4_SELECT(linear, nw, pw);
+        spxm_f4_store_vec4(&out[i].x, px, py, pz, pw);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = quat_slerp(p[i], q[i], t);
+    }
+}
+
+SPXM_API void quat_array_rotate_vec3(const quat* q, const vec3* in, vec3* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 qx, qy, qz, qw, vx, vy, vz, tx, ty, tz, two = SPXM_F4_SET1(2.0F);
+        spxm_f4_load_vec4(&q[i].x, &qx, &qy, &qz, &qw);
+        spxm_f4_load_vec3(&in[i].x, &vx, &vy, &vz);
+        tx = SPXM_F4_MUL(two, SPXM_F4_SUB(SPXM_F4_MUL(qy, vz), SPXM_F4_MUL(qz, vy)));
+        ty = SPXM_F4_MUL(two, SPXM_F4_SUB(SPXM_F4_MUL(qz, vx), SPXM_F4_MUL(qx, vz)));
+        tz = SPXM_F4_MUL(two, SPXM_F4_SUB(SPXM_F4_MUL(qx, vy), SPXM_F4_MUL(qy, vx)));
+        vx = SPXM_F4_ADD(SPXM_F4_ADD(vx, SPXM_F4_MUL(qw, tx)), SPXM_F4_SUB(SPXM_F4_MUL(qy, tz), SPXM_F4_MUL(qz, ty)));
+        vy = SPXM_F4_ADD(SPXM_F4_ADD(vy, SPXM_F4_MUL(qw, ty)), SPXM_F4_SUB(SPXM_F4_MUL(qz, tx), SPXM_F4_MUL(qx, tz)));
+        vz = SPXM_F4_ADD(SPXM_F4_ADD(vz, SPXM_F4_MUL(qw, tz)), SPXM_F4_SUB(SPXM_F4_MUL(qx, ty), SPXM_F4_MUL(qy, tx)));
+        spxm_f4_store_vec3(&out[i].x, vx, vy, vz);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = quat_rotate_vec3(q[i], in[i]);
+    }
+}
+
+SPXM_API void quat_array_to_mat4(const quat* q, mat4* out, size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        out[i] = quat_to_mat4(q[i]);
+    }
+}
+
+/* padded vec3a storage, conversions from and to packed vec3 arrays write 0 to
+the padding, the transforms leave it unspecified */
+
+SPXM_API vec3a vec3a_new(float x, float y, float z)
+{
+    vec3a p;
+    p.x = x;
+    p.y = y;
+    p.z = z;
+    p.pad = 0.0F;
+    return p;
+}
+
+SPXM_API vec3a vec3a_from_vec3(vec3 p)
+{
+    return vec3a_new(p.x, p.y, p.z);
+}
+
+SPXM_API vec3 vec3_from_vec3a(vec3a p)
+{
+    vec3 q;
+    q.x = p.x;
+    q.y = p.y;
+    q.z = p.z;
+    return q;
+}
+
+SPXM_API void vec3a_array_from_vec3(const vec3* in, vec3a* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, z;
+        spxm_f4_load_vec3(&in[i].x, &x, &y, &z);
+        spxm_f4_store_vec4(&out[i].x, x, y, z, SPXM_F4_ZERO());
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = vec3a_from_vec3(in[i]);
+    }
+}
+
+SPXM_API void vec3_array_from_vec3a(const vec3a* in, vec3* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, z, w;
+        spxm_f4_load_vec4(&in[i].x, &x, &y, &z, &w);
+        spxm_f4_store_vec3(&out[i].x, x, y, z);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = vec3_from_vec3a(in[i]);
+    }
+}
+
+/* same results as vec3_array_mult_mat4_point and _dir, with one full
+register load and store per vector, in and out may be the same buffer */
+
+SPXM_API void vec3a_array_mult_mat4_point(const mat4* m, const vec3a* in, vec3a* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    spxm_f4 m0, m1, m2, m3, v, r;
+    m0 = SPXM_F4_LOADU(m->data[0]);
+    m1 = SPXM_F4_LOADU(m->data[1]);
+    m2 = SPXM_F4_LOADU(m->data[2]);
+    m3 = SPXM_F4_LOADU(m->data[3]);
+    for (; i < count; ++i) {
+        v = SPXM_F4_LOADU(&in[i].x);
+        r = SPXM_F4_MUL(m0, SPXM_F4_SPLAT(v, 0));
+        r = SPXM_F4_ADD(r, SPXM_F4_MUL(m1, SPXM_F4_SPLAT(v, 1)));
+        r = SPXM_F4_ADD(r, SPXM_F4_MUL(m2, SPXM_F4_SPLAT(v, 2)));
+        SPXM_F4_STOREU(&out[i].x, SPXM_F4_ADD(r, m3));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        vec3a p = in[i];
+        out[i].x = p.x * m->data[0][0] + p.y * m->data[1][0] + p.z * m->data[2][0] + m->data[3][0];
+        out[i].y = p.x * m->data[0][1] + p.y * m->data[1][1] + p.z * m->data[2][1] + m->data[3][1];
+        out[i].z = p.x * m->data[0][2] + p.y * m->data[1][2] + p.z * m->data[2][2] + m->data[3][2];
+    }
+}
+
+SPXM_API void vec3a_array_mult_mat4_dir(const mat4* m, const vec3a* in, vec3a* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    spxm_f4 m0, m1, m2, v, r;
+    m0 = SPXM_F4_LOADU(m->data[0]);
+    m1 = SPXM_F4_LOADU(m->data[1]);
+    m2 = SPXM_F4_LOADU(m->data[2]);
+    for (; i < count; ++i) {
+        v = SPXM_F4_LOADU(&in[i].x);
+        r = SPXM_F4_MUL(m0, SPXM_F4_SPLAT(v, 0));
+        r = SPXM_F4_ADD(r, SPXM_F4_MUL(m1, SPXM_F4_SPLAT(v, 1)));
+        SPXM_F4_STOREU(&out[i].x, SPXM_F4_ADD(r, SPXM_F4_MUL(m2, SPXM_F4_SPLAT(v, 2))));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        vec3a p = in[i];
+        out[i].x = p.x * m->data[0][0] + p.y * m->data[1][0] + p.z * m->data[2][0];
+        out[i].y = p.x * m->data[0][1] + p.y * m->data[1][1] + p.z * m->data[2][1];
+        out[i].z = p.x * m->data[0][2] + p.y * m->data[1][2] + p.z * m->data[2][2];
+    }
+}
+
+/* convert betwen integer and float vector types */
+
+SPXM_API vec2 vec2_from_ivec2(ivec2 p)
+{
+    vec2 q;
+    q.x = (float)p.x;
+    q.y = (float)p.y;
+    return q;
+}
+
+SPXM_API vec3 vec3_from_ivec3(ivec3 p)
+{
+    vec3 q;
+    q.x = (float)p.x;
+    q.y = (float)p.y;
+    q.z = (float)p.z;
+    return q;
+}
+
+SPXM_API vec4 vec4_from_ivec4(ivec4 p)
+{
+    vec4 q;
+    q.x = (float)p.x;
+    q.y = (float)p.y;
+    q.z = (float)p.z;
+    q.w = (float)p.w;
+    return q;
+}
+
+SPXM_API ivec2 ivec2_from_vec2(vec2 p)
+{
+	ivec2 q;
+    q.x = (int)p.x;
+    q.y = (int)p.y;
+    return q;
+}
+
+SPXM_API ivec3 ivec3_from_vec3(vec3 p)
+{
+	ivec3 q;
+    q.x = (int)p.x;
+    q.y = (int)p.y;
+    q.z = (int)p.z;
+    return q;
+}
+
+SPXM_API ivec4 ivec4_from_vec4(vec4 p)
+{
+	ivec4 q;
+    q.x = (int)p.x;
+    q.y = (int)p.y;
+    q.z = (int)p.z;
+    q.w = (int)p.w;
+    return q;
+}
+
+/* values must fit an int, the round functions round halves to even like the
+SIMD conversions, not away from zero like roundf */
+
+static int spxm_floor_int(float n)
+{
+    int i = (int)n;
+    return i - (n < (float)i);
+}
+
+/* adding and subtracting 2^23 to the magnitude leaves no fraction bits,
+larger floats are already integers */
+
+static int spxm_round_int(float n)
+{
+    float r = n < 0.0F ? -n : n;
+    if (r < 8388608.0F) {
+        r = (r + 8388608.0F) - 8388608.0F;
+    }
+    return (int)(n < 0.0F ? -r : r);
+}
+
+SPXM_API ivec2 ivec2_from_vec2_floor(vec2 p)
+{
+    ivec2 q;
+    q.x = spxm_floor_int(p.x);
+    q.y = spxm_floor_int(p.y);
+    return q;
+}
+
+SPXM_API ivec2 ivec2_from_vec2_round(vec2 p)
+{
+    ivec2 q;
+    q.x = spxm_round_int(p.x);
+    q.y = spxm_round_int(p.y);
+    return q;
+}
+
+SPXM_API ivec3 ivec3_from_vec3_floor(vec3 p)
+{
+    ivec3 q;
+    q.x = spxm_floor_int(p.x);
+    q.y = spxm_floor_int(p.y);
+    q.z = spxm_floor_int(p.z);
+    return q;
+}
+
+SPXM_API ivec3 ivec3_from_vec3_round(vec3 p)
+{
+    ivec3 q;
+    q.x = spxm_round_int(p.x);
+    q.y = spxm_round_int(p.y);
+    q.z = spxm_round_int(p.z);
+    return q;
+}
+
+SPXM_API ivec4 ivec4_from_vec4_floor(vec4 p)
+{
+    ivec4 q;
+    q.x = spxm_floor_int(p.x);
+    q.y = spxm_floor_int(p.y);
+    q.z = spxm_floor_int(p.z);
+    q.w = spxm_floor_int(p.w);
+    return q;
+}
+
+SPXM_API ivec4 ivec4_from_vec4_round(vec4 p)
+{
+    ivec4 q;
+    q.x = spxm_round_int(p.x);
+    q.y = spxm_round_int(p.y);
+    q.z = spxm_round_int(p.z);
+    q.w = spxm_round_int(p.w);
+    return q;
+}
+
+/* batch conversions over the flat arrays of components, SPXM_ROUND_TRUNC
+matches the casts of ivec3_from_vec3 and the others the functions above */
+
+static void spxm_array_ftoi(const float* in, int* out, size_t count, int rounding)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x = SPXM_F4_LOADU(in + i);
+        spxm_i4 r;
+        if (rounding == SPXM_ROUND_FLOOR) {
+#if defined(SPXM_SSE) && defined(__SSE4_1__)
+            r = _mm_cvttps_epi32(_mm_floor_ps(x));
+#else
+            r = SPXM_F4_TO_I4(x);
+            r = SPXM_I4_ADD(r, SPXM_M4_AS_I4(SPXM_F4_CMPGT(SPXM_I4_TO_F4(r), x)));
+#endif
+        } else if (rounding == SPXM_ROUND_NEAREST) {
+            r = SPXM_F4_ROUND_I4(x);
+        } else {
+            r = SPXM_F4_TO_I4(x);
+        }
+        SPXM_I4_STOREU(out + i, r);
+    }
+#endif /* SPXM_SIMD */
+    if (rounding == SPXM_ROUND_FLOOR) {
+        for (; i < count; ++i) {
+            out[i] = spxm_floor_int(in[i]);
+        }
+    } else if (rounding == SPXM_ROUND_NEAREST) {
+        for (; i < count; ++i) {
+            out[i] = spxm_round_int(in[i]);
+        }
+    } else {
+        for (; i < count; ++i) {
+            out[i] = (int)in[i];
+        }
+    }
+}
+
+static void spxm_array_itof(const int* in, float* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out + i, SPXM_I4_TO_F4(SPXM_I4_LOADU(in + i)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = (float)in[i];
+    }
+}
+
+SPXM_API void ivec2_array_from_vec2(const vec2* in, ivec2* out, size_t count, int rounding)
+{
+    spxm_array_ftoi(&in->x, &out->x, count * 2, rounding);
+}
+
+SPXM_API void ivec3_array_from_vec3(const vec3* in, ivec3* out, size_t count, int rounding)
+{
+    spxm_array_ftoi(&in->x, &out->x, count * 3, rounding);
+}
+
+SPXM_API void ivec4_array_from_vec4(const vec4* in, ivec4* out, size_t count, int rounding)
+{
+    spxm_array_ftoi(&in->x, &out->x, count * 4, rounding);
+}
+
+SPXM_API void vec2_array_from_ivec2(const ivec2* in, vec2* out, size_t count)
+{
+    spxm_array_itof(&in->x, &out->x, count * 2);
+}
+
+SPXM_API void vec3_array_from_ivec3(const ivec3* in, vec3* out, size_t count)
+{
+    spxm_array_itof(&in->x, &out->x, count * 3);
+}
+
+SPXM_API void vec4_array_from_ivec4(const ivec4* in, vec4* out, size_t count)
+{
+    spxm_array_itof(&in->x, &out->x, count * 4);
+}
+
+/* integer vector arithmetic, overflow is undefined like for int */
+
+SPXM_API ivec2 ivec2_new(int x, int y)
+{
+    ivec2 p;
+    p.x = x;
+    p.y = y;
+    return p;
+}
+
+SPXM_API ivec2 ivec2_add(ivec2 p, ivec2 q)
+{
+    p.x += q.x;
+    p.y += q.y;
+    return p;
+}
+
+SPXM_API ivec2 ivec2_sub(ivec2 p, ivec2 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+    return p;
+}
+
+SPXM_API ivec2 ivec2_mult(ivec2 p, int n)
+{
+    p.x *= n;
+    p.y *= n;
+    return p;
+}
+
+SPXM_API ivec2 ivec2_prod(ivec2 p, ivec2 q)
+{
+    p.x *= q.x;
+    p.y *= q.y;
+    return p;
+}
+
+SPXM_API ivec2 ivec2_min(ivec2 p, ivec2 q)
+{
+    p.x = SPXM_MIN(p.x, q.x);
+    p.y = SPXM_MIN(p.y, q.y);
+    return p;
+}
+
+SPXM_API ivec2 ivec2_max(ivec2 p, ivec2 q)
+{
+    p.x = SPXM_MAX(p.x, q.x);
+    p.y = SPXM_MAX(p.y, q.y);
+    return p;
+}
+
+SPXM_API ivec2 ivec2_clamp(ivec2 p, ivec2 min, ivec2 max)
+{
+    p.x = SPXM_CLAMP(p.x, min.x, max.x);
+    p.y = SPXM_CLAMP(p.y, min.y, max.y);
+    return p;
+}
+
+SPXM_API int ivec2_dot(ivec2 p, ivec2 q)
+{
+    return p.x * q.x + p.y * q.y;
+}
+
+SPXM_API int ivec2_manhattan(ivec2 p, ivec2 q)
+{
+    return SPXM_ABS(p.x - q.x) + SPXM_ABS(p.y - q.y);
+}
+
+SPXM_API ivec3 ivec3_new(int x, int y, int z)
+{
+    ivec3 p;
+    p.x = x;
+    p.y = y;
+    p.z = z;
+    return p;
+}
+
+SPXM_API ivec3 ivec3_add(ivec3 p, ivec3 q)
+{
+    p.x += q.x;
+    p.y += q.y;
+    p.z += q.z;
+    return p;
+}
+
+SPXM_API ivec3 ivec3_sub(ivec3 p, ivec3 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+    p.z -= q.z;
+    return p;
+}
+
+SPXM_API ivec3 ivec3_mult(ivec3 p, int n)
+{
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    return p;
+}
+
+SPXM_API ivec3 ivec3_prod(ivec3 p, ivec3 q)
+{
+    p.x *= q.x;
+    p.y *= q.y;
+    p.z *= q.z;
+    return p;
+}
+
+SPXM_API ivec3 ivec3_min(ivec3 p, ivec3 q)
+{
+    p.x = SPXM_MIN(p.x, q.x);
+    p.y = SPXM_MIN(p.y, q.y);
+    p.z = SPXM_MIN(p.z, q.z);
+    return p;
+}
+
+SPXM_API ivec3 ivec3_max(ivec3 p, ivec3 q)
+{
+    p.x = SPXM_MAX(p.x, q.x);
+    p.y = SPXM_MAX(p.y, q.y);
+    p.z = SPXM_MAX(p.z, q.z);
+    return p;
+}
+
+SPXM_API ivec3 ivec3_clamp(ivec3 p, ivec3 min, ivec3 max)
+{
+    p.x = SPXM_CLAMP(p.x, min.x, max.x);
+    p.y = SPXM_CLAMP(p.y, min.y, max.y);
+    p.z = SPXM_CLAMP(p.z, min.z, max.z);
+    return p;
+}
+
+SPXM_API int ivec3_dot(ivec3 p, ivec3 q)
+{
+    return p.x * q.x + p.y * q.y + p.z * q.z;
+}
+
+SPXM_API int ivec3_manhattan(ivec3 p, ivec3 q)
+{
+    return SPXM_ABS(p.x - q.x) + SPXM_ABS(p.y - q.y) + SPXM_ABS(p.z - q.z);
+}
+
+SPXM_API ivec4 ivec4_new(int x, int y, int z, int w)
+{
+    ivec4 p;
+    p.x = x;
+    p.y = y;
+    p.z = z;
+    p.w = w;
+    return p;
+}
+
+SPXM_API ivec4 ivec4_add(ivec4 p, ivec4 q)
+{
+    p.x += q.x;
+    p.y += q.y;
+    p.z += q.z;
+    p.w += q.w;
+    return p;
+}
+
+SPXM_API ivec4 ivec4_sub(ivec4 p, ivec4 q)
+{
+    p.x -= q.x;
+    p.y -= q.y;
+    p.z -= q.z;
+    p.w -= q.w;
+    return p;
+}
+
+SPXM_API ivec4 ivec4_mult(ivec4 p, int n)
+{
+    p.x *= n;
+    p.y *= n;
+    p.z *= n;
+    p.w *= n;
+    return p;
+}
+
+SPXM_API ivec4 ivec4_prod(ivec4 p, ivec4 q)
+{
+    p.x *= q.x;
+    p.y *= q.y;
+    p.z *= q.z;
+    p.w *= q.w;
+    return p;
+}
+
+SPXM_API ivec4 ivec4_min(ivec4 p, ivec4 q)
+{
+    p.x = SPXM_MIN(p.x, q.x);
+    p.y = SPXM_MIN(p.y, q.y);
+    p.z = SPXM_MIN(p.z, q.z);
+    p.w = SPXM_MIN(p.w, q.w);
+    return p;
+}
+
+SPXM_API ivec4 ivec4_max(ivec4 p, ivec4 q)
+{
+    p.x = SPXM_MAX(p.x, q.x);
+    p.y = SPXM_MAX(p.y, q.y);
+    p.z = SPXM_MAX(p.z, q.z);
+    p.w = SPXM_MAX(p.w, q.w);
+    return p;
+}
+
+SPXM_API ivec4 ivec4_clamp(ivec4 p, ivec4 min, ivec4 max)
+{
+    p.x = SPXM_CLAMP(p.x, min.x, max.x);
+    p.y = SPXM_CLAMP(p.y, min.y, max.y);
+    p.z = SPXM_CLAMP(p.z, min.z, max.z);
+    p.w = SPXM_CLAMP(p.w, min.w, max.w);
+    return p;
+}
+
+SPXM_API int ivec4_dot(ivec4 p, ivec4 q)
+{
+    return p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w;
+}
+
+SPXM_API int ivec4_manhattan(ivec4 p, ivec4 q)
+{
+    return SPXM_ABS(p.x - q.x) + SPXM_ABS(p.y - q.y) + SPXM_ABS(p.z - q.z) + SPXM_ABS(p.w - q.w);
+}
+
+/* structure of arrays containers and bulk operations */
+
+static float* spxm_soa_alloc(size_t count, size_t arrays, size_t* stride, void** mem)
+{
+    size_t pad = (count + SPXM_SOA_WIDTH - 1) / SPXM_SOA_WIDTH * SPXM_SOA_WIDTH;
+    size_t size = pad * arrays * sizeof(float), i;
+    unsigned char* ptr;
+    float* data;
+
+    *stride = pad;
+    *mem = SPXM_MALLOC(size + SPXM_SOA_ALIGN);
+    if (!*mem) {
+        return NULL;
+    }
+
+    ptr = (unsigned char*)*mem;
+    ptr += SPXM_SOA_ALIGN - ((size_t)ptr & (SPXM_SOA_ALIGN - 1));
+    data = (float*)(void*)ptr;
+    for (i = 0; i < pad * arrays; ++i) {
+        data[i] = 0.0F;
+    }
+    return data;
+}
+
+SPXM_API vec3_soa vec3_soa_create(size_t count)
+{
+    vec3_soa soa;
+    size_t stride;
+    float* data = spxm_soa_alloc(count, 3, &stride, &soa.mem);
+    soa.x = data;
+    soa.y = data ? data + stride : NULL;
+    soa.z = data ? data + stride * 2 : NULL;
+    soa.count = data ? count : 0;
+    return soa;
+}
+
+SPXM_API void vec3_soa_free(vec3_soa* soa)
+{
+    if (soa->mem) {
+        SPXM_FREE(soa->mem);
+    }
+    soa->x = soa->y = soa->z = NULL;
+    soa->mem = NULL;
+    soa->count = 0;
+}
+
+SPXM_API void vec3_soa_from_vec3(vec3_soa* soa, const vec3* in)
+{
+    size_t i = 0, n = soa->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, z;
+        spxm_f4_load_vec3(&in[i].x, &x, &y, &z);
+        SPXM_F4_STOREU(soa->x + i, x);
+        SPXM_F4_STOREU(soa->y + i, y);
+        SPXM_F4_STOREU(soa->z + i, z);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        soa->x[i] = in[i].x;
+        soa->y[i] = in[i].y;
+        soa->z[i] = in[i].z;
+    }
+}
+
+SPXM_API void vec3_soa_to_vec3(const vec3_soa* soa, vec3* out)
+{
+    size_t i = 0, n = soa->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        spxm_f4_store_vec3(&out[i].x, SPXM_F4_LOADU(soa->x + i),
+            SPXM_F4_LOADU(soa->y + i), SPXM_F4_LOADU(soa->z + i));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out[i].x = soa->x[i];
+        out[i].y = soa->y[i];
+        out[i].z = soa->z[i];
+    }
+}
+
+SPXM_API void vec3_soa_add(vec3_soa* out, const vec3_soa* p, const vec3_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_ADD(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i)));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_ADD(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i)));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_ADD(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out->x[i] = p->x[i] + q->x[i];
+        out->y[i] = p->y[i] + q->y[i];
+        out->z[i] = p->z[i] + q->z[i];
+    }
+}
+
+SPXM_API void vec3_soa_sub(vec3_soa* out, const vec3_soa* p, const vec3_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_SUB(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i)));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_SUB(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i)));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_SUB(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out->x[i] = p->x[i] - q->x[i];
+        out->y[i] = p->y[i] - q->y[i];
+        out->z[i] = p->z[i] - q->z[i];
+    }
+}
+
+SPXM_API void vec3_soa_mult(vec3_soa* out, const vec3_soa* p, float n)
+{
+    size_t i = 0, count = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 f = SPXM_F4_SET1(n);
+    for (; i < (count & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->x + i), f));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->y + i), f));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->z + i), f));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out->x[i] = p->x[i] * n;
+        out->y[i] = p->y[i] * n;
+        out->z[i] = p->z[i] * n;
+    }
+}
+
+SPXM_API void vec3_soa_prod(vec3_soa* out, const vec3_soa* p, const vec3_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i)));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i)));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out->x[i] = p->x[i] * q->x[i];
+        out->y[i] = p->y[i] * q->y[i];
+        out->z[i] = p->z[i] * q->z[i];
+    }
+}
+
+SPXM_API void vec3_soa_lerp(vec3_soa* out, const vec3_soa* p, const vec3_soa* q, float t)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 f = SPXM_F4_SET1(t), a;
+    for (; i < (n & ~(size_t)3); i += 4) {
+        a = SPXM_F4_LOADU(p->x + i);
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_ADD(a, SPXM_F4_MUL(f, SPXM_F4_SUB(SPXM_F4_LOADU(q->x + i), a))));
+        a = SPXM_F4_LOADU(p->y + i);
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_ADD(a, SPXM_F4_MUL(f, SPXM_F4_SUB(SPXM_F4_LOADU(q->y + i), a))));
+        a = SPXM_F4_LOADU(p->z + i);
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_ADD(a, SPXM_F4_MUL(f, SPXM_F4_SUB(SPXM_F4_LOADU(q->z + i), a))));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out->x[i] = p->x[i] + t * (q->x[i] - p->x[i]);
+        out->y[i] = p->y[i] + t * (q->y[i] - p->y[i]);
+        out->z[i] = p->z[i] + t * (q->z[i] - p->z[i]);
+    }
+}
+
+SPXM_API void vec3_soa_norm(vec3_soa* out, const vec3_soa* p)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 x, y, z, m, zero = SPXM_F4_ZERO();
+    for (; i < (n & ~(size_t)3); i += 4) {
+        x = SPXM_F4_LOADU(p->x + i);
+        y = SPXM_F4_LOADU(p->y + i);
+        z = SPXM_F4_LOADU(p->z + i);
+        m = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(x, x), SPXM_F4_MUL(y, y)), SPXM_F4_MUL(z, z));
+        m = SPXM_F4_SELECT(SPXM_F4_CMPEQ(m, zero), zero, SPXM_F4_RSQRT(m));
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_MUL(x, m));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_MUL(y, m));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_MUL(z, m));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        float x = p->x[i], y = p->y[i], z = p->z[i];
+        float m = x * x + y * y + z * z;
+        m = m == 0.0F ? 0.0F : SPXM_RSQRTF(m);
+        out->x[i] = x * m;
+        out->y[i] = y * m;
+        out->z[i] = z * m;
+    }
+}
+
+SPXM_API void vec3_soa_cross(vec3_soa* out, const vec3_soa* p, const vec3_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 px, py, pz, qx, qy, qz;
+    for (; i < (n & ~(size_t)3); i += 4) {
+        px = SPXM_F4_LOADU(p->x + i);
+        py = SPXM_F4_LOADU(p->y + i);
+        pz = SPXM_F4_LOADU(p->z + i);
+        qx = SPXM_F4_LOADU(q->x + i);
+        qy = SPXM_F4_LOADU(q->y + i);
+        qz = SPXM_F4_LOADU(q->z + i);
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_SUB(SPXM_F4_MUL(py, qz), SPXM_F4_MUL(qy, pz)));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_SUB(SPXM_F4_MUL(pz, qx), SPXM_F4_MUL(qz, px)));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_SUB(SPXM_F4_MUL(px, qy), SPXM_F4_MUL(qx, py)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        float px = p->x[i], py = p->y[i], pz = p->z[i];
+        float qx = q->x[i], qy = q->y[i], qz = q->z[i];
+        out->x[i] = py * qz - qy * pz;
+        out->y[i] = pz * qx - qz * px;
+        out->z[i] = px * qy - qx * py;
+    }
+}
+
+SPXM_API void vec3_soa_dot(float* out, const vec3_soa* p, const vec3_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 d;
+    for (; i < (n & ~(size_t)3); i += 4) {
+        d = SPXM_F4_MUL(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i));
+        d = SPXM_F4_ADD(d, SPXM_F4_MUL(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i)));
+        d = SPXM_F4_ADD(d, SPXM_F4_MUL(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i)));
+        SPXM_F4_STOREU(out + i, d);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out[i] = p->x[i] * q->x[i] + p->y[i] * q->y[i] + p->z[i] * q->z[i];
+    }
+}
+
+SPXM_API void vec3_soa_sqmag(float* out, const vec3_soa* p)
+{
+    vec3_soa_dot(out, p, p);
+}
+
+SPXM_API void vec3_soa_dist(float* out, const vec3_soa* p, const vec3_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 x, y, z;
+    for (; i < (n & ~(size_t)3); i += 4) {
+        x = SPXM_F4_SUB(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i));
+        y = SPXM_F4_SUB(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i));
+        z = SPXM_F4_SUB(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i));
+        x = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(x, x), SPXM_F4_MUL(y, y)), SPXM_F4_MUL(z, z));
+        SPXM_F4_STOREU(out + i, SPXM_F4_SQRT(x));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        float x = p->x[i] - q->x[i], y = p->y[i] - q->y[i], z = p->z[i] - q->z[i];
+        out[i] = sqrtf(x * x + y * y + z * z);
+    }
+}
+
+/* out[i] = p[indices[i]] for the count of out, out and p must not overlap */
+
+SPXM_API void vec3_soa_permute(vec3_soa* out, const vec3_soa* p, const unsigned int* indices)
+{
+    size_t i;
+    for (i = 0; i < out->count; ++i) {
+        out->x[i] = p->x[indices[i]];
+        out->y[i] = p->y[indices[i]];
+        out->z[i] = p->z[indices[i]];
+    }
+}
+
+SPXM_API vec4_soa vec4_soa_create(size_t count)
+{
+    vec4_soa soa;
+    size_t stride;
+    float* data = spxm_soa_alloc(count, 4, &stride, &soa.mem);
+    soa.x = data;
+    soa.y = data ? data + stride : NULL;
+    soa.z = data ? data + stride * 2 : NULL;
+    soa.w = data ? data + stride * 3 : NULL;
+    soa.count = data ? count : 0;
+    return soa;
+}
+
+SPXM_API void vec4_soa_free(vec4_soa* soa)
+{
+    if (soa->mem) {
+        SPXM_FREE(soa->mem);
+    }
+    soa->x = soa->y = soa->z = soa->w = NULL;
+    soa->mem = NULL;
+    soa->count = 0;
+}
+
+SPXM_API void vec4_soa_from_vec4(vec4_soa* soa, const vec4* in)
+{
+    size_t i = 0, n = soa->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, z, w;
+        spxm_f4_load_vec4(&in[i].x, &x, &y, &z, &w);
+        SPXM_F4_STOREU(soa->x + i, x);
+        SPXM_F4_STOREU(soa->y + i, y);
+        SPXM_F4_STOREU(soa->z + i, z);
+        SPXM_F4_STOREU(soa->w + i, w);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        soa->x[i] = in[i].x;
+        soa->y[i] = in[i].y;
+        soa->z[i] = in[i].z;
+        soa->w[i] = in[i].w;
+    }
+}
+
+SPXM_API void vec4_soa_to_vec4(const vec4_soa* soa, vec4* out)
+{
+    size_t i = 0, n = soa->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        spxm_f4_store_vec4(&out[i].x, SPXM_F4_LOADU(soa->x + i), SPXM_F4_LOADU(soa->y + i),
+            SPXM_F4_LOADU(soa->z + i), SPXM_F4_LOADU(soa->w + i));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out[i].x = soa->x[i];
+        out[i].y = soa->y[i];
+        out[i].z = soa->z[i];
+        out[i].w = soa->w[i];
+    }
+}
+
+SPXM_API void vec4_soa_add(vec4_soa* out, const vec4_soa* p, const vec4_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_ADD(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i)));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_ADD(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i)));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_ADD(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i)));
+        SPXM_F4_STOREU(out->w + i, SPXM_F4_ADD(SPXM_F4_LOADU(p->w + i), SPXM_F4_LOADU(q->w + i)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out->x[i] = p->x[i] + q->x[i];
+        out->y[i] = p->y[i] + q->y[i];
+        out->z[i] = p->z[i] + q->z[i];
+        out->w[i] = p->w[i] + q->w[i];
+    }
+}
+
+SPXM_API void vec4_soa_sub(vec4_soa* out, const vec4_soa* p, const vec4_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_SUB(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i)));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_SUB(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i)));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_SUB(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i)));
+        SPXM_F4_STOREU(out->w + i, SPXM_F4_SUB(SPXM_F4_LOADU(p->w + i), SPXM_F4_LOADU(q->w + i)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out->x[i] = p->x[i] - q->x[i];
+        out->y[i] = p->y[i] - q->y[i];
+        out->z[i] = p->z[i] - q->z[i];
+        out->w[i] = p->w[i] - q->w[i];
+    }
+}
+
+SPXM_API void vec4_soa_mult(vec4_soa* out, const vec4_soa* p, float n)
+{
+    size_t i = 0, count = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 f = SPXM_F4_SET1(n);
+    for (; i < (count & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->x + i), f));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->y + i), f));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->z + i), f));
+        SPXM_F4_STOREU(out->w + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->w + i), f));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out->x[i] = p->x[i] * n;
+        out->y[i] = p->y[i] * n;
+        out->z[i] = p->z[i] * n;
+        out->w[i] = p->w[i] * n;
+    }
+}
+
+SPXM_API void vec4_soa_prod(vec4_soa* out, const vec4_soa* p, const vec4_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    for (; i < (n & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i)));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i)));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i)));
+        SPXM_F4_STOREU(out->w + i, SPXM_F4_MUL(SPXM_F4_LOADU(p->w + i), SPXM_F4_LOADU(q->w + i)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out->x[i] = p->x[i] * q->x[i];
+        out->y[i] = p->y[i] * q->y[i];
+        out->z[i] = p->z[i] * q->z[i];
+        out->w[i] = p->w[i] * q->w[i];
+    }
+}
+
+SPXM_API void vec4_soa_lerp(vec4_soa* out, const vec4_soa* p, const vec4_soa* q, float t)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 f = SPXM_F4_SET1(t), a;
+    for (; i < (n & ~(size_t)3); i += 4) {
+        a = SPXM_F4_LOADU(p->x + i);
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_ADD(a, SPXM_F4_MUL(f, SPXM_F4_SUB(SPXM_F4_LOADU(q->x + i), a))));
+        a = SPXM_F4_LOADU(p->y + i);
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_ADD(a, SPXM_F4_MUL(f, SPXM_F4_SUB(SPXM_F4_LOADU(q->y + i), a))));
+        a = SPXM_F4_LOADU(p->z + i);
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_ADD(a, SPXM_F4_MUL(f, SPXM_F4_SUB(SPXM_F4_LOADU(q->z + i), a))));
+        a = SPXM_F4_LOADU(p->w + i);
+        SPXM_F4_STOREU(out->w + i, SPXM_F4_ADD(a, SPXM_F4_MUL(f, SPXM_F4_SUB(SPXM_F4_LOADU(q->w + i), a))));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out->x[i] = p->x[i] + t * (q->x[i] - p->x[i]);
+        out->y[i] = p->y[i] + t * (q->y[i] - p->y[i]);
+        out->z[i] = p->z[i] + t * (q->z[i] - p->z[i]);
+        out->w[i] = p->w[i] + t * (q->w[i] - p->w[i]);
+    }
+}
+
+SPXM_API void vec4_soa_norm(vec4_soa* out, const vec4_soa* p)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 x, y, z, w, m, zero = SPXM_F4_ZERO();
+    for (; i < (n & ~(size_t)3); i += 4) {
+        x = SPXM_F4_LOADU(p->x + i);
+        y = SPXM_F4_LOADU(p->y + i);
+        z = SPXM_F4_LOADU(p->z + i);
+        w = SPXM_F4_LOADU(p->w + i);
+        m = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(x, x), SPXM_F4_MUL(y, y)), SPXM_F4_MUL(z, z));
+        m = SPXM_F4_ADD(m, SPXM_F4_MUL(w, w));
+        m = SPXM_F4_SELECT(SPXM_F4_CMPEQ(m, zero), zero, SPXM_F4_RSQRT(m));
+        SPXM_F4_STOREU(out->x + i, SPXM_F4_MUL(x, m));
+        SPXM_F4_STOREU(out->y + i, SPXM_F4_MUL(y, m));
+        SPXM_F4_STOREU(out->z + i, SPXM_F4_MUL(z, m));
+        SPXM_F4_STOREU(out->w + i, SPXM_F4_MUL(w, m));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        float x = p->x[i], y = p->y[i], z = p->z[i], w = p->w[i];
+        float m = x * x + y * y + z * z + w * w;
+        m = m == 0.0F ? 0.0F : SPXM_RSQRTF(m);
+        out->x[i] = x * m;
+        out->y[i] = y * m;
+        out->z[i] = z * m;
+        out->w[i] = w * m;
+    }
+}
+
+SPXM_API void vec4_soa_dot(float* out, const vec4_soa* p, const vec4_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 d;
+    for (; i < (n & ~(size_t)3); i += 4) {
+        d = SPXM_F4_MUL(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i));
+        d = SPXM_F4_ADD(d, SPXM_F4_MUL(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i)));
+        d = SPXM_F4_ADD(d, SPXM_F4_MUL(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i)));
+        d = SPXM_F4_ADD(d, SPXM_F4_MUL(SPXM_F4_LOADU(p->w + i), SPXM_F4_LOADU(q->w + i)));
+        SPXM_F4_STOREU(out + i, d);
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        out[i] = p->x[i] * q->x[i] + p->y[i] * q->y[i] + p->z[i] * q->z[i] + p->w[i] * q->w[i];
+    }
+}
+
+SPXM_API void vec4_soa_sqmag(float* out, const vec4_soa* p)
+{
+    vec4_soa_dot(out, p, p);
+}
+
+SPXM_API void vec4_soa_dist(float* out, const vec4_soa* p, const vec4_soa* q)
+{
+    size_t i = 0, n = p->count;
+#ifdef SPXM_SIMD
+    spxm_f4 x, y, z, w;
+    for (; i < (n & ~(size_t)3); i += 4) {
+        x = SPXM_F4_SUB(SPXM_F4_LOADU(p->x + i), SPXM_F4_LOADU(q->x + i));
+        y = SPXM_F4_SUB(SPXM_F4_LOADU(p->y + i), SPXM_F4_LOADU(q->y + i));
+        z = SPXM_F4_SUB(SPXM_F4_LOADU(p->z + i), SPXM_F4_LOADU(q->z + i));
+        w = SPXM_F4_SUB(SPXM_F4_LOADU(p->w + i), SPXM_F4_LOADU(q->w + i));
+        x = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(x, x), SPXM_F4_MUL(y, y)), SPXM_F4_MUL(z, z));
+        SPXM_F4_STOREU(out + i, SPXM_F4_SQRT(SPXM_F4_ADD(x, SPXM_F4_MUL(w, w))));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < n; ++i) {
+        float x = p->x[i] - q->x[i], y = p->y[i] - q->y[i];
+        float z = p->z[i] - q->z[i], w = p->w[i] - q->w[i];
+        out[i] = sqrtf(x * x + y * y + z * z + w * w);
+    }
+}
+
+SPXM_API void vec4_soa_permute(vec4_soa* out, const vec4_soa* p, const unsigned int* indices)
+{
+    size_t i;
+    for (i = 0; i < out->count; ++i) {
+        out->x[i] = p->x[indices[i]];
+        out->y[i] = p->y[indices[i]];
+        out->z[i] = p->z[indices[i]];
+        out->w[i] = p->w[indices[i]];
+    }
+}
+
+/* Planes are n . p + d = 0 with n pointing inside, so plane_dist is positive
+in front of the plane and the true distance once the plane is normalized */
+
+SPXM_API plane plane_new(vec3 n, float d)
+{
+    plane p;
+    p.n = n;
+    p.d = d;
+    return p;
+}
+
+SPXM_API plane plane_norm(plane p)
+{
+    float n = vec3_sqmag(p.n);
+    n = n == 0.0F ? 0.0F : SPXM_RSQRTF(n);
+    p.n = vec3_mult(p.n, n);
+    p.d *= n;
+    return p;
+}
+
+SPXM_API float plane_dist(plane p, vec3 q)
+{
+    return p.n.x * q.x + p.n.y * q.y + p.n.z * q.z + p.d;
+}
+
+/* Gribb-Hartmann extraction of the left, right, bottom, top, near and far
+planes from the rows of a projection or view projection matrix, with the
+-w <= z <= w clip space of mat4_perspective and mat4_ortho. The planes are
+normalized and in the space the matrix transforms from. */
+
+SPXM_API frustum frustum_from_mat4(mat4 m)
+{
+    frustum f;
+    int i;
+    for (i = 0; i < 3; ++i) {
+        f.planes[i * 2].n.x = m.data[0][3] + m.data[0][i];
+        f.planes[i * 2].n.y = m.data[1][3] + m.data[1][i];
+        f.planes[i * 2].n.z = m.data[2][3] + m.data[2][i];
+        f.planes[i * 2].d = m.data[3][3] + m.data[3][i];
+        f.planes[i * 2 + 1].n.x = m.data[0][3] - m.data[0][i];
+        f.planes[i * 2 + 1].n.y = m.data[1][3] - m.data[1][i];
+        f.planes[i * 2 + 1].n.z = m.data[2][3] - m.data[2][i];
+        f.planes[i * 2 + 1].d = m.data[3][3] - m.data[3][i];
+    }
+    for (i = 0; i < 6; ++i) {
+        f.planes[i] = plane_norm(f.planes[i]);
+    }
+    return f;
+}
+
+/* The tests are conservative, they return 1 for volumes inside or crossing
+the frustum and only 0 for volumes entirely behind one of its planes. */
+
+SPXM_API int frustum_test_sphere(const frustum* f, sphere s)
+{
+    int i;
+    for (i = 0; i < 6; ++i) {
+        if (plane_dist(f->planes[i], s.center) < -s.radius) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* center and half extent form of the closest corner test */
+
+SPXM_API int frustum_test_aabb(const frustum* f, aabb box)
+{
+    int i;
+    vec3 c, e;
+    c = vec3_mult(vec3_add(box.min, box.max), 0.5F);
+    e = vec3_mult(vec3_sub(box.max, box.min), 0.5F);
+    for (i = 0; i < 6; ++i) {
+        const plane* p = f->planes + i;
+        float r = absf(p->n.x) * e.x + absf(p->n.y) * e.y + absf(p->n.z) * e.z;
+        if (plane_dist(*p, c) < -r) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#ifdef SPXM_SIMD
+
+/* the frustum planes broadcast once per call as n.x, n.y, n.z, d followed
+by the absolute values of the normals */
+
+static void spxm_f4_frustum_splat(const frustum* f, spxm_f4* p)
+{
+    int k;
+    for (k = 0; k < 6; ++k, p += 7) {
+        p[0] = SPXM_F4_SET1(f->planes[k].n.x);
+        p[1] = SPXM_F4_SET1(f->planes[k].n.y);
+        p[2] = SPXM_F4_SET1(f->planes[k].n.z);
+        p[3] = SPXM_F4_SET1(f->planes[k].d);
+        p[4] = SPXM_F4_SET1(absf(f->planes[k].n.x));
+        p[5] = SPXM_F4_SET1(absf(f->planes[k].n.y));
+        p[6] = SPXM_F4_SET1(absf(f->planes[k].n.z));
+    }
+}
+
+/* plane_dist of 4 points, same order of operations */
+
+static spxm_f4 spxm_f4_plane_dist(const spxm_f4* p, spxm_f4 x, spxm_f4 y, spxm_f4 z)
+{
+    spxm_f4 d = SPXM_F4_ADD(SPXM_F4_MUL(p[0], x), SPXM_F4_MUL(p[1], y));
+    return SPXM_F4_ADD(SPXM_F4_ADD(d, SPXM_F4_MUL(p[2], z)), p[3]);
+}
+
+/* lanes of the boxes with center c and half extent e behind the plane */
+
+static spxm_m4 spxm_f4_aabb_outside(const spxm_f4* p, spxm_f4 cx, spxm_f4 cy, spxm_f4 cz,
+    spxm_f4 ex, spxm_f4 ey, spxm_f4 ez)
+{
+    spxm_f4 r = SPXM_F4_ADD(SPXM_F4_MUL(p[4], ex), SPXM_F4_MUL(p[5], ey));
+    r = SPXM_F4_ADD(r, SPXM_F4_MUL(p[6], ez));
+    return SPXM_F4_CMPLT(spxm_f4_plane_dist(p, cx, cy, cz), SPXM_F4_SUB(SPXM_F4_ZERO(), r));
+}
+
+#endif /* SPXM_SIMD */
+
+/* Batch tests of the elements in [begin, end), bit i % 32 of mask[i / 32] is
+set when element i passes. begin must be a multiple of 32 and every touched
+word is overwritten, so threads working on ranges split at multiples of 32
+never write the same word. Spheres hold the center in x, y, z and the radius
+in w. The results match the single tests exactly. */
+
+SPXM_API void frustum_test_spheres(const frustum* f, const vec4_soa* spheres, unsigned int* mask, size_t begin, size_t end)
+{
+    size_t i, j, n;
+    int k;
+#ifdef SPXM_SIMD
+    spxm_f4 planes[42];
+    size_t stop;
+    spxm_f4_frustum_splat(f, planes);
+#endif /* SPXM_SIMD */
+    for (i = begin; i < end; i = n) {
+        unsigned int bits = 0;
+        n = end - i < 32 ? end : i + 32;
+        j = i;
+#ifdef SPXM_SIMD
+        stop = i + ((n - i) & ~(size_t)3);
+        for (; j < stop; j += 4) {
+            spxm_f4 x = SPXM_F4_LOADU(spheres->x + j);
+            spxm_f4 y = SPXM_F4_LOADU(spheres->y + j);
+            spxm_f4 z = SPXM_F4_LOADU(spheres->z + j);
+            spxm_f4 r = SPXM_F4_SUB(SPXM_F4_ZERO(), SPXM_F4_LOADU(spheres->w + j));
+            spxm_m4 out = SPXM_F4_CMPLT(spxm_f4_plane_dist(planes, x, y, z), r);
+            for (k = 1; k < 6; ++k) {
+                out = SPXM_M4_OR(out, SPXM_F4_CMPLT(spxm_f4_plane_dist(planes + k * 7, x, y, z), r));
+            }
+            bits |= (unsigned int)(~SPXM_M4_MASK(out) & 0xf) << (j - i);
+        }
+#endif /* SPXM_SIMD */
+        for (; j < n; ++j) {
+            float x = spheres->x[j], y = spheres->y[j], z = spheres->z[j], r = -spheres->w[j];
+            unsigned int in = 1U;
+            for (k = 0; k < 6; ++k) {
+                const plane* p = f->planes + k;
+                in &= (unsigned int)!(p->n.x * x + p->n.y * y + p->n.z * z + p->d < r);
+            }
+            bits |= in << (j - i);
+        }
+        mask[i / 32] = bits;
+    }
+}
+
+SPXM_API void frustum_test_aabbs(const frustum* f, const vec3_soa* mins, const vec3_soa* maxs, unsigned int* mask, size_t begin, size_t end)
+{
+    size_t i, j, n;
+#ifdef SPXM_SIMD
+    spxm_f4 planes[42];
+    size_t stop;
+    int k;
+    spxm_f4_frustum_splat(f, planes);
+#endif /* SPXM_SIMD */
+    for (i = begin; i < end; i = n) {
+        unsigned int bits = 0;
+        n = end - i < 32 ? end : i + 32;
+        j = i;
+#ifdef SPXM_SIMD
+        stop = i + ((n - i) & ~(size_t)3);
+        for (; j < stop; j += 4) {
+            spxm_f4 half = SPXM_F4_SET1(0.5F);
+            spxm_f4 x0 = SPXM_F4_LOADU(mins->x + j), x1 = SPXM_F4_LOADU(maxs->x + j);
+            spxm_f4 y0 = SPXM_F4_LOADU(mins->y + j), y1 = SPXM_F4_LOADU(maxs->y + j);
+            spxm_f4 z0 = SPXM_F4_LOADU(mins->z + j), z1 = SPXM_F4_LOADU(maxs->z + j);
+            spxm_f4 cx = SPXM_F4_MUL(SPXM_F4_ADD(x0, x1), half), ex = SPXM_F4_MUL(SPXM_F4_SUB(x1, x0), half);
+            spxm_f4 cy = SPXM_F4_MUL(SPXM_F4_ADD(y0, y1), half), ey = SPXM_F4_MUL(SPXM_F4_SUB(y1, y0), half);
+            spxm_f4 cz = SPXM_F4_MUL(SPXM_F4_ADD(z0, z1), half), ez = SPXM_F4_MUL(SPXM_F4_SUB(z1, z0), half);
+            spxm_m4 out = spxm_f4_aabb_outside(planes, cx, cy, cz, ex, ey, ez);
+            for (k = 1; k < 6; ++k) {
+                out = SPXM_M4_OR(out, spxm_f4_aabb_outside(planes + k * 7, cx, cy, cz, ex, ey, ez));
+            }
+            bits |= (unsigned int)(~SPXM_M4_MASK(out) & 0xf) << (j - i);
+        }
+#endif /* SPXM_SIMD */
+        for (; j < n; ++j) {
+            aabb box;
+            box.min = vec3_new(mins->x[j], mins->y[j], mins->z[j]);
+            box.max = vec3_new(maxs->x[j], maxs->y[j], maxs->z[j]);
+            bits |= (unsigned int)frustum_test_aabb(f, box) << (j - i);
+        }
+        mask[i / 32] = bits;
+    }
+}
+
+/* Transform hierarchies keep every node in flat arrays with parents before
+their children, parent[i] < i or -1 for roots. The local transform of a node
+is its translation, rotation and scale, and its world matrix is the world
+matrix of its parent times mat4_model_quat of the local transform. Setting a
+node marks it dirty, and the updates only recompute the world matrices of
+dirty nodes and of their descendants. All arrays share one allocation. */
+
+SPXM_API transform_hierarchy transform_hierarchy_create(size_t count)
+{
+    transform_hierarchy h;
+    size_t i, size = count * (sizeof(mat4) + sizeof(quat) + sizeof(vec3) * 2 + sizeof(int) + 1);
+    unsigned char* ptr;
+
+    h.mem = SPXM_MALLOC(size + SPXM_SOA_ALIGN);
+    if (!h.mem) {
+        h.world = NULL;
+        h.rotation = NULL;
+        h.translation = h.scale = NULL;
+        h.parent = NULL;
+        h.dirty = NULL;
+        h.count = 0;
+        return h;
+    }
+
+    ptr = (unsigned char*)h.mem;
+    ptr += SPXM_SOA_ALIGN - ((size_t)ptr & (SPXM_SOA_ALIGN - 1));
+    h.world = (mat4*)(void*)ptr;
+    h.rotation = (quat*)(void*)(h.world + count);
+    h.translation = (vec3*)(void*)(h.rotation + count);
+    h.scale = h.translation + count;
+    h.parent = (int*)(void*)(h.scale + count);
+    h.dirty = (unsigned char*)(h.parent + count);
+    h.count = count;
+
+    for (i = 0; i < count; ++i) {
+        h.world[i] = mat4_id();
+        h.rotation[i] = quat_id();
+        h.translation[i] = vec3_new(0.0F, 0.0F, 0.0F);
+        h.scale[i] = vec3_new(1.0F, 1.0F, 1.0F);
+        h.parent[i] = -1;
+        h.dirty[i] = 0;
+    }
+    return h;
+}
+
+SPXM_API void transform_hierarchy_free(transform_hierarchy* h)
+{
+    if (h->mem) {
+        SPXM_FREE(h->mem);
+    }
+    h->world = NULL;
+    h->rotation = NULL;
+    h->translation = h->scale = NULL;
+    h->parent = NULL;
+    h->dirty = NULL;
+    h->mem = NULL;
+    h->count = 0;
+}
+
+/* the arrays can also be written directly as long as dirty[i] is set to 1 */
+
+SPXM_API void transform_hierarchy_set(transform_hierarchy* h, size_t i, vec3 translation, quat rotation, vec3 scale)
+{
+    h->translation[i] = translation;
+    h->rotation[i] = rotation;
+    h->scale[i] = scale;
+    h->dirty[i] = 1;
+}
+
+/* parent must be lower than i, or -1 to make i a root */
+
+SPXM_API void transform_hierarchy_set_parent(transform_hierarchy* h, size_t i, int parent)
+{
+    h->parent[i] = parent;
+    h->dirty[i] = 1;
+}
+
+SPXM_API void transform_hierarchy_update(transform_hierarchy* h)
+{
+    transform_hierarchy_update_range(h, 0, h->count);
+    transform_hierarchy_clean(h);
+}
+
+/* Updates the nodes in [begin, end) and marks the descendants of dirty nodes
+dirty, without clearing any flag so nodes in later ranges still see their
+changed parents. The parent of every node in the range must be in the range
+or in a range updated before, so separate subtrees below an updated top of
+the hierarchy can be updated in parallel. transform_hierarchy_clean clears
+the flags once every range is done. */
+
+SPXM_API void transform_hierarchy_update_range(transform_hierarchy* h, size_t begin, size_t end)
+{
+    size_t i;
+    for (i = begin; i < end; ++i) {
+        int p = h->parent[i];
+        mat4 local;
+        if (p >= 0) {
+            h->dirty[i] |= h->dirty[p];
+        }
+        if (!h->dirty[i]) {
+            continue;
+        }
+
+        local = mat4_model_quat(h->translation[i], h->scale[i], h->rotation[i]);
+        if (p >= 0) {
+            mat4_mult_affine_to(h->world + i, h->world + p, &local);
+        } else {
+            h->world[i] = local;
+        }
+    }
+}
+
+SPXM_API void transform_hierarchy_clean(transform_hierarchy* h)
+{
+    size_t i;
+    for (i = 0; i < h->count; ++i) {
+        h->dirty[i] = 0;
+    }
+}
+
+/* Ray casting, points along a ray are origin + t * dir and the direction does
+not need to be normalized. Every test reports the nearest hit with t in
+[0, tmax] and leaves t untouched on a miss, so passing the current closest t
+as tmax finds the closest hit among many primitives. */
+
+SPXM_API ray ray_new(vec3 origin, vec3 dir)
+{
+    ray r;
+    r.origin = origin;
+    r.dir = dir;
+    return r;
+}
+
+SPXM_API vec3 ray_at(ray r, float t)
+{
+    return vec3_add(r.origin, vec3_mult(r.dir, t));
+}
+
+/* narrows [tn, tf] to the distances between two slab planes, a NaN distance
+leaves the interval as is */
+
+#define SPXM_SLAB(t0, t1, tn, tf) do { \
+    float spxm_lo = (t0) < (t1) ? (t0) : (t1), spxm_hi = (t0) > (t1) ? (t0) : (t1); \
+    (tn) = spxm_lo > (tn) ? spxm_lo : (tn); \
+    (tf) = spxm_hi < (tf) ? spxm_hi : (tf); \
+} while (0)
+
+/* Slab test, t is the entry distance or 0 from inside the box. An axis with
+a zero direction component and the origin on one of its slab planes makes a
+NaN distance, which is ignored. */
+
+SPXM_API int ray_aabb(ray r, aabb box, float tmax, float* t)
+{
+    float t0, t1, tn = 0.0F, tf = tmax, inv;
+
+    inv = 1.0F / r.dir.x;
+    t0 = (box.min.x - r.origin.x) * inv;
+    t1 = (box.max.x - r.origin.x) * inv;
+    SPXM_SLAB(t0, t1, tn, tf);
+    inv = 1.0F / r.dir.y;
+    t0 = (box.min.y - r.origin.y) * inv;
+    t1 = (box.max.y - r.origin.y) * inv;
+    SPXM_SLAB(t0, t1, tn, tf);
+    inv = 1.0F / r.dir.z;
+    t0 = (box.min.z - r.origin.z) * inv;
+    t1 = (box.max.z - r.origin.z) * inv;
+    SPXM_SLAB(t0, t1, tn, tf);
+
+    if (tn <= tf) {
+        *t = tn;
+        return 1;
+    }
+    return 0;
+}
+
+/* the far root when the origin is inside the sphere */
+
+SPXM_API int ray_sphere(ray r, sphere s, float tmax, float* t)
+{
+    vec3 oc = vec3_sub(r.origin, s.center);
+    float a = vec3_dot(r.dir, r.dir);
+    float b = vec3_dot(oc, r.dir);
+    float c = vec3_dot(oc, oc) - s.radius * s.radius;
+    float disc = b * b - a * c, sq, d;
+
+    if (disc >= 0.0F) {
+        sq = sqrtf(disc);
+        d = (-b - sq) / a;
+        if (!(d >= 0.0F)) {
+            d = (-b + sq) / a;
+        }
+        if (d >= 0.0F && d <= tmax) {
+            *t = d;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Moller-Trumbore, both faces of the triangle are hit and uv receives the
+barycentric coordinates of b and c when it is not NULL. Rays parallel to the
+triangle have a zero determinant, which makes u infinite or NaN so the
+bounds checks reject them without a branch. */
+
+SPXM_API int ray_triangle(ray r, triangle tri, float tmax, float* t, vec2* uv)
+{
+    vec3 e1 = vec3_sub(tri.b, tri.a), e2 = vec3_sub(tri.c, tri.a);
+    vec3 p = vec3_cross(r.dir, e2), s, q;
+    float det = vec3_dot(e1, p), inv, u, v, d;
+
+    inv = 1.0F / det;
+    s = vec3_sub(r.origin, tri.a);
+    u = vec3_dot(s, p) * inv;
+    q = vec3_cross(s, e1);
+    v = vec3_dot(r.dir, q) * inv;
+    d = vec3_dot(e2, q) * inv;
+
+    if (u >= 0.0F && v >= 0.0F && u + v <= 1.0F && d >= 0.0F && d <= tmax) {
+        *t = d;
+        if (uv) {
+            uv->x = u;
+            uv->y = v;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/* Packets hold lane i of every component at index i. The packet tests return
+a mask with bit i set when ray i hits, and read tmax and write t, u and v per
+lane, tmax may point to t. The SIMD paths test 4 lanes at a time, ray8 as two
+halves, with the same results as the single ray tests on SSE and NEON. */
+
+SPXM_API ray4 ray4_from_rays(const ray* r)
+{
+    ray4 p;
+    int i;
+    for (i = 0; i < 4; ++i) {
+        p.ox[i] = r[i].origin.x;
+        p.oy[i] = r[i].origin.y;
+        p.oz[i] = r[i].origin.z;
+        p.dx[i] = r[i].dir.x;
+        p.dy[i] = r[i].dir.y;
+        p.dz[i] = r[i].dir.z;
+    }
+    return p;
+}
+
+SPXM_API ray8 ray8_from_rays(const ray* r)
+{
+    ray8 p;
+    int i;
+    for (i = 0; i < 8; ++i) {
+        p.ox[i] = r[i].origin.x;
+        p.oy[i] = r[i].origin.y;
+        p.oz[i] = r[i].origin.z;
+        p.dx[i] = r[i].dir.x;
+        p.dy[i] = r[i].dir.y;
+        p.dz[i] = r[i].dir.z;
+    }
+    return p;
+}
+
+/* 4 lanes of a packet whose components are stride floats apart, 4 for ray4
+and 8 for ray8 */
+
+#ifdef SPXM_SIMD
+
+/* writes the lanes of value selected by mask to t, the other lanes of t are
+written back unchanged */
+
+static void spxm_f4_store_lanes(float* t, spxm_m4 mask, spxm_f4 value)
+{
+    SPXM_F4_STOREU(t, SPXM_F4_SELECT(mask, value, SPXM_F4_LOADU(t)));
+}
+
+/* SPXM_SLAB on 4 lanes. The SSE min and max return their second operand when
+either is NaN, exactly like the compares of SPXM_SLAB, while the NEON ones
+return NaN, so NEON compares and selects. */
+
+static void spxm_f4_slab(spxm_f4 t0, spxm_f4 t1, spxm_f4* tn, spxm_f4* tf)
+{
+#ifdef SPXM_SSE
+    *tn = SPXM_F4_MAX(SPXM_F4_MIN(t0, t1), *tn);
+    *tf = SPXM_F4_MIN(SPXM_F4_MAX(t0, t1), *tf);
+#else
+    spxm_f4 lo = SPXM_F4_SELECT(SPXM_F4_CMPLT(t0, t1), t0, t1);
+    spxm_f4 hi = SPXM_F4_SELECT(SPXM_F4_CMPGT(t0, t1), t0, t1);
+    *tn = SPXM_F4_SELECT(SPXM_F4_CMPGT(lo, *tn), lo, *tn);
+    *tf = SPXM_F4_SELECT(SPXM_F4_CMPLT(hi, *tf), hi, *tf);
+#endif
+}
+
+static int spxm_ray_aabb4(const float* r, size_t stride, aabb box, const float* tmax, float* t)
+{
+    spxm_f4 t0, t1, o, inv, one = SPXM_F4_SET1(1.0F);
+    spxm_f4 tn = SPXM_F4_ZERO(), tf = SPXM_F4_LOADU(tmax);
+    spxm_m4 hit;
+
+    o = SPXM_F4_LOADU(r);
+    inv = SPXM_F4_DIV(one, SPXM_F4_LOADU(r + stride * 3));
+    t0 = SPXM_F4_MUL(SPXM_F4_SUB(SPXM_F4_SET1(box.min.x), o), inv);
+    t1 = SPXM_F4_MUL(SPXM_F4_SUB(SPXM_F4_SET1(box.max.x), o), inv);
+    spxm_f4_slab(t0, t1, &tn, &tf);
+    o = SPXM_F4_LOADU(r + stride);
+    inv = SPXM_F4_DIV(one, SPXM_F4_LOADU(r + stride * 4));
+    t0 = SPXM_F4_MUL(SPXM_F4_SUB(SPXM_F4_SET1(box.min.y), o), inv);
+    t1 = SPXM_F4_MUL(SPXM_F4_SUB(SPXM_F4_SET1(box.max.y), o), inv);
+    spxm_f4_slab(t0, t1, &tn, &tf);
+    o = SPXM_F4_LOADU(r + stride * 2);
+    inv = SPXM_F4_DIV(one, SPXM_F4_LOADU(r + stride * 5));
+    t0 = SPXM_F4_MUL(SPXM_F4_SUB(SPXM_F4_SET1(box.min.z), o), inv);
+    t1 = SPXM_F4_MUL(SPXM_F4_SUB(SPXM_F4_SET1(box.max.z), o), inv);
+    spxm_f4_slab(t0, t1, &tn, &tf);
+
+    hit = SPXM_F4_CMPLE(tn, tf);
+    spxm_f4_store_lanes(t, hit, tn);
+    return SPXM_M4_MASK(hit);
+}
+
+static int spxm_ray_sphere4(const float* r, size_t stride, sphere s, const float* tmax, float* t)
+{
+    spxm_f4 ox, oy, oz, dx, dy, dz, a, b, c, disc, sq, d0, d1, zero = SPXM_F4_ZERO();
+    spxm_m4 hit;
+
+    ox = SPXM_F4_SUB(SPXM_F4_LOADU(r), SPXM_F4_SET1(s.center.x));
+    oy = SPXM_F4_SUB(SPXM_F4_LOADU(r + stride), SPXM_F4_SET1(s.center.y));
+    oz = SPXM_F4_SUB(SPXM_F4_LOADU(r + stride * 2), SPXM_F4_SET1(s.center.z));
+    dx = SPXM_F4_LOADU(r + stride * 3);
+    dy = SPXM_F4_LOADU(r + stride * 4);
+    dz = SPXM_F4_LOADU(r + stride * 5);
+
+    a = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(dx, dx), SPXM_F4_MUL(dy, dy)), SPXM_F4_MUL(dz, dz));
+    b = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(ox, dx), SPXM_F4_MUL(oy, dy)), SPXM_F4_MUL(oz, dz));
+    c = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(ox, ox), SPXM_F4_MUL(oy, oy)), SPXM_F4_MUL(oz, oz));
+    c = SPXM_F4_SUB(c, SPXM_F4_SET1(s.radius * s.radius));
+    disc = SPXM_F4_SUB(SPXM_F4_MUL(b, b), SPXM_F4_MUL(a, c));
+
+    sq = SPXM_F4_SQRT(SPXM_F4_MAX(disc, zero));
+    b = SPXM_F4_XOR(b, SPXM_F4_SIGNMASK());
+    d0 = SPXM_F4_DIV(SPXM_F4_SUB(b, sq), a);
+    d1 = SPXM_F4_DIV(SPXM_F4_ADD(b, sq), a);
+    d0 = SPXM_F4_SELECT(SPXM_F4_CMPGE(d0, zero), d0, d1);
+
+    hit = SPXM_M4_AND(SPXM_F4_CMPGE(disc, zero), SPXM_F4_CMPGE(d0, zero));
+    hit = SPXM_M4_AND(hit, SPXM_F4_CMPLE(d0, SPXM_F4_LOADU(tmax)));
+    spxm_f4_store_lanes(t, hit, d0);
+    return SPXM_M4_MASK(hit);
+}
+
+static int spxm_ray_triangle4(const float* r, size_t stride, triangle tri, const float* tmax, float* t, float* u, float* v)
+{
+    spxm_f4 e1x, e1y, e1z, e2x, e2y, e2z, dx, dy, dz, px, py, pz, sx, sy, sz, qx, qy, qz;
+    spxm_f4 det, inv, fu, fv, d, zero = SPXM_F4_ZERO();
+    spxm_m4 hit;
+
+    e1x = SPXM_F4_SET1(tri.b.x - tri.a.x);
+    e1y = SPXM_F4_SET1(tri.b.y - tri.a.y);
+    e1z = SPXM_F4_SET1(tri.b.z - tri.a.z);
+    e2x = SPXM_F4_SET1(tri.c.x - tri.a.x);
+    e2y = SPXM_F4_SET1(tri.c.y - tri.a.y);
+    e2z = SPXM_F4_SET1(tri.c.z - tri.a.z);
+    dx = SPXM_F4_LOADU(r + stride * 3);
+    dy = SPXM_F4_LOADU(r + stride * 4);
+    dz = SPXM_F4_LOADU(r + stride * 5);
+
+    px = SPXM_F4_SUB(SPXM_F4_MUL(dy, e2z), SPXM_F4_MUL(e2y, dz));
+    py = SPXM_F4_SUB(SPXM_F4_MUL(dz, e2x), SPXM_F4_MUL(e2z, dx));
+    pz = SPXM_F4_SUB(SPXM_F4_MUL(dx, e2y), SPXM_F4_MUL(e2x, dy));
+    det = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(e1x, px), SPXM_F4_MUL(e1y, py)), SPXM_F4_MUL(e1z, pz));
+    inv = SPXM_F4_DIV(SPXM_F4_SET1(1.0F), det);
+
+    sx = SPXM_F4_SUB(SPXM_F4_LOADU(r), SPXM_F4_SET1(tri.a.x));
+    sy = SPXM_F4_SUB(SPXM_F4_LOADU(r + stride), SPXM_F4_SET1(tri.a.y));
+    sz = SPXM_F4_SUB(SPXM_F4_LOADU(r + stride * 2), SPXM_F4_SET1(tri.a.z));
+    fu = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(sx, px), SPXM_F4_MUL(sy, py)), SPXM_F4_MUL(sz, pz));
+    fu = SPXM_F4_MUL(fu, inv);
+
+    qx = SPXM_F4_SUB(SPXM_F4_MUL(sy, e1z), SPXM_F4_MUL(e1y, sz));
+    qy = SPXM_F4_SUB(SPXM_F4_MUL(sz, e1x), SPXM_F4_MUL(e1z, sx));
+    qz = SPXM_F4_SUB(SPXM_F4_MUL(sx, e1y), SPXM_F4_MUL(e1x, sy));
+    fv = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(dx, qx), SPXM_F4_MUL(dy, qy)), SPXM_F4_MUL(dz, qz));
+    fv = SPXM_F4_MUL(fv, inv);
+    d = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(e2x, qx), SPXM_F4_MUL(e2y, qy)), SPXM_F4_MUL(e2z, qz));
+    d = SPXM_F4_MUL(d, inv);
+
+    hit = SPXM_M4_AND(SPXM_F4_CMPGE(fu, zero), SPXM_F4_CMPGE(fv, zero));
+    hit = SPXM_M4_AND(hit, SPXM_F4_CMPLE(SPXM_F4_ADD(fu, fv), SPXM_F4_SET1(1.0F)));
+    hit = SPXM_M4_AND(hit, SPXM_F4_CMPGE(d, zero));
+    hit = SPXM_M4_AND(hit, SPXM_F4_CMPLE(d, SPXM_F4_LOADU(tmax)));
+    spxm_f4_store_lanes(t, hit, d);
+    if (u) {
+        spxm_f4_store_lanes(u, hit, fu);
+    }
+    if (v) {
+        spxm_f4_store_lanes(v, hit, fv);
+    }
+    return SPXM_M4_MASK(hit);
+}
+
+#else
+
+static ray spxm_ray_lane(const float* r, size_t stride, int i)
+{
+    ray q;
+    q.origin = vec3_new(r[i], r[stride + i], r[stride * 2 + i]);
+    q.dir = vec3_new(r[stride * 3 + i], r[stride * 4 + i], r[stride * 5 + i]);
+    return q;
+}
+
+static int spxm_ray_aabb4(const float* r, size_t stride, aabb box, const float* tmax, float* t)
+{
+    int i, mask = 0;
+    for (i = 0; i < 4; ++i) {
+        mask |= ray_aabb(spxm_ray_lane(r, stride, i), box, tmax[i], t + i) << i;
+    }
+    return mask;
+}
+
+static int spxm_ray_sphere4(const float* r, size_t stride, sphere s, const float* tmax, float* t)
+{
+    int i, mask = 0;
+    for (i = 0; i < 4; ++i) {
+        mask |= ray_sphere(spxm_ray_lane(r, stride, i), s, tmax[i], t + i) << i;
+    }
+    return mask;
+}
+
+static int spxm_ray_triangle4(const float* r, size_t stride, triangle tri, const float* tmax, float* t, float* u, float* v)
+{
+    int i, mask = 0;
+    for (i = 0; i < 4; ++i) {
+        vec2 uv;
+        if (ray_triangle(spxm_ray_lane(r, stride, i), tri, tmax[i], t + i, &uv)) {
+            mask |= 1 << i;
+            if (u) {
+                u[i] = uv.x;
+            }
+            if (v) {
+                v[i] = uv.y;
+            }
+        }
+    }
+    return mask;
+}
+
+#endif /* SPXM_SIMD */
+
+SPXM_API int ray4_aabb(const ray4* r, aabb box, const float* tmax, float* t)
+{
+    return spxm_ray_aabb4(r->ox, 4, box, tmax, t);
+}
+
+SPXM_API int ray4_sphere(const ray4* r, sphere s, const float* tmax, float* t)
+{
+    return spxm_ray_sphere4(r->ox, 4, s, tmax, t);
+}
+
+SPXM_API int ray4_triangle(const ray4* r, triangle tri, const float* tmax, float* t, float* u, float* v)
+{
+    return spxm_ray_triangle4(r->ox, 4, tri, tmax, t, u, v);
+}
+
+SPXM_API int ray8_aabb(const ray8* r, aabb box, const float* tmax, float* t)
+{
+    int mask = spxm_ray_aabb4(r->ox, 8, box, tmax, t);
+    return mask | spxm_ray_aabb4(r->ox + 4, 8, box, tmax + 4, t + 4) << 4;
+}
+
+SPXM_API int ray8_sphere(const ray8* r, sphere s, const float* tmax, float* t)
+{
+    int mask = spxm_ray_sphere4(r->ox, 8, s, tmax, t);
+    return mask | spxm_ray_sphere4(r->ox + 4, 8, s, tmax + 4, t + 4) << 4;
+}
+
+SPXM_API int ray8_triangle(const ray8* r, triangle tri, const float* tmax, float* t, float* u, float* v)
+{
+    int mask = spxm_ray_triangle4(r->ox, 8, tri, tmax, t, u, v);
+    return mask | spxm_ray_triangle4(r->ox + 4, 8, tri, tmax + 4, t + 4, u ? u + 4 : NULL, v ? v + 4 : NULL) << 4;
+}
+
+/* Bounding volume hierarchies are binary trees of 32 byte nodes in one array
+with the root at 0. A leaf has count > 0 and holds indices[first] up to
+indices[first + count - 1], an inner node has count 0 and its children at
+first and first + 1, always after the node itself. Children start at even
+indices so both share a 64 byte cache line, which leaves node 1 unused.
+
+The builder bins the box centroids of a node into SPXM_BVH_BINS slots along
+each axis and splits at the bin boundary with the lowest surface area
+heuristic cost, or makes a leaf when that is cheaper and the node holds at
+most SPXM_BVH_LEAF_SIZE boxes. Below SPXM_BVH_MAX_DEPTH nodes are split at
+the median centroid instead.
+
+bvh_build_split builds the top of the tree until there are up to the given
+number of independent subtrees, each reserves its node range, and
+bvh_build_task builds one of them, so the tasks can run on separate threads.
+bvh_build does both on the calling thread. */
+
+#define SPXM_BVH_BINS 16
+#define SPXM_BVH_MAX_DEPTH 48
+#define SPXM_BVH_STACK 96
+#define SPXM_BVH_UNUSED 0xffffffffU
+
+static vec3 spxm_vec3_min(vec3 p, vec3 q)
+{
+    return vec3_new(p.x < q.x ? p.x : q.x, p.y < q.y ? p.y : q.y, p.z < q.z ? p.z : q.z);
+}
+
+static vec3 spxm_vec3_max(vec3 p, vec3 q)
+{
+    return vec3_new(p.x > q.x ? p.x : q.x, p.y > q.y ? p.y : q.y, p.z > q.z ? p.z : q.z);
+}
+
+SPXM_API aabb aabb_from_triangle(triangle tri)
+{
+    aabb box;
+    box.min = spxm_vec3_min(spxm_vec3_min(tri.a, tri.b), tri.c);
+    box.max = spxm_vec3_max(spxm_vec3_max(tri.a, tri.b), tri.c);
+    return box;
+}
+
+SPXM_API bvh bvh_create(size_t count)
+{
+    bvh b;
+    size_t nodes = count ? count * 2 : 1;
+    size_t size = nodes * sizeof(bvh_node) + (count + SPXM_BVH_MAX_TASKS * 3) * sizeof(unsigned int);
+    unsigned char* ptr;
+
+    b.node_count = 0;
+    b.task_count = 0;
+    b.mem = SPXM_MALLOC(size + SPXM_SOA_ALIGN);
+    if (!b.mem) {
+        b.nodes = NULL;
+        b.indices = b.tasks = NULL;
+        b.count = 0;
+        return b;
+    }
+
+    ptr = (unsigned char*)b.mem;
+    ptr += SPXM_SOA_ALIGN - ((size_t)ptr & (SPXM_SOA_ALIGN - 1));
+    b.nodes = (bvh_node*)(void*)ptr;
+    b.indices = (unsigned int*)(void*)(b.nodes + nodes);
+    b.tasks = b.indices + count;
+    b.count = count;
+    return b;
+}
+
+SPXM_API void bvh_free(bvh* b)
+{
+    if (b->mem) {
+        SPXM_FREE(b->mem);
+    }
+    b->nodes = NULL;
+    b->indices = b->tasks = NULL;
+    b->mem = NULL;
+    b->node_count = b->count = b->task_count = 0;
+}
+
+typedef struct spxm_bvh_bin {
+    vec3 min, max;
+    size_t count;
+} spxm_bvh_bin;
+
+static float spxm_bvh_area(vec3 min, vec3 max)
+{
+    vec3 d = vec3_sub(max, min);
+    return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+static float spxm_bvh_centroid(const aabb* box, int axis)
+{
+    return (&box->min.x)[axis] + (&box->max.x)[axis];
+}
+
+static int spxm_bvh_bin_index(float c, float min, float scale)
+{
+    int k = (int)((c - min) * scale);
+    return k < 0 ? 0 : k > SPXM_BVH_BINS - 1 ? SPXM_BVH_BINS - 1 : k;
+}
+
+/* in place selection of the median centroid along axis */
+
+static void spxm_bvh_select(unsigned int* idx, size_t count, const aabb* boxes, int axis)
+{
+    long lo = 0, hi = (long)count - 1, k = (long)count / 2;
+
+    while (lo < hi) {
+        float pivot = spxm_bvh_centroid(boxes + idx[k], axis);
+        long i = lo, j = hi;
+        do {
+            while (spxm_bvh_centroid(boxes + idx[i], axis) < pivot) {
+                ++i;
+            }
+            while (pivot < spxm_bvh_centroid(boxes + idx[j], axis)) {
+                --j;
+            }
+            if (i <= j) {
+                unsigned int tmp = idx[i];
+                idx[i++] = idx[j];
+                idx[j--] = tmp;
+            }
+        } while (i <= j);
+        if (j < k) {
+            lo = i;
+        }
+        if (k < i) {
+            hi = j;
+        }
+    }
+}
+
+/* Computes the bounds of a node that holds a range of indices and either
+leaves it a leaf and returns 0 or splits the range between two new nodes at
+child and child + 1 and returns 1. */
+
+static int spxm_bvh_split(bvh* b, const aabb* boxes, size_t node, size_t depth, size_t child)
+{
+    bvh_node* n = b->nodes + node;
+    unsigned int* idx = b->indices + n->first;
+    size_t i, count = n->count, mid = count;
+    vec3 min, max, cmin, cmax;
+    float best = -1.0F, split_min = 0.0F, split_scale = 0.0F;
+    int axis, split_axis = -1, split_bin = 0;
+
+    min = cmin = boxes[idx[0]].min;
+    max = cmax = boxes[idx[0]].max;
+    cmin = cmax = vec3_add(cmin, cmax);
+    for (i = 1; i < count; ++i) {
+        const aabb* box = boxes + idx[i];
+        vec3 c = vec3_add(box->min, box->max);
+        min = spxm_vec3_min(min, box->min);
+        max = spxm_vec3_max(max, box->max);
+        cmin = spxm_vec3_min(cmin, c);
+        cmax = spxm_vec3_max(cmax, c);
+    }
+    n->min = min;
+    n->max = max;
+    if (count <= 2) {
+        return 0;
+    }
+
+    if (depth < SPXM_BVH_MAX_DEPTH) {
+        spxm_bvh_bin bins[3][SPXM_BVH_BINS];
+        float lo[3], scale[3];
+        int k;
+
+        /* all three axes in one pass over the boxes */
+        for (axis = 0; axis < 3; ++axis) {
+            float extent = (&cmax.x)[axis] - (&cmin.x)[axis];
+            lo[axis] = (&cmin.x)[axis];
+            scale[axis] = extent > 0.0F ? (float)SPXM_BVH_BINS * 0.9999F / extent : 0.0F;
+            for (k = 0; k < SPXM_BVH_BINS; ++k) {
+                bins[axis][k].min = vec3_uni(1e30F);
+                bins[axis][k].max = vec3_uni(-1e30F);
+                bins[axis][k].count = 0;
+            }
+        }
+        for (i = 0; i < count; ++i) {
+            const aabb* box = boxes + idx[i];
+            vec3 c = vec3_add(box->min, box->max);
+            for (axis = 0; axis < 3; ++axis) {
+                spxm_bvh_bin* bin = bins[axis] + spxm_bvh_bin_index((&c.x)[axis], lo[axis], scale[axis]);
+                bin->min = spxm_vec3_min(bin->min, box->min);
+                bin->max = spxm_vec3_max(bin->max, box->max);
+                ++bin->count;
+            }
+        }
+
+        for (axis = 0; axis < 3; ++axis) {
+            float right[SPXM_BVH_BINS];
+            vec3 bmin, bmax;
+            size_t n_left, n_right;
+
+            if (scale[axis] == 0.0F) {
+                continue;
+            }
+            n_right = 0;
+            bmin = bmax = vec3_new(0.0F, 0.0F, 0.0F);
+            for (k = SPXM_BVH_BINS - 1; k > 0; --k) {
+                if (bins[axis][k].count) {
+                    bmin = n_right ? spxm_vec3_min(bmin, bins[axis][k].min) : bins[axis][k].min;
+                    bmax = n_right ? spxm_vec3_max(bmax, bins[axis][k].max) : bins[axis][k].max;
+                    n_right += bins[axis][k].count;
+                }
+                right[k] = spxm_bvh_area(bmin, bmax) * (float)n_right;
+            }
+            n_left = 0;
+            for (k = 0; k < SPXM_BVH_BINS - 1; ++k) {
+                if (bins[axis][k].count) {
+                    bmin = n_left ? spxm_vec3_min(bmin, bins[axis][k].min) : bins[axis][k].min;
+                    bmax = n_left ? spxm_vec3_max(bmax, bins[axis][k].max) : bins[axis][k].max;
+                    n_left += bins[axis][k].count;
+                }
+                if (n_left && n_left < count) {
+                    float cost = spxm_bvh_area(bmin, bmax) * (float)n_left + right[k + 1];
+                    if (split_axis < 0 || cost < best) {
+                        best = cost;
+                        split_axis = axis;
+                        split_bin = k;
+                        split_min = lo[axis];
+                        split_scale = scale[axis];
+                    }
+                }
+            }
+        }
+    }
+
+    /* one traversal step against intersecting every box of the node */
+    if (count <= SPXM_BVH_LEAF_SIZE && (split_axis < 0 || spxm_bvh_area(min, max) * (float)(count - 1) <= best)) {
+        return 0;
+    }
+
+    if (split_axis >= 0) {
+        size_t j = count;
+        i = 0;
+        while (i < j) {
+            if (spxm_bvh_bin_index(spxm_bvh_centroid(boxes + idx[i], split_axis), split_min, split_scale) <= split_bin) {
+                ++i;
+            } else {
+                unsigned int tmp = idx[i];
+                idx[i] = idx[--j];
+                idx[j] = tmp;
+            }
+        }
+        mid = i;
+    }
+    if (mid == 0 || mid == count) {
+        vec3 d = vec3_sub(cmax, cmin);
+        axis = d.x >= d.y && d.x >= d.z ? 0 : d.y >= d.z ? 1 : 2;
+        if ((&d.x)[axis] > 0.0F) {
+            spxm_bvh_select(idx, count, boxes, axis);
+        }
+        mid = count / 2;
+    }
+
+    b->nodes[child].first = n->first;
+    b->nodes[child].count = (unsigned int)mid;
+    b->nodes[child + 1].first = n->first + (unsigned int)mid;
+    b->nodes[child + 1].count = (unsigned int)(count - mid);
+    n->first = (unsigned int)child;
+    n->count = 0;
+    return 1;
+}
+
+SPXM_API void bvh_build(bvh* b, const aabb* boxes)
+{
+    if (bvh_build_split(b, boxes, 1)) {
+        bvh_build_task(b, boxes, 0);
+    }
+}
+
+/* Builds the tree down to up to tasks subtrees, at most SPXM_BVH_MAX_TASKS,
+by always splitting the largest one, and returns how many there are. */
+
+SPXM_API size_t bvh_build_split(bvh* b, const aabb* boxes, size_t tasks)
+{
+    unsigned int* task = b->tasks;
+    size_t i, next = 2, n = 0;
+
+    b->node_count = b->task_count = 0;
+    if (!b->count) {
+        return 0;
+    }
+    if (tasks < 1) {
+        tasks = 1;
+    } else if (tasks > SPXM_BVH_MAX_TASKS) {
+        tasks = SPXM_BVH_MAX_TASKS;
+    }
+
+    for (i = 0; i < b->count; ++i) {
+        b->indices[i] = (unsigned int)i;
+    }
+    b->nodes[0].first = 0;
+    b->nodes[0].count = (unsigned int)b->count;
+    b->nodes[1].first = SPXM_BVH_UNUSED;
+    b->nodes[1].count = 0;
+    task[0] = 0;
+    task[1] = 0;
+    n = 1;
+
+    /* split tasks until there are enough of them, finished leaves are
+    moved past the end of the list */
+    while (n < tasks) {
+        size_t largest = 0;
+        for (i = 1; i < n; ++i) {
+            if (b->nodes[task[i * 3]].count > b->nodes[task[largest * 3]].count) {
+                largest = i;
+            }
+        }
+        if (b->nodes[task[largest * 3]].count <= SPXM_BVH_LEAF_SIZE) {
+            break;
+        }
+        if (spxm_bvh_split(b, boxes, task[largest * 3], task[largest * 3 + 1], next)) {
+            task[n * 3] = (unsigned int)next + 1;
+            task[n * 3 + 1] = task[largest * 3 + 1] + 1;
+            task[largest * 3] = (unsigned int)next;
+            task[largest * 3 + 1] = task[n * 3 + 1];
+            next += 2;
+            ++n;
+        } else {
+            break;
+        }
+    }
+
+    for (i = 0; i < n; ++i) {
+        size_t j, count = b->nodes[task[i * 3]].count;
+        task[i * 3 + 2] = (unsigned int)next;
+        for (j = next; j < next + count * 2 - 2; ++j) {
+            b->nodes[j].first = SPXM_BVH_UNUSED;
+            b->nodes[j].count = 0;
+        }
+        next += count * 2 - 2;
+    }
+    b->node_count = next;
+    b->task_count = n;
+    return n;
+}
+
+/* builds the subtree of one task, tasks only write their own nodes and
+indices so different tasks of the same split can run concurrently */
+
+SPXM_API void bvh_build_task(bvh* b, const aabb* boxes, size_t task)
+{
+    size_t stack[SPXM_BVH_STACK * 2], top, next = b->tasks[task * 3 + 2];
+
+    stack[0] = b->tasks[task * 3];
+    stack[1] = b->tasks[task * 3 + 1];
+    top = 1;
+    while (top) {
+        size_t node, depth;
+        --top;
+        node = stack[top * 2];
+        depth = stack[top * 2 + 1];
+        while (spxm_bvh_split(b, boxes, node, depth, next)) {
+            /* the depths on the stack increase from the bottom and the
+            median splits past SPXM_BVH_MAX_DEPTH halve the nodes, so this
+            never goes deeper than SPXM_BVH_STACK */
+            stack[top * 2] = next + 1;
+            stack[top * 2 + 1] = ++depth;
+            ++top;
+            node = next;
+            next += 2;
+        }
+    }
+}
+
+/* Recomputes the bounds after the boxes moved without changing the tree,
+children come after their parents so one backwards pass is enough. The
+tree gets less efficient the more the boxes move relative to each other. */
+
+SPXM_API void bvh_refit(bvh* b, const aabb* boxes)
+{
+    size_t i = b->node_count;
+
+    while (i--) {
+        bvh_node* n = b->nodes + i;
+        if (n->count) {
+            const unsigned int* idx = b->indices + n->first;
+            unsigned int j;
+            n->min = boxes[idx[0]].min;
+            n->max = boxes[idx[0]].max;
+            for (j = 1; j < n->count; ++j) {
+                n->min = spxm_vec3_min(n->min, boxes[idx[j]].min);
+                n->max = spxm_vec3_max(n->max, boxes[idx[j]].max);
+            }
+        } else if (n->first != SPXM_BVH_UNUSED) {
+            const bvh_node* c = b->nodes + n->first;
+            n->min = spxm_vec3_min(c[0].min, c[1].min);
+            n->max = spxm_vec3_max(c[0].max, c[1].max);
+        }
+    }
+}
+
+static int spxm_bvh_overlap(vec3 min, vec3 max, const aabb* box)
+{
+    return min.x <= box->max.x && max.x >= box->min.x &&
+           min.y <= box->max.y && max.y >= box->min.y &&
+           min.z <= box->max.z && max.z >= box->min.z;
+}
+
+/* the same slab test as ray_aabb with the inverse direction computed once */
+
+static int spxm_bvh_slab(vec3 min, vec3 max, vec3 o, vec3 inv, float tmax, float* t)
+{
+    float t0, t1, tn = 0.0F, tf = tmax;
+
+    t0 = (min.x - o.x) * inv.x;
+    t1 = (max.x - o.x) * inv.x;
+    SPXM_SLAB(t0, t1, tn, tf);
+    t0 = (min.y - o.y) * inv.y;
+    t1 = (max.y - o.y) * inv.y;
+    SPXM_SLAB(t0, t1, tn, tf);
+    t0 = (min.z - o.z) * inv.z;
+    t1 = (max.z - o.z) * inv.z;
+    SPXM_SLAB(t0, t1, tn, tf);
+    *t = tn;
+    return tn <= tf;
+}
+
+/* The queries take the boxes the tree was built or refit with, return how
+many boxes they found and write the indices of the first max of them in no
+particular order. */
+
+SPXM_API size_t bvh_query_aabb(const bvh* b, const aabb* boxes, aabb box, unsigned int* out, size_t max)
+{
+    size_t stack[SPXM_BVH_STACK + 1], top = 0, found = 0;
+
+    if (b->node_count) {
+        stack[top++] = 0;
+    }
+    while (top) {
+        const bvh_node* n = b->nodes + stack[--top];
+        if (!spxm_bvh_overlap(n->min, n->max, &box)) {
+            continue;
+        }
+        if (n->count) {
+            unsigned int j;
+            for (j = n->first; j < n->first + n->count; ++j) {
+                unsigned int k = b->indices[j];
+                if (spxm_bvh_overlap(boxes[k].min, boxes[k].max, &box)) {
+                    if (found < max) {
+                        out[found] = k;
+                    }
+                    ++found;
+                }
+            }
+        } else {
+            stack[top++] = n->first + 1;
+            stack[top++] = n->first;
+        }
+    }
+    return found;
+}
+
+SPXM_API size_t bvh_query_ray(const bvh* b, const aabb* boxes, ray r, float tmax, unsigned int* out, size_t max)
+{
+    size_t stack[SPXM_BVH_STACK + 1], top = 0, found = 0;
+    vec3 inv = vec3_new(1.0F / r.dir.x, 1.0F / r.dir.y, 1.0F / r.dir.z);
+    float t;
+
+    if (b->node_count) {
+        stack[top++] = 0;
+    }
+    while (top) {
+        const bvh_node* n = b->nodes + stack[--top];
+        if (!spxm_bvh_slab(n->min, n->max, r.origin, inv, tmax, &t)) {
+            continue;
+        }
+        if (n->count) {
+            unsigned int j;
+            for (j = n->first; j < n->first + n->count; ++j) {
+                unsigned int k = b->indices[j];
+                if (spxm_bvh_slab(boxes[k].min, boxes[k].max, r.origin, inv, tmax, &t)) {
+                    if (found < max) {
+                        out[found] = k;
+                    }
+                    ++found;
+                }
+            }
+        } else {
+            stack[top++] = n->first + 1;
+            stack[top++] = n->first;
+        }
+    }
+    return found;
+}
+
+/* The closest hit with ray_triangle among the triangles the boxes were made
+from, writes its distance to t and its index to prim. Visits the nearer
+child first and skips nodes behind the closest hit so far. */
+
+SPXM_API int bvh_raycast_triangles(const bvh* b, const triangle* tris, ray r, float tmax, float* t, unsigned int* prim)
+{
+    size_t stack[SPXM_BVH_STACK], top = 0, node = 0;
+    float dist[SPXM_BVH_STACK], t0, t1;
+    vec3 inv = vec3_new(1.0F / r.dir.x, 1.0F / r.dir.y, 1.0F / r.dir.z);
+    int hit = 0;
+
+    if (!b->node_count || !spxm_bvh_slab(b->nodes->min, b->nodes->max, r.origin, inv, tmax, &t0)) {
+        return 0;
+    }
+    for (;;) {
+        const bvh_node* n = b->nodes + node;
+        if (n->count) {
+            unsigned int j;
+            for (j = n->first; j < n->first + n->count; ++j) {
+                unsigned int k = b->indices[j];
+                if (ray_triangle(r, tris[k], tmax, &t0, NULL)) {
+                    tmax = t0;
+                    *t = t0;
+                    *prim = k;
+                    hit = 1;
+                }
+            }
+        } else {
+            const bvh_node* c = b->nodes + n->first;
+            int h0 = spxm_bvh_slab(c[0].min, c[0].max, r.origin, inv, tmax, &t0);
+            int h1 = spxm_bvh_slab(c[1].min, c[1].max, r.origin, inv, tmax, &t1);
+            if (h0 && h1) {
+                int back = t1 < t0;
+                stack[top] = n->first + !back;
+                dist[top++] = back ? t0 : t1;
+                node = n->first + back;
+                continue;
+            }
+            if (h0 || h1) {
+                node = n->first + h1;
+                continue;
+            }
+        }
+        while (top && dist[top - 1] > tmax) {
+            --top;
+        }
+        if (!top) {
+            break;
+        }
+        node = stack[--top];
+    }
+    return hit;
+}
+
+/* Spatial hashes bucket points into cubic cells of cell_size and hash the
+integer cell coordinates with spxrand_hash into table_size buckets, a power
+of two, so only occupied cells cost memory. A build computes the bucket of
+every point with spatial_hash_keys_range, which can run on separate threads
+for separate ranges, and then spatial_hash_sort counting sorts the points by
+bucket into copies of their positions, with start[b] to start[b + 1] the
+range of bucket b and indices the original index of each sorted point.
+cell_size can be changed between builds. Different cells can share a
+bucket, which the queries filter out, so a table of about as many buckets as
+points works well. */
+
+SPXM_API spatial_hash spatial_hash_create(size_t capacity, size_t table_size, float cell_size)
+{
+    spatial_hash h;
+    size_t size, n = 1;
+    unsigned char* ptr;
+
+    while (n < table_size) {
+        n <<= 1;
+    }
+    size = (n + 1 + capacity * 2) * sizeof(unsigned int) + capacity * 3 * sizeof(float);
+    h.count = 0;
+    h.cell_size = cell_size;
+    h.mem = SPXM_MALLOC(size + SPXM_SOA_ALIGN);
+    if (!h.mem) {
+        h.start = h.keys = h.indices = NULL;
+        h.x = h.y = h.z = NULL;
+        h.capacity = h.table_size = 0;
+        return h;
+    }
+
+    ptr = (unsigned char*)h.mem;
+    ptr += SPXM_SOA_ALIGN - ((size_t)ptr & (SPXM_SOA_ALIGN - 1));
+    h.x = (float*)(void*)ptr;
+    h.y = h.x + capacity;
+    h.z = h.y + capacity;
+    h.start = (unsigned int*)(void*)(h.z + capacity);
+    h.keys = h.start + n + 1;
+    h.indices = h.keys + capacity;
+    h.capacity = capacity;
+    h.table_size = n;
+    for (n = 0; n <= h.table_size; ++n) {
+        h.start[n] = 0;
+    }
+    return h;
+}
+
+SPXM_API void spatial_hash_free(spatial_hash* h)
+{
+    if (h->mem) {
+        SPXM_FREE(h->mem);
+    }
+    h->start = h->keys = h->indices = NULL;
+    h->x = h->y = h->z = NULL;
+    h->mem = NULL;
+    h->count = h->capacity = h->table_size = 0;
+}
+
+SPXM_API ivec3 spatial_hash_cell(const spatial_hash* h, vec3 p)
+{
+    float inv = 1.0F / h->cell_size;
+    ivec3 c;
+    c.x = spxm_floor_int(p.x * inv);
+    c.y = spxm_floor_int(p.y * inv);
+    c.z = spxm_floor_int(p.z * inv);
+    return c;
+}
+
+/* z and y are hashed first so the queries hash each row of cells once, the
+low bits of spxrand_hash only depend on the low bits of its input so the
+high bits are folded into them before masking */
+
+static unsigned int spxm_spatial_hash_row(int y, int z)
+{
+    return spxrand_hash(spxrand_hash((unsigned int)z) ^ (unsigned int)y);
+}
+
+static unsigned int spxm_spatial_hash_mask(const spatial_hash* h, unsigned int row, int x)
+{
+    unsigned int n = spxrand_hash(row ^ (unsigned int)x);
+    return (n ^ n >> 15) & (unsigned int)(h->table_size - 1);
+}
+
+SPXM_API unsigned int spatial_hash_bucket(const spatial_hash* h, ivec3 cell)
+{
+    return spxm_spatial_hash_mask(h, spxm_spatial_hash_row(cell.y, cell.z), cell.x);
+}
+
+SPXM_API void spatial_hash_build(spatial_hash* h, const vec3_soa* points)
+{
+    spatial_hash_keys_range(h, points, 0, points->count);
+    spatial_hash_sort(h, points);
+}
+
+/* the points must fit in the capacity, positions are assumed to be finite
+and small enough for their cell coordinates to fit an int */
+
+SPXM_API void spatial_hash_keys_range(spatial_hash* h, const vec3_soa* points, size_t begin, size_t end)
+{
+    size_t i;
+    for (i = begin; i < end; ++i) {
+        h->keys[i] = spatial_hash_bucket(h, spatial_hash_cell(h, vec3_new(points->x[i], points->y[i], points->z[i])));
+    }
+}
+
+/* stable, the points of a bucket keep their original order */
+
+SPXM_API void spatial_hash_sort(spatial_hash* h, const vec3_soa* points)
+{
+    unsigned int* start = h->start;
+    size_t i, sum = 0;
+
+    for (i = 0; i <= h->table_size; ++i) {
+        start[i] = 0;
+    }
+    for (i = 0; i < points->count; ++i) {
+        ++start[h->keys[i]];
+    }
+    for (i = 0; i <= h->table_size; ++i) {
+        sum += start[i];
+        start[i] = (unsigned int)sum;
+    }
+    i = points->count;
+    while (i--) {
+        unsigned int j = --start[h->keys[i]];
+        h->indices[j] = (unsigned int)i;
+        h->x[j] = points->x[i];
+        h->y[j] = points->y[i];
+        h->z[j] = points->z[i];
+    }
+    h->count = points->count;
+}
+
+/* the squared distance of sorted point j when it is within r2 of p and
+lies in cell c, otherwise a negative number, inv is 1 / cell_size */
+
+static float spxm_spatial_hash_test(const spatial_hash* h, size_t j, vec3 p, float r2, ivec3 c, float inv)
+{
+    float x = h->x[j], y = h->y[j], z = h->z[j];
+    float d2 = (x - p.x) * (x - p.x) + (y - p.y) * (y - p.y) + (z - p.z) * (z - p.z);
+
+    if (d2 <= r2 && spxm_floor_int(x * inv) == c.x && spxm_floor_int(y * inv) == c.y && spxm_floor_int(z * inv) == c.z) {
+        return d2;
+    }
+    return -1.0F;
+}
+
+/* Returns how many points are within radius of p and writes the original
+indices of the first max of them. Visits every cell the sphere overlaps and
+falls back to testing all points when those are more than the buckets. */
+
+SPXM_API size_t spatial_hash_query_radius(const spatial_hash* h, vec3 p, float radius, unsigned int* out, size_t max)
+{
+    size_t j, found = 0;
+    float r2 = radius * radius, inv = 1.0F / h->cell_size;
+    vec3 r = vec3_uni(radius);
+    ivec3 lo = spatial_hash_cell(h, vec3_sub(p, r)), hi = spatial_hash_cell(h, vec3_add(p, r)), c;
+
+    if ((double)(hi.x - lo.x + 1) * (double)(hi.y - lo.y + 1) * (double)(hi.z - lo.z + 1) > (double)h->table_size) {
+        for (j = 0; j < h->count; ++j) {
+            float dx = h->x[j] - p.x, dy = h->y[j] - p.y, dz = h->z[j] - p.z;
+            if (dx * dx + dy * dy + dz * dz <= r2) {
+                if (found < max) {
+                    out[found] = h->indices[j];
+                }
+                ++found;
+            }
+        }
+        return found;
+    }
+
+    for (c.z = lo.z; c.z <= hi.z; ++c.z) {
+        for (c.y = lo.y; c.y <= hi.y; ++c.y) {
+            unsigned int row = spxm_spatial_hash_row(c.y, c.z);
+            for (c.x = lo.x; c.x <= hi.x; ++c.x) {
+                unsigned int b = spxm_spatial_hash_mask(h, row, c.x);
+                for (j = h->start[b]; j < h->start[b + 1]; ++j) {
+                    if (spxm_spatial_hash_test(h, j, p, r2, c, inv) >= 0.0F) {
+                        if (found < max) {
+                            out[found] = h->indices[j];
+                        }
+                        ++found;
+                    }
+                }
+            }
+        }
+    }
+    return found;
+}
+
+/* inserts into the k closest so far, sorted by distance */
+
+static size_t spxm_knn_insert(unsigned int* out, float* sqdist, size_t n, size_t k, unsigned int i, float d2)
+{
+    size_t j = n < k ? n++ : n - 1;
+    while (j > 0 && sqdist[j - 1] > d2) {
+        out[j] = out[j - 1];
+        sqdist[j] = sqdist[j - 1];
+        --j;
+    }
+    out[j] = i;
+    sqdist[j] = d2;
+    return n;
+}
+
+/* The up to k points closest to p within radius, sorted by distance with
+their squared distances in sqdist. Visits rings of cells around the cell of
+p until the k closest are known to be found, and tests all points instead
+once the rings grow past the number of buckets. */
+
+SPXM_API size_t spatial_hash_query_knn(const spatial_hash* h, vec3 p, size_t k, float radius, unsigned int* out, float* sqdist)
+{
+    size_t j, n = 0;
+    float r2 = radius * radius, inv = 1.0F / h->cell_size;
+    ivec3 center = spatial_hash_cell(h, p), c;
+    int ring, dx, dy, dz;
+
+    if (!k) {
+        return 0;
+    }
+    for (ring = 0;; ++ring) {
+        float reach = (float)ring * h->cell_size;
+        if ((double)(ring * 2 + 1) * (double)(ring * 2 + 1) * (double)(ring * 2 + 1) > (double)h->table_size) {
+            n = 0;
+            for (j = 0; j < h->count; ++j) {
+                float ex = h->x[j] - p.x, ey = h->y[j] - p.y, ez = h->z[j] - p.z;
+                float d2 = ex * ex + ey * ey + ez * ez;
+                if (d2 <= r2 && (n < k || d2 < sqdist[n - 1])) {
+                    n = spxm_knn_insert(out, sqdist, n, k, h->indices[j], d2);
+                }
+            }
+            return n;
+        }
+
+        for (dz = -ring; dz <= ring; ++dz) {
+            for (dy = -ring; dy <= ring; ++dy) {
+                int shell = dz == -ring || dz == ring || dy == -ring || dy == ring;
+                unsigned int row;
+                c.y = center.y + dy;
+                c.z = center.z + dz;
+                row = spxm_spatial_hash_row(c.y, c.z);
+                for (dx = -ring; dx <= ring; dx += shell || !ring ? 1 : ring * 2) {
+                    unsigned int b;
+                    c.x = center.x + dx;
+                    b = spxm_spatial_hash_mask(h, row, c.x);
+                    for (j = h->start[b]; j < h->start[b + 1]; ++j) {
+                        float d2 = spxm_spatial_hash_test(h, j, p, n < k ? r2 : sqdist[n - 1], c, inv);
+                        if (d2 >= 0.0F && (n < k || d2 < sqdist[n - 1])) {
+                            n = spxm_knn_insert(out, sqdist, n, k, h->indices[j], d2);
+                        }
+                    }
+                }
+            }
+        }
+
+        /* every point within reach of p lies in the rings visited so far */
+        if ((n == k && sqdist[n - 1] <= reach * reach) || reach >= radius || n == h->count) {
+            return n;
+        }
+    }
+}
+
+/* Morton codes interleave the bits of the coordinates, x in the lowest bit,
+so points close in the code order are close in space. 2D codes take the low
+16 bits of each coordinate and 3D codes the low 10 bits, with BMI2 bit
+deposit and extract when the target has them. */
+
+#ifdef SPXM_BMI2
+
+SPXM_API unsigned int morton2_encode(ivec2 p)
+{
+    return _pdep_u32((unsigned int)p.x, 0x55555555U) | _pdep_u32((unsigned int)p.y, 0xaaaaaaaaU);
+}
+
+SPXM_API ivec2 morton2_decode(unsigned int code)
+{
+    ivec2 p;
+    p.x = (int)_pext_u32(code, 0x55555555U);
+    p.y = (int)_pext_u32(code, 0xaaaaaaaaU);
+    return p;
+}
+
+SPXM_API unsigned int morton3_encode(ivec3 p)
+{
+    return _pdep_u32((unsigned int)p.x, 0x09249249U) | _pdep_u32((unsigned int)p.y, 0x12492492U) |
+           _pdep_u32((unsigned int)p.z, 0x24924924U);
+}
+
+SPXM_API ivec3 morton3_decode(unsigned int code)
+{
+    ivec3 p;
+    p.x = (int)_pext_u32(code, 0x09249249U);
+    p.y = (int)_pext_u32(code, 0x12492492U);
+    p.z = (int)_pext_u32(code, 0x24924924U);
+    return p;
+}
+
+#else
+
+static unsigned int spxm_morton_spread2(unsigned int n)
+{
+    n &= 0x0000ffffU;
+    n = (n | n << 8) & 0x00ff00ffU;
+    n = (n | n << 4) & 0x0f0f0f0fU;
+    n = (n | n << 2) & 0x33333333U;
+    return (n | n << 1) & 0x55555555U;
+}
+
+static unsigned int spxm_morton_compact2(unsigned int n)
+{
+    n &= 0x55555555U;
+    n = (n | n >> 1) & 0x33333333U;
+    n = (n | n >> 2) & 0x0f0f0f0fU;
+    n = (n | n >> 4) & 0x00ff00ffU;
+    return (n | n >> 8) & 0x0000ffffU;
+}
+
+static unsigned int spxm_morton_spread3(unsigned int n)
+{
+    n &= 0x000003ffU;
+    n = (n | n << 16) & 0x030000ffU;
+    n = (n | n << 8) & 0x0300f00fU;
+    n = (n | n << 4) & 0x030c30c3U;
+    return (n | n << 2) & 0x09249249U;
+}
+
+static unsigned int spxm_morton_compact3(unsigned int n)
+{
+    n &= 0x09249249U;
+    n = (n | n >> 2) & 0x030c30c3U;
+    n = (n | n >> 4) & 0x0300f00fU;
+    n = (n | n >> 8) & 0x030000ffU;
+    return (n | n >> 16) & 0x000003ffU;
+}
+
+SPXM_API unsigned int morton2_encode(ivec2 p)
+{
+    return spxm_morton_spread2((unsigned int)p.x) | spxm_morton_spread2((unsigned int)p.y) << 1;
+}
+
+SPXM_API ivec2 morton2_decode(unsigned int code)
+{
+    ivec2 p;
+    p.x = (int)spxm_morton_compact2(code);
+    p.y = (int)spxm_morton_compact2(code >> 1);
+    return p;
+}
+
+SPXM_API unsigned int morton3_encode(ivec3 p)
+{
+    return spxm_morton_spread3((unsigned int)p.x) | spxm_morton_spread3((unsigned int)p.y) << 1 |
+           spxm_morton_spread3((unsigned int)p.z) << 2;
+}
+
+SPXM_API ivec3 morton3_decode(unsigned int code)
+{
+    ivec3 p;
+    p.x = (int)spxm_morton_compact3(code);
+    p.y = (int)spxm_morton_compact3(code >> 1);
+    p.z = (int)spxm_morton_compact3(code >> 2);
+    return p;
+}
+
+#endif /* SPXM_BMI2 */
+
+/* quantizes n in [min, max] to [0, cells - 1], clamping outside values and
+NaN to the nearest end, in the operand order of the SSE min and max */
+
+static unsigned int spxm_quantize(float n, float min, float scale, float cells)
+{
+    n = (n - min) * scale;
+    n = n > 0.0F ? n : 0.0F;
+    n = n < cells - 1.0F ? n : cells - 1.0F;
+    return (unsigned int)n;
+}
+
+static float spxm_quantize_scale(float min, float max, float cells)
+{
+    return max > min ? cells / (max - min) : 0.0F;
+}
+
+SPXM_API unsigned int morton2_from_vec2(vec2 p, vec2 min, vec2 max)
+{
+    ivec2 q;
+    q.x = (int)spxm_quantize(p.x, min.x, spxm_quantize_scale(min.x, max.x, 65536.0F), 65536.0F);
+    q.y = (int)spxm_quantize(p.y, min.y, spxm_quantize_scale(min.y, max.y, 65536.0F), 65536.0F);
+    return morton2_encode(q);
+}
+
+SPXM_API unsigned int morton3_from_vec3(vec3 p, vec3 min, vec3 max)
+{
+    ivec3 q;
+    q.x = (int)spxm_quantize(p.x, min.x, spxm_quantize_scale(min.x, max.x, 1024.0F), 1024.0F);
+    q.y = (int)spxm_quantize(p.y, min.y, spxm_quantize_scale(min.y, max.y, 1024.0F), 1024.0F);
+    q.z = (int)spxm_quantize(p.z, min.z, spxm_quantize_scale(min.z, max.z, 1024.0F), 1024.0F);
+    return morton3_encode(q);
+}
+
+#ifdef SPXM_SIMD
+
+/* spxm_quantize of 4 lanes spread for morton3_encode, NEON min and max
+return NaN so NEON compares and selects like spxm_f4_slab */
+
+static spxm_i4 spxm_i4_quantize_spread3(spxm_f4 n, spxm_f4 min, spxm_f4 scale)
+{
+    spxm_f4 q = SPXM_F4_MUL(SPXM_F4_SUB(n, min), scale), top = SPXM_F4_SET1(1023.0F);
+    spxm_i4 i;
+#ifdef SPXM_SSE
+    q = SPXM_F4_MIN(SPXM_F4_MAX(q, SPXM_F4_ZERO()), top);
+#else
+    q = SPXM_F4_SELECT(SPXM_F4_CMPGT(q, SPXM_F4_ZERO()), q, SPXM_F4_ZERO());
+    q = SPXM_F4_SELECT(SPXM_F4_CMPLT(q, top), q, top);
+#endif
+    i = SPXM_F4_TO_I4(q);
+    i = SPXM_I4_AND(SPXM_I4_OR(i, SPXM_I4_SHL(i, 16)), SPXM_I4_SET1(0x030000ffU));
+    i = SPXM_I4_AND(SPXM_I4_OR(i, SPXM_I4_SHL(i, 8)), SPXM_I4_SET1(0x0300f00fU));
+    i = SPXM_I4_AND(SPXM_I4_OR(i, SPXM_I4_SHL(i, 4)), SPXM_I4_SET1(0x030c30c3U));
+    return SPXM_I4_AND(SPXM_I4_OR(i, SPXM_I4_SHL(i, 2)), SPXM_I4_SET1(0x09249249U));
+}
+
+#endif /* SPXM_SIMD */
+
+/* the keys of points begin to end, the same as morton3_from_vec3, separate
+ranges can be computed on separate threads */
+
+SPXM_API void morton3_from_vec3_soa(const vec3_soa* points, vec3 min, vec3 max, unsigned int* keys, size_t begin, size_t end)
+{
+    size_t i = begin;
+    float sx = spxm_quantize_scale(min.x, max.x, 1024.0F);
+    float sy = spxm_quantize_scale(min.y, max.y, 1024.0F);
+    float sz = spxm_quantize_scale(min.z, max.z, 1024.0F);
+#ifdef SPXM_SIMD
+    spxm_f4 mx = SPXM_F4_SET1(min.x), my = SPXM_F4_SET1(min.y), mz = SPXM_F4_SET1(min.z);
+    spxm_f4 fx = SPXM_F4_SET1(sx), fy = SPXM_F4_SET1(sy), fz = SPXM_F4_SET1(sz);
+    size_t stop = begin + ((end - begin) & ~(size_t)3);
+    for (; i < stop; i += 4) {
+        spxm_i4 x = spxm_i4_quantize_spread3(SPXM_F4_LOADU(points->x + i), mx, fx);
+        spxm_i4 y = spxm_i4_quantize_spread3(SPXM_F4_LOADU(points->y + i), my, fy);
+        spxm_i4 z = spxm_i4_quantize_spread3(SPXM_F4_LOADU(points->z + i), mz, fz);
+        SPXM_I4_STOREU(keys + i, SPXM_I4_OR(x, SPXM_I4_OR(SPXM_I4_SHL(y, 1), SPXM_I4_SHL(z, 2))));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < end; ++i) {
+        ivec3 q;
+        q.x = (int)spxm_quantize(points->x[i], min.x, sx, 1024.0F);
+        q.y = (int)spxm_quantize(points->y[i], min.y, sy, 1024.0F);
+        q.z = (int)spxm_quantize(points->z[i], min.z, sz, 1024.0F);
+        keys[i] = morton3_encode(q);
+    }
+}
+
+/* Least significant digit radix sort of keys and their values, 8 bits per
+pass, stable. radix_sort sorts on the calling thread and skips the passes in
+which all keys share the digit, the result ends up in keys and values and
+the tmp arrays are overwritten. values and tmp_values can be NULL to sort
+only the keys.
+
+The passes can also be run on several threads, for pass 0 to 3 with the
+points split into parts: every part counts its digits into counts + part *
+256 with radix_sort_count, one thread turns all counts into offsets with
+radix_sort_offsets, and every part scatters with radix_sort_scatter and
+offsets + part * 256. Every pass reads the output of the last one. */
+
+SPXM_API void radix_sort_count(const unsigned int* keys, size_t begin, size_t end, int pass, size_t* counts)
+{
+    size_t i;
+    int shift = pass * 8;
+    for (i = 0; i < 256; ++i) {
+        counts[i] = 0;
+    }
+    for (i = begin; i < end; ++i) {
+        ++counts[keys[i] >> shift & 0xff];
+    }
+}
+
+SPXM_API void radix_sort_offsets(size_t* counts, size_t parts)
+{
+    size_t digit, part, sum = 0;
+    for (digit = 0; digit < 256; ++digit) {
+        for (part = 0; part < parts; ++part) {
+            size_t n = counts[part * 256 + digit];
+            counts[part * 256 + digit] = sum;
+            sum += n;
+        }
+    }
+}
+
+SPXM_API void radix_sort_scatter(const unsigned int* keys, const unsigned int* values, size_t begin, size_t end, int pass,
+    size_t* offsets, unsigned int* out_keys, unsigned int* out_values)
+{
+    size_t i;
+    int shift = pass * 8;
+    if (values) {
+        for (i = begin; i < end; ++i) {
+            size_t j = offsets[keys[i] >> shift & 0xff]++;
+            out_keys[j] = keys[i];
+            out_values[j] = values[i];
+        }
+    } else {
+        for (i = begin; i < end; ++i) {
+            out_keys[offsets[keys[i] >> shift & 0xff]++] = keys[i];
+        }
+    }
+}
+
+SPXM_API void radix_sort(unsigned int* keys, unsigned int* values, unsigned int* tmp_keys, unsigned int* tmp_values, size_t count)
+{
+    size_t counts[4][256], i;
+    unsigned int *src_keys = keys, *src_values = values;
+    int pass;
+
+    if (!values) {
+        tmp_values = NULL;
+    }
+    for (pass = 0; pass < 4; ++pass) {
+        for (i = 0; i < 256; ++i) {
+            counts[pass][i] = 0;
+        }
+    }
+    for (i = 0; i < count; ++i) {
+        unsigned int k = keys[i];
+        ++counts[0][k & 0xff];
+        ++counts[1][k >> 8 & 0xff];
+        ++counts[2][k >> 16 & 0xff];
+        ++counts[3][k >> 24];
+    }
+
+    for (pass = 0; pass < 4; ++pass) {
+        unsigned int* swap;
+        if (!count || counts[pass][src_keys[0] >> pass * 8 & 0xff] == count) {
+            continue;
+        }
+        radix_sort_offsets(counts[pass], 1);
+        radix_sort_scatter(src_keys, src_values, 0, count, pass, counts[pass], tmp_keys, tmp_values);
+        swap = src_keys;
+        src_keys = tmp_keys;
+        tmp_keys = swap;
+        swap = src_values;
+        src_values = tmp_values;
+        tmp_values = swap;
+    }
+
+    if (src_keys != keys) {
+        for (i = 0; i < count; ++i) {
+            keys[i] = src_keys[i];
+        }
+        if (values) {
+            for (i = 0; i < count; ++i) {
+                values[i] = src_values[i];
+            }
+        }
+    }
+}
+
+/* compact storage formats, IEEE half floats, 8 and 16 bit normalized
+integers, octahedral normals and 10:10:10:2 words */
+
+#ifdef SPXM_SIMD
+
+/* narrowing stores of the low 8 or 16 bits of every lane and widening loads
+with zero extension, signed values are sign extended by the callers */
+
+static void spxm_i4_store_u16(unsigned short* p, spxm_i4 a)
+{
+#if defined(SPXM_SSE)
+    a = _mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 3, 2, 0));
+    a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 2, 0));
+    a = _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 3, 2, 0));
+    _mm_storel_epi64((__m128i*)(void*)p, a);
+#else
+    vst1_u16(p, vmovn_u32(a));
+#endif /* SPXM_SSE */
+}
+
+static void spxm_i4_store_u8(unsigned char* p, spxm_i4 a)
+{
+#if defined(SPXM_SSE)
+    unsigned int v;
+    a = _mm_and_si128(a, _mm_set1_epi32(0xff));
+    a = _mm_packs_epi32(a, a);
+    v = (unsigned int)_mm_cvtsi128_si32(_mm_packus_epi16(a, a));
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+#else
+    uint16x4_t h = vmovn_u32(a);
+    uint8x8_t b = vmovn_u16(vcombine_u16(h, h));
+    vst1_lane_u8(p, b, 0);
+    vst1_lane_u8(p + 1, b, 1);
+    vst1_lane_u8(p + 2, b, 2);
+    vst1_lane_u8(p + 3, b, 3);
+#endif /* SPXM_SSE */
+}
+
+static spxm_i4 spxm_i4_load_u16(const unsigned short* p)
+{
+#if defined(SPXM_SSE)
+    return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(const void*)p), _mm_setzero_si128());
+#else
+    return vmovl_u16(vld1_u16(p));
+#endif /* SPXM_SSE */
+}
+
+static spxm_i4 spxm_i4_load_u8(const unsigned char* p)
+{
+#if defined(SPXM_SSE)
+    __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_cvtsi32_si128((int)((unsigned int)p[0] | (unsigned int)p[1] << 8 |
+        (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24));
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(a, zero), zero);
+#else
+    uint8x8_t b = vdup_n_u8(0);
+    b = vld1_lane_u8(p, b, 0);
+    b = vld1_lane_u8(p + 1, b, 1);
+    b = vld1_lane_u8(p + 2, b, 2);
+    b = vld1_lane_u8(p + 3, b, 3);
+    return vmovl_u16(vget_low_u16(vmovl_u8(b)));
+#endif /* SPXM_SSE */
+}
+
+/* x ^ m - m sign extends the low bits below the sign bit m */
+
+#define SPXM_I4_SEXT(a, m) SPXM_I4_SUB(SPXM_I4_XOR(a, SPXM_I4_SET1(m)), SPXM_I4_SET1(m))
+
+#endif /* SPXM_SIMD */
+
+/* Half floats round to nearest even, overflow to infinity and keep
+subnormals. The portable conversions follow the branch free versions by
+Fabian Giesen and agree with the F16C and AArch64 hardware conversions
+bit for bit, except for NaN payloads which become the quiet NaN 0x7e00. */
+
+SPXM_API unsigned short half_from_float(float n)
+{
+    union { float f; unsigned int i; } u, magic;
+    unsigned int sign, h;
+
+    u.f = n;
+    sign = u.i & 0x80000000U;
+    u.i ^= sign;
+    if (u.i >= 0x47800000U) {
+        /* 65536 and above, the values from 65520 round up in the normal path */
+        h = u.i > 0x7f800000U ? 0x7e00U : 0x7c00U;
+    } else if (u.i < 0x38800000U) {
+        /* subnormal halves, adding 0.5 rounds the mantissa into the low bits */
+        magic.i = 0x3f000000U;
+        u.f += magic.f;
+        h = u.i - magic.i;
+    } else {
+        h = (u.i + 0xc8000fffU + ((u.i >> 13) & 1U)) >> 13;
+    }
+    return (unsigned short)(h | sign >> 16);
+}
+
+SPXM_API float float_from_half(unsigned short n)
+{
+    union { float f; unsigned int i; } u, magic;
+    unsigned int h = n & 0x7fffU;
+    magic.i = 0x77800000U;
+    u.i = h << 13;
+    u.f *= magic.f;
+    if (h > 0x7bffU) {
+        u.i |= 0x7f800000U;
+    }
+    u.i |= (unsigned int)(n & 0x8000U) << 16;
+    return u.f;
+}
+
+#if defined(SPXM_SIMD) && !defined(SPXM_F16C) && !(defined(SPXM_NEON) && (defined(__aarch64__) || defined(_M_ARM64)))
+
+static spxm_i4 spxm_f4_to_half(spxm_f4 x)
 {
-    p.x -= q.x;
-    p.y -= q.y;
-    p.z -= q.z;
-    p.w -= q.w;
-    return p;
+    spxm_f4 ax = SPXM_F4_ABS(x), magic = SPXM_F4_SET1(0.5F);
+    spxm_i4 ai = SPXM_F4_AS_I4(ax), sign = SPXM_I4_XOR(SPXM_F4_AS_I4(x), ai), sub, norm, inf;
+
+    sub = SPXM_I4_SUB(SPXM_F4_AS_I4(SPXM_F4_ADD(ax, magic)), SPXM_F4_AS_I4(magic));
+    norm = SPXM_I4_ADD(SPXM_I4_ADD(ai, SPXM_I4_SET1(0xc8000fff)), SPXM_I4_AND(SPXM_I4_SHR(ai, 13), SPXM_I4_SET1(1)));
+    norm = SPXM_I4_SHR(norm, 13);
+    inf = SPXM_F4_AS_I4(SPXM_F4_SELECT(SPXM_F4_CMPEQ(x, x), SPXM_I4_AS_F4(SPXM_I4_SET1(0x7c00)),
+        SPXM_I4_AS_F4(SPXM_I4_SET1(0x7e00))));
+
+    norm = SPXM_F4_AS_I4(SPXM_F4_SELECT(SPXM_F4_CMPLT(ax, SPXM_I4_AS_F4(SPXM_I4_SET1(0x38800000))),
+        SPXM_I4_AS_F4(sub), SPXM_I4_AS_F4(norm)));
+    norm = SPXM_F4_AS_I4(SPXM_F4_SELECT(SPXM_F4_CMPLT(ax, SPXM_I4_AS_F4(SPXM_I4_SET1(0x47800000))),
+        SPXM_I4_AS_F4(norm), SPXM_I4_AS_F4(inf)));
+    return SPXM_I4_OR(norm, SPXM_I4_SHR(sign, 16));
 }
 
-vec4 vec4_mult(vec4 p, float n)
+static spxm_f4 spxm_f4_from_half(spxm_i4 h)
 {
-    p.x *= n;
-    p.y *= n;
-    p.z *= n;
-    p.w *= n;
-    return p;
+    spxm_i4 em = SPXM_I4_AND(h, SPXM_I4_SET1(0x7fff)), sign = SPXM_I4_SHL(SPXM_I4_XOR(h, em), 16);
+    spxm_f4 x = SPXM_F4_MUL(SPXM_I4_AS_F4(SPXM_I4_SHL(em, 13)), SPXM_I4_AS_F4(SPXM_I4_SET1(0x77800000)));
+    spxm_f4 infnan = SPXM_F4_SELECT(SPXM_F4_CMPGT(SPXM_I4_TO_F4(em), SPXM_F4_SET1(31743.0F)),
+        SPXM_I4_AS_F4(SPXM_I4_SET1(0x7f800000)), SPXM_F4_ZERO());
+    return SPXM_I4_AS_F4(SPXM_I4_OR(SPXM_I4_OR(SPXM_F4_AS_I4(x), SPXM_F4_AS_I4(infnan)), sign));
 }
 
-vec4 vec4_div(vec4 p, float n)
+#endif /* SPXM_SIMD */
+
+SPXM_API void half_array_from_float(const float* in, unsigned short* out, size_t count)
 {
-    n = n == 0.0F ? 0.0F : 1.0F / n; 
-    p.x *= n;
-    p.y *= n;
-    p.z *= n;
-    p.w *= n;
-    return p;
+    size_t i = 0;
+#if defined(SPXM_F16C)
+    for (; i < (count & ~(size_t)7); i += 8) {
+        _mm_storeu_si128((__m128i*)(void*)(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), 0));
+    }
+#elif defined(SPXM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+    for (; i < (count & ~(size_t)3); i += 4) {
+        vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+    }
+#elif defined(SPXM_SIMD)
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4_store_u16(out + i, spxm_f4_to_half(SPXM_F4_LOADU(in + i)));
+    }
+#endif /* SPXM_F16C */
+    for (; i < count; ++i) {
+        out[i] = half_from_float(in[i]);
+    }
 }
 
-vec4 vec4_norm(vec4 p)
+SPXM_API void float_array_from_half(const unsigned short* in, float* out, size_t count)
 {
-    float n = sqrtf(p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w);
-    n = n == 0.0F ? 0.0F : 1.0F / n;
-    p.x *= n;
-    p.y *= n;
-    p.z *= n;
-    p.w *= n;
-    return p;
+    size_t i = 0;
+#if defined(SPXM_F16C)
+    for (; i < (count & ~(size_t)7); i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(const void*)(in + i))));
+    }
+#elif defined(SPXM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+    for (; i < (count & ~(size_t)3); i += 4) {
+        vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in + i))));
+    }
+#elif defined(SPXM_SIMD)
+    for (; i < (count & ~(size_t)3); i += 4) {
+        SPXM_F4_STOREU(out + i, spxm_f4_from_half(spxm_i4_load_u16(in + i)));
+    }
+#endif /* SPXM_F16C */
+    for (; i < count; ++i) {
+        out[i] = float_from_half(in[i]);
+    }
 }
 
-vec4 vec4_prod(vec4 p, vec4 q)
+/* Normalized integers map [0, 1] to [0, 2^n - 1] and [-1, 1] to
+[-(2^(n-1) - 1), 2^(n-1) - 1], rounding to nearest even like the SIMD
+conversions. Inputs are clamped, NaN has no defined code, and the most
+negative snorm code decodes to -1 like the code above it. */
+
+static int spxm_unorm_int(float n, float scale)
 {
-    p.x *= q.x;
-    p.y *= q.y;
-    p.z *= q.z;
-    p.w *= q.w;
-    return p;
+    n = n > 0.0F ? n : 0.0F;
+    n = n < 1.0F ? n : 1.0F;
+    return spxm_round_int(n * scale);
 }
 
-vec4 vec4_lerp(vec4 p, vec4 q, float t)
-{ 
-    p.x += t * (q.x - p.x);
-    p.y += t * (q.y - p.y);
-    p.z += t * (q.z - p.z);
-    p.w += t * (q.w - p.w);
-    return p;
+static int spxm_snorm_int(float n, float scale)
+{
+    n = n > -1.0F ? n : -1.0F;
+    n = n < 1.0F ? n : 1.0F;
+    return spxm_round_int(n * scale);
 }
 
-float vec4_sqmag(vec4 p)
+static float spxm_snorm_float(int n, float scale)
 {
-    return p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w;
+    float f = (float)n / scale;
+    return f > -1.0F ? f : -1.0F;
 }
 
-float vec4_mag(vec4 p)
+#ifdef SPXM_SIMD
+
+static spxm_i4 spxm_f4_unorm(spxm_f4 x, float scale)
 {
-    return sqrtf(p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w);
+    x = SPXM_F4_MIN(SPXM_F4_MAX(x, SPXM_F4_ZERO()), SPXM_F4_SET1(1.0F));
+    return SPXM_F4_ROUND_I4(SPXM_F4_MUL(x, SPXM_F4_SET1(scale)));
 }
 
-float vec4_sqdist(vec4 p, vec4 q)
+static spxm_i4 spxm_f4_snorm(spxm_f4 x, float scale)
 {
-    p.x -= q.x;
-    p.y -= q.y;
-    p.z -= q.z;
-    p.w -= q.w;
-    return p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w;
+    x = SPXM_F4_MIN(SPXM_F4_MAX(x, SPXM_F4_SET1(-1.0F)), SPXM_F4_SET1(1.0F));
+    return SPXM_F4_ROUND_I4(SPXM_F4_MUL(x, SPXM_F4_SET1(scale)));
 }
 
-float vec4_dist(vec4 p, vec4 q)
+static spxm_f4 spxm_f4_from_snorm(spxm_i4 a, float scale)
 {
-    p.x -= q.x;
-    p.y -= q.y;
-    p.z -= q.z;
-    p.w -= q.w;
-    return sqrtf(p.x * p.x + p.y * p.y + p.z * p.z + p.w * p.w);
+    return SPXM_F4_MAX(SPXM_F4_DIV(SPXM_I4_TO_F4(a), SPXM_F4_SET1(scale)), SPXM_F4_SET1(-1.0F));
 }
 
-float vec4_dot(vec4 p, vec4 q)
+#endif /* SPXM_SIMD */
+
+SPXM_API unsigned char unorm8_from_float(float n)
 {
-    return p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w;
+    return (unsigned char)spxm_unorm_int(n, 255.0F);
 }
 
-vec4 vec4_mult_mat4(vec4 p, mat4 m)
+SPXM_API signed char snorm8_from_float(float n)
 {
-    vec4 q;
-    q.x = p.x * m.data[0][0] + p.y * m.data[1][0] + p.z * m.data[2][0] + p.w * m.data[3][0];
-    q.y = p.x * m.data[0][1] + p.y * m.data[1][1] + p.z * m.data[2][1] + p.w * m.data[3][1];
-    q.z = p.x * m.data[0][2] + p.y * m.data[1][2] + p.z * m.data[2][2] + p.w * m.data[3][2];
-    q.w = p.x * m.data[0][3] + p.y * m.data[1][3] + p.z * m.data[2][3] + p.w * m.data[3][3];
-    return q;
+    return (signed char)spxm_snorm_int(n, 127.0F);
 }
 
-/* 4 x 4 matrix operations */
+SPXM_API unsigned short unorm16_from_float(float n)
+{
+    return (unsigned short)spxm_unorm_int(n, 65535.0F);
+}
 
-mat4 mat4_id(void)
+SPXM_API short snorm16_from_float(float n)
 {
-    mat4 m = {{
-        {1.0F, 0.0F, 0.0F, 0.0F},
-        {0.0F, 1.0F, 0.0F, 0.0F},
-        {0.0F, 0.0F, 1.0F, 0.0F},
-        {0.0F, 0.0F, 0.0F, 1.0F}
-    }};
-    return m;
+    return (short)spxm_snorm_int(n, 32767.0F);
 }
 
-mat4 mat4_zero(void)
+SPXM_API float float_from_unorm8(unsigned char n)
 {
-    mat4 m = {{{0.0F}}};
-    return m;
+    return (float)n / 255.0F;
 }
 
-mat4 mat4_translate(mat4 m, vec3 p)
+SPXM_API float float_from_snorm8(signed char n)
 {
-    m.data[3][0] = p.x;
-    m.data[3][1] = p.y;
-    m.data[3][2] = p.z;
-    return m;
+    return spxm_snorm_float(n, 127.0F);
 }
 
-mat4 mat4_mult(mat4 m1, mat4 m2)
+SPXM_API float float_from_unorm16(unsigned short n)
 {
-    mat4 m;
-    m.data[0][0] = m1.data[0][0] * m2.data[0][0] + m1.data[1][0] * m2.data[0][1] + m1.data[2][0] * m2.data[0][2] + m1.data[3][0] * m2.data[0][3];
-    m.data[0][1] = m1.data[0][1] * m2.data[0][0] + m1.data[1][1] * m2.data[0][1] + m1.data[2][1] * m2.data[0][2] + m1.data[3][1] * m2.data[0][3];
-    m.data[0][2] = m1.data[0][2] * m2.data[0][0] + m1.data[1][2] * m2.data[0][1] + m1.data[2][2] * m2.data[0][2] + m1.data[3][2] * m2.data[0][3];
-    m.data[0][3] = m1.data[0][3] * m2.data[0][0] + m1.data[1][3] * m2.data[0][1] + m1.data[2][3] * m2.data[0][2] + m1.data[3][3] * m2.data[0][3];
-    m.data[1][0] = m1.data[0][0] * m2.data[1][0] + m1.data[1][0] * m2.data[1][1] + m1.data[2][0] * m2.data[1][2] + m1.data[3][0] * m2.data[1][3];
-    m.data[1][1] = m1.data[0][1] * m2.data[1][0] + m1.data[1][1] * m2.data[1][1] + m1.data[2][1] * m2.data[1][2] + m1.data[3][1] * m2.data[1][3];
-    m.data[1][2] = m1.data[0][2] * m2.data[1][0] + m1.data[1][2] * m2.data[1][1] + m1.data[2][2] * m2.data[1][2] + m1.data[3][2] * m2.data[1][3];
-    m.data[1][3] = m1.data[0][3] * m2.data[1][0] + m1.data[1][3] * m2.data[1][1] + m1.data[2][3] * m2.data[1][2] + m1.data[3][3] * m2.data[1][3];
-    m.data[2][0] = m1.data[0][0] * m2.data[2][0] + m1.data[1][0] * m2.data[2][1] + m1.data[2][0] * m2.data[2][2] + m1.data[3][0] * m2.data[2][3];
-    m.data[2][1] = m1.data[0][1] * m2.data[2][0] + m1.data[1][1] * m2.data[2][1] + m1.data[2][1] * m2.data[2][2] + m1.data[3][1] * m2.data[2][3];
-    m.data[2][2] = m1.data[0][2] * m2.data[2][0] + m1.data[1][2] * m2.data[2][1] + m1.data[2][2] * m2.data[2][2] + m1.data[3][2] * m2.data[2][3];
-    m.data[2][3] = m1.data[0][3] * m2.data[2][0] + m1.data[1][3] * m2.data[2][1] + m1.data[2][3] * m2.data[2][2] + m1.data[3][3] * m2.data[2][3];
-    m.data[3][0] = m1.data[0][0] * m2.data[3][0] + m1.data[1][0] * m2.data[3][1] + m1.data[2][0] * m2.data[3][2] + m1.data[3][0] * m2.data[3][3];
-    m.data[3][1] = m1.data[0][1] * m2.data[3][0] + m1.data[1][1] * m2.data[3][1] + m1.data[2][1] * m2.data[3][2] + m1.data[3][1] * m2.data[3][3];
-    m.data[3][2] = m1.data[0][2] * m2.data[3][0] + m1.data[1][2] * m2.data[3][1] + m1.data[2][2] * m2.data[3][2] + m1.data[3][2] * m2.data[3][3];
-    m.data[3][3] = m1.data[0][3] * m2.data[3][0] + m1.data[1][3] * m2.data[3][1] + m1.data[2][3] * m2.data[3][2] + m1.data[3][3] * m2.data[3][3];
-    return m;
+    return (float)n / 65535.0F;
 }
 
-mat4 mat4_mult_vec4(mat4 m, vec4 p)
+SPXM_API float float_from_snorm16(short n)
 {
-    m.data[0][0] *= p.x;
-    m.data[0][1] *= p.x;
-    m.data[0][2] *= p.x;
-    m.data[0][3] *= p.x;
-    m.data[1][0] *= p.y;
-    m.data[1][1] *= p.y;
-    m.data[1][2] *= p.y;
-    m.data[1][3] *= p.y;
-    m.data[2][0] *= p.z;
-    m.data[2][1] *= p.z;
-    m.data[2][2] *= p.z;
-    m.data[2][3] *= p.z;
-    m.data[3][0] *= p.w;
-    m.data[3][1] *= p.w;
-    m.data[3][2] *= p.w;
-    m.data[3][3] *= p.w;
-    return m;
+    return spxm_snorm_float(n, 32767.0F);
 }
 
-mat4 mat4_mult_vec3(mat4 m, vec3 p)
+SPXM_API void unorm8_array_from_float(const float* in, unsigned char* out, size_t count)
 {
-    m.data[0][0] *= p.x;
-    m.data[0][1] *= p.x;
-    m.data[0][2] *= p.x;
-    m.data[0][3] *= p.x;
-    m.data[1][0] *= p.y;
-    m.data[1][1] *= p.y;
-    m.data[1][2] *= p.y;
-    m.data[1][3] *= p.y;
-    m.data[2][0] *= p.z;
-    m.data[2][1] *= p.z;
-    m.data[2][2] *= p.z;
-    m.data[2][3] *= p.z;
-    return m;
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4_store_u8(out + i, spxm_f4_unorm(SPXM_F4_LOADU(in + i), 255.0F));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = unorm8_from_float(in[i]);
+    }
 }
 
-mat4 mat4_scale(mat4 m, vec3 p)
+SPXM_API void snorm8_array_from_float(const float* in, signed char* out, size_t count)
 {
-    mat4 M = {{{0.0F}}};
-    M.data[0][0] = p.x;
-    M.data[1][1] = p.y;
-    M.data[2][2] = p.z;
-    M.data[3][3] = 1.0F;
-    return mat4_mult(M, m);
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4_store_u8((unsigned char*)(void*)(out + i), spxm_f4_snorm(SPXM_F4_LOADU(in + i), 127.0F));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = snorm8_from_float(in[i]);
+    }
 }
 
-mat4 mat4_rot(mat4 mat, float deg, vec3 rot_axis)
+SPXM_API void unorm16_array_from_float(const float* in, unsigned short* out, size_t count)
 {
-    float c, s;
-    vec3 axis, temp;
-    mat4 rot = {{{0.0F}}}, m = {{{0.0F}}};
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4_store_u16(out + i, spxm_f4_unorm(SPXM_F4_LOADU(in + i), 65535.0F));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = unorm16_from_float(in[i]);
+    }
+}
 
-    c = cosf(deg);
-    s = sinf(deg);
+SPXM_API void snorm16_array_from_float(const float* in, short* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4_store_u16((unsigned short*)(void*)(out + i), spxm_f4_snorm(SPXM_F4_LOADU(in + i), 32767.0F));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = snorm16_from_float(in[i]);
+    }
+}
 
-    axis = vec3_norm(rot_axis);
-	temp = vec3_mult(axis, 1.0f - c);
+SPXM_API void float_array_from_unorm8(const unsigned char* in, float* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x = SPXM_I4_TO_F4(spxm_i4_load_u8(in + i));
+        SPXM_F4_STOREU(out + i, SPXM_F4_DIV(x, SPXM_F4_SET1(255.0F)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = float_from_unorm8(in[i]);
+    }
+}
 
-    rot.data[0][0] = c + temp.x * axis.x;
-    rot.data[0][1] = temp.x * axis.y + s * axis.z;
-    rot.data[0][2] = temp.x * axis.z - s * axis.y;
-    rot.data[1][0] = temp.y * axis.x - s * axis.z;
-    rot.data[1][1] = c + temp.y * axis.y;
-    rot.data[1][2] = temp.y * axis.z + s * axis.x;
-    rot.data[2][0] = temp.z * axis.x + s * axis.y;
-    rot.data[2][1] = temp.z * axis.y - s * axis.x;
-    rot.data[2][2] = c + temp.z * axis.z;
+SPXM_API void float_array_from_snorm8(const signed char* in, float* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4 a = SPXM_I4_SEXT(spxm_i4_load_u8((const unsigned char*)(const void*)(in + i)), 0x80);
+        SPXM_F4_STOREU(out + i, spxm_f4_from_snorm(a, 127.0F));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = float_from_snorm8(in[i]);
+    }
+}
 
-    m.data[0][0] = mat.data[0][0] * rot.data[0][0] + mat.data[1][0] * rot.data[0][1] + mat.data[2][0] * rot.data[0][2];
-    m.data[0][1] = mat.data[0][1] * rot.data[0][0] + mat.data[1][1] * rot.data[0][1] + mat.data[2][1] * rot.data[0][2];
-    m.data[0][2] = mat.data[0][2] * rot.data[0][0] + mat.data[1][2] * rot.data[0][1] + mat.data[2][2] * rot.data[0][2];
-    m.data[1][0] = mat.data[0][0] * rot.data[1][0] + mat.data[1][0] * rot.data[1][1] + mat.data[2][0] * rot.data[1][2];
-    m.data[1][1] = mat.data[0][1] * rot.data[1][0] + mat.data[1][1] * rot.data[1][1] + mat.data[2][1] * rot.data[1][2];
-    m.data[1][2] = mat.data[0][2] * rot.data[1][0] + mat.data[1][2] * rot.data[1][1] + mat.data[2][2] * rot.data[1][2];
-    m.data[2][0] = mat.data[0][0] * rot.data[2][0] + mat.data[1][0] * rot.data[2][1] + mat.data[2][0] * rot.data[2][2];
-    m.data[2][1] = mat.data[0][1] * rot.data[2][0] + mat.data[1][1] * rot.data[2][1] + mat.data[2][1] * rot.data[2][2];
-    m.data[2][2] = mat.data[0][2] * rot.data[2][0] + mat.data[1][2] * rot.data[2][1] + mat.data[2][2] * rot.data[2][2];
-    m.data[3][0] = mat.data[3][0];
-    m.data[3][1] = mat.data[3][1];
-    m.data[3][2] = mat.data[3][2];
-    m.data[3][3] = mat.data[3][3];
-    return m;
+SPXM_API void float_array_from_unorm16(const unsigned short* in, float* out, size_t count)
+{
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x = SPXM_I4_TO_F4(spxm_i4_load_u16(in + i));
+        SPXM_F4_STOREU(out + i, SPXM_F4_DIV(x, SPXM_F4_SET1(65535.0F)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = float_from_unorm16(in[i]);
+    }
 }
 
-mat4 mat4_perspective_RH(float fov, float aspect, float near, float far)
+SPXM_API void float_array_from_snorm16(const short* in, float* out, size_t count)
 {
-    mat4 m = {{{0.0F}}};
-    float tan_half_fov = tanf(fov / 2.0f);
-    m.data[0][0] = 1.0f / (aspect * tan_half_fov);
-    m.data[1][1] = 1.0f / tan_half_fov;
-    m.data[2][2] = (far + near) / (far - near);
-    m.data[2][3] = 1.0f;
-    m.data[3][2] = (2.0f * far * near) / (far - near);
-    return m;
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4 a = SPXM_I4_SEXT(spxm_i4_load_u16((const unsigned short*)(const void*)(in + i)), 0x8000);
+        SPXM_F4_STOREU(out + i, spxm_f4_from_snorm(a, 32767.0F));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = float_from_snorm16(in[i]);
+    }
 }
 
-mat4 mat4_perspective_LH(float fov, float aspect, float near, float far)
+/* Octahedral unit vectors, the sphere projected on the octahedron
+|x| + |y| + |z| = 1 and its lower half folded over the corners onto the
+square [-1, 1]^2. Two snorm16 in 32 bits keep the direction within about
+0.005 degrees, decoding renormalizes. */
+
+SPXM_API vec2 oct_from_vec3(vec3 n)
 {
-    mat4 m = {{{0.0F}}};
-    float tan_half_fov = tanf(fov / 2.0f);
-    m.data[0][0] = 1.0f / (aspect * tan_half_fov);
-    m.data[1][1] = 1.0f / tan_half_fov;
-    m.data[2][2] = (far + near) / (far - near);
-    m.data[2][3] = 1.0f;
-    m.data[3][2] = - (2.0f * far * near) / (far - near);
-    return m;
+    vec2 p;
+    float l1 = absf(n.x) + absf(n.y) + absf(n.z);
+    l1 = l1 == 0.0F ? 0.0F : 1.0F / l1;
+    p.x = n.x * l1;
+    p.y = n.y * l1;
+    if (n.z < 0.0F) {
+        float x = p.x;
+        p.x = (1.0F - absf(p.y)) * (x >= 0.0F ? 1.0F : -1.0F);
+        p.y = (1.0F - absf(x)) * (p.y >= 0.0F ? 1.0F : -1.0F);
+    }
+    return p;
 }
 
-mat4 mat4_look_at_RH(vec3 eye_position, vec3 eye_direction, vec3 eye_up)
+SPXM_API vec3 vec3_from_oct(vec2 p)
 {
-    vec3 f, s, u;
-    mat4 m = {{{0.0F}}};
-    f = vec3_norm(vec3_sub(eye_direction, eye_position));
-    s = vec3_norm(vec3_cross(f, eye_up));
-    u = vec3_cross(s, f);
-    m.data[0][0] = s.x;
-    m.data[1][0] = s.y;
-    m.data[2][0] = s.z;
-    m.data[0][1] = u.x;
-    m.data[1][1] = u.y;
-    m.data[2][1] = u.z;
-    m.data[0][2] = -f.x;
-    m.data[1][2] = -f.y;
-    m.data[2][2] = -f.z;
-    m.data[3][0] = -vec3_dot(s, eye_position);
-    m.data[3][1] = -vec3_dot(u, eye_position);
-    m.data[3][2] = vec3_dot(f, eye_position);
-    m.data[3][3] = 1.0f;
-    return m;
+    vec3 n;
+    float t;
+    n.x = p.x;
+    n.y = p.y;
+    n.z = 1.0F - absf(p.x) - absf(p.y);
+    t = -n.z > 0.0F ? -n.z : 0.0F;
+    n.x += n.x >= 0.0F ? -t : t;
+    n.y += n.y >= 0.0F ? -t : t;
+    t = SPXM_RSQRTF(n.x * n.x + n.y * n.y + n.z * n.z);
+    n.x *= t;
+    n.y *= t;
+    n.z *= t;
+    return n;
 }
 
-mat4 mat4_look_at_LH(vec3 eye_position, vec3 eye_direction, vec3 eye_up)
+SPXM_API unsigned int oct32_from_vec3(vec3 n)
 {
-    vec3 f, s, u;
-    mat4 m = {{{0.0F}}};
-    f = vec3_norm(vec3_sub(eye_direction, eye_position));
-    s = vec3_norm(vec3_cross(eye_up, f));
-    u = vec3_cross(f, s);
-    m.data[0][0] = s.x;
-    m.data[1][0] = s.y;
-    m.data[2][0] = s.z;
-    m.data[0][1] = u.x;
-    m.data[1][1] = u.y;
-    m.data[2][1] = u.z;
-    m.data[0][2] = f.x;
-    m.data[1][2] = f.y;
-    m.data[2][2] = f.z;
-    m.data[3][0] = -vec3_dot(s, eye_position);
-    m.data[3][1] = -vec3_dot(u, eye_position);
-    m.data[3][2] = -vec3_dot(f, eye_position);
-    m.data[3][3] = 1.0f;
-    return m;
+    vec2 p = oct_from_vec3(n);
+    return ((unsigned int)spxm_snorm_int(p.x, 32767.0F) & 0xffffU) |
+        (unsigned int)spxm_snorm_int(p.y, 32767.0F) << 16;
 }
 
-mat4 mat4_ortho(float left, float right, float bottom, float top)
+SPXM_API vec3 vec3_from_oct32(unsigned int n)
 {
-    mat4 ret = mat4_id();
-    ret.data[0][0] = 2.0f / (right - left);
-    ret.data[1][1] = 2.0f / (top - bottom);
-    ret.data[2][2] = - 1.0f;
-    ret.data[3][0] = - (right + left) / (right - left);
-    ret.data[3][1] = - (top + bottom) / (top - bottom);
-    return ret;
+    vec2 p;
+    p.x = spxm_snorm_float((int)((n & 0xffffU) ^ 0x8000U) - 0x8000, 32767.0F);
+    p.y = spxm_snorm_float((int)((n >> 16) ^ 0x8000U) - 0x8000, 32767.0F);
+    return vec3_from_oct(p);
 }
 
-mat4 mat4_perspective(float fov, float aspect, float near, float far)
+SPXM_API void oct32_array_from_vec3(const vec3* in, unsigned int* out, size_t count)
 {
-    return mat4_perspective_RH(fov, aspect, near, far);
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, z, l1, fx, fy, zero = SPXM_F4_ZERO(), one = SPXM_F4_SET1(1.0F);
+        spxm_m4 back;
+        spxm_f4_load_vec3(&in[i].x, &x, &y, &z);
+        l1 = SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_ABS(x), SPXM_F4_ABS(y)), SPXM_F4_ABS(z));
+        l1 = SPXM_F4_SELECT(SPXM_F4_CMPEQ(l1, zero), zero, SPXM_F4_DIV(one, l1));
+        back = SPXM_F4_CMPLT(z, zero);
+        x = SPXM_F4_MUL(x, l1);
+        y = SPXM_F4_MUL(y, l1);
+        fx = SPXM_F4_MUL(SPXM_F4_SUB(one, SPXM_F4_ABS(y)), SPXM_F4_SELECT(SPXM_F4_CMPGE(x, zero), one, SPXM_F4_SET1(-1.0F)));
+        fy = SPXM_F4_MUL(SPXM_F4_SUB(one, SPXM_F4_ABS(x)), SPXM_F4_SELECT(SPXM_F4_CMPGE(y, zero), one, SPXM_F4_SET1(-1.0F)));
+        x = SPXM_F4_SELECT(back, fx, x);
+        y = SPXM_F4_SELECT(back, fy, y);
+        SPXM_I4_STOREU(out + i, SPXM_I4_OR(SPXM_I4_AND(spxm_f4_snorm(x, 32767.0F), SPXM_I4_SET1(0xffff)),
+            SPXM_I4_SHL(spxm_f4_snorm(y, 32767.0F), 16)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = oct32_from_vec3(in[i]);
+    }
 }
 
-mat4 mat4_look_at(vec3 eye_position, vec3 eye_direction, vec3 eye_up)
+SPXM_API void vec3_array_from_oct32(const unsigned int* in, vec3* out, size_t count)
 {
-    return mat4_look_at_RH(eye_position, eye_direction, eye_up);
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4 a = SPXM_I4_LOADU(in + i);
+        spxm_f4 x, y, z, t, zero = SPXM_F4_ZERO();
+        x = spxm_f4_from_snorm(SPXM_I4_SEXT(SPXM_I4_AND(a, SPXM_I4_SET1(0xffff)), 0x8000), 32767.0F);
+        y = spxm_f4_from_snorm(SPXM_I4_SEXT(SPXM_I4_SHR(a, 16), 0x8000), 32767.0F);
+        z = SPXM_F4_SUB(SPXM_F4_SUB(SPXM_F4_SET1(1.0F), SPXM_F4_ABS(x)), SPXM_F4_ABS(y));
+        t = SPXM_F4_MAX(SPXM_F4_XOR(z, SPXM_F4_SIGNMASK()), zero);
+        x = SPXM_F4_ADD(x, SPXM_F4_SELECT(SPXM_F4_CMPGE(x, zero), SPXM_F4_XOR(t, SPXM_F4_SIGNMASK()), t));
+        y = SPXM_F4_ADD(y, SPXM_F4_SELECT(SPXM_F4_CMPGE(y, zero), SPXM_F4_XOR(t, SPXM_F4_SIGNMASK()), t));
+        t = SPXM_F4_RSQRT(SPXM_F4_ADD(SPXM_F4_ADD(SPXM_F4_MUL(x, x), SPXM_F4_MUL(y, y)), SPXM_F4_MUL(z, z)));
+        spxm_f4_store_vec3(&out[i].x, SPXM_F4_MUL(x, t), SPXM_F4_MUL(y, t), SPXM_F4_MUL(z, t));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = vec3_from_oct32(in[i]);
+    }
 }
 
-mat4 mat4_model(vec3 translation, vec3 scale, vec3 rot_axis, float rot_degs)
+/* 10:10:10:2 words with x in the low bits, the layout of the R10G10B10A2
+vertex and texture formats, unorm or snorm in all four fields */
+
+SPXM_API unsigned int unorm1010102_from_vec4(vec4 p)
 {
-    mat4 model = mat4_scale(mat4_id(), scale);
-    model = mat4_rot(model, rot_degs, rot_axis);
-    model = mat4_translate(model, translation);
-    return model;
+    return (unsigned int)spxm_unorm_int(p.x, 1023.0F) | (unsigned int)spxm_unorm_int(p.y, 1023.0F) << 10 |
+        (unsigned int)spxm_unorm_int(p.z, 1023.0F) << 20 | (unsigned int)spxm_unorm_int(p.w, 3.0F) << 30;
 }
 
-/* convert betwen integer and float vector types */
+SPXM_API vec4 vec4_from_unorm1010102(unsigned int n)
+{
+    vec4 p;
+    p.x = (float)(n & 0x3ffU) / 1023.0F;
+    p.y = (float)(n >> 10 & 0x3ffU) / 1023.0F;
+    p.z = (float)(n >> 20 & 0x3ffU) / 1023.0F;
+    p.w = (float)(n >> 30) / 3.0F;
+    return p;
+}
 
-vec2 vec2_from_ivec2(ivec2 p)
+SPXM_API unsigned int snorm1010102_from_vec4(vec4 p)
 {
-    vec2 q;
-    q.x = (float)p.x;
-    q.y = (float)p.y;
-    return q;
+    return ((unsigned int)spxm_snorm_int(p.x, 511.0F) & 0x3ffU) |
+        ((unsigned int)spxm_snorm_int(p.y, 511.0F) & 0x3ffU) << 10 |
+        ((unsigned int)spxm_snorm_int(p.z, 511.0F) & 0x3ffU) << 20 |
+        (unsigned int)spxm_snorm_int(p.w, 1.0F) << 30;
 }
 
-vec3 vec3_from_ivec3(ivec3 p)
+SPXM_API vec4 vec4_from_snorm1010102(unsigned int n)
 {
-    vec3 q;
-    q.x = (float)p.x;
-    q.y = (float)p.y;
-    q.z = (float)p.z;
-    return q;
+    vec4 p;
+    p.x = spxm_snorm_float((int)((n & 0x3ffU) ^ 0x200U) - 0x200, 511.0F);
+    p.y = spxm_snorm_float((int)((n >> 10 & 0x3ffU) ^ 0x200U) - 0x200, 511.0F);
+    p.z = spxm_snorm_float((int)((n >> 20 & 0x3ffU) ^ 0x200U) - 0x200, 511.0F);
+    p.w = spxm_snorm_float((int)((n >> 30) ^ 2U) - 2, 1.0F);
+    return p;
 }
 
-vec4 vec4_from_ivec4(ivec4 p)
+SPXM_API void unorm1010102_array_from_vec4(const vec4* in, unsigned int* out, size_t count)
 {
-    vec4 q;
-    q.x = (float)p.x;
-    q.y = (float)p.y;
-    q.z = (float)p.z;
-    q.w = (float)p.w;
-    return q;
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, z, w;
+        spxm_i4 a;
+        spxm_f4_load_vec4(&in[i].x, &x, &y, &z, &w);
+        a = SPXM_I4_OR(spxm_f4_unorm(x, 1023.0F), SPXM_I4_SHL(spxm_f4_unorm(y, 1023.0F), 10));
+        a = SPXM_I4_OR(a, SPXM_I4_SHL(spxm_f4_unorm(z, 1023.0F), 20));
+        SPXM_I4_STOREU(out + i, SPXM_I4_OR(a, SPXM_I4_SHL(spxm_f4_unorm(w, 3.0F), 30)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = unorm1010102_from_vec4(in[i]);
+    }
 }
 
-ivec2 ivec2_from_vec2(vec2 p)
+SPXM_API void vec4_array_from_unorm1010102(const unsigned int* in, vec4* out, size_t count)
 {
-	ivec2 q;
-    q.x = (int)p.x;
-    q.y = (int)p.y;
-    return q;
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4 a = SPXM_I4_LOADU(in + i), mask = SPXM_I4_SET1(0x3ff);
+        spxm_f4 s = SPXM_F4_SET1(1023.0F);
+        spxm_f4_store_vec4(&out[i].x,
+            SPXM_F4_DIV(SPXM_I4_TO_F4(SPXM_I4_AND(a, mask)), s),
+            SPXM_F4_DIV(SPXM_I4_TO_F4(SPXM_I4_AND(SPXM_I4_SHR(a, 10), mask)), s),
+            SPXM_F4_DIV(SPXM_I4_TO_F4(SPXM_I4_AND(SPXM_I4_SHR(a, 20), mask)), s),
+            SPXM_F4_DIV(SPXM_I4_TO_F4(SPXM_I4_SHR(a, 30)), SPXM_F4_SET1(3.0F)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = vec4_from_unorm1010102(in[i]);
+    }
 }
 
-ivec3 ivec3_from_vec3(vec3 p)
+SPXM_API void snorm1010102_array_from_vec4(const vec4* in, unsigned int* out, size_t count)
 {
-	ivec3 q;
-    q.x = (int)p.x;
-    q.y = (int)p.y;
-    q.z = (int)p.z;
-    return q;
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_f4 x, y, z, w;
+        spxm_i4 a, mask = SPXM_I4_SET1(0x3ff);
+        spxm_f4_load_vec4(&in[i].x, &x, &y, &z, &w);
+        a = SPXM_I4_AND(spxm_f4_snorm(x, 511.0F), mask);
+        a = SPXM_I4_OR(a, SPXM_I4_SHL(SPXM_I4_AND(spxm_f4_snorm(y, 511.0F), mask), 10));
+        a = SPXM_I4_OR(a, SPXM_I4_SHL(SPXM_I4_AND(spxm_f4_snorm(z, 511.0F), mask), 20));
+        SPXM_I4_STOREU(out + i, SPXM_I4_OR(a, SPXM_I4_SHL(spxm_f4_snorm(w, 1.0F), 30)));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = snorm1010102_from_vec4(in[i]);
+    }
 }
 
-ivec4 ivec4_from_vec4(vec4 p)
+SPXM_API void vec4_array_from_snorm1010102(const unsigned int* in, vec4* out, size_t count)
 {
-	ivec4 q;
-    q.x = (int)p.x;
-    q.y = (int)p.y;
-    q.z = (int)p.z;
-    q.w = (int)p.w;
-    return q;
+    size_t i = 0;
+#ifdef SPXM_SIMD
+    for (; i < (count & ~(size_t)3); i += 4) {
+        spxm_i4 a = SPXM_I4_LOADU(in + i), mask = SPXM_I4_SET1(0x3ff);
+        spxm_f4_store_vec4(&out[i].x,
+            spxm_f4_from_snorm(SPXM_I4_SEXT(SPXM_I4_AND(a, mask), 0x200), 511.0F),
+            spxm_f4_from_snorm(SPXM_I4_SEXT(SPXM_I4_AND(SPXM_I4_SHR(a, 10), mask), 0x200), 511.0F),
+            spxm_f4_from_snorm(SPXM_I4_SEXT(SPXM_I4_AND(SPXM_I4_SHR(a, 20), mask), 0x200), 511.0F),
+            spxm_f4_from_snorm(SPXM_I4_SEXT(SPXM_I4_SHR(a, 30), 2), 1.0F));
+    }
+#endif /* SPXM_SIMD */
+    for (; i < count; ++i) {
+        out[i] = vec4_from_snorm1010102(in[i]);
+    }
 }
 
 #endif /* SPXM_APPLICATION */
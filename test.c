@@ -1,14 +1,951 @@
 #define SPXM_APPLICATION
 #include <spxmath.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
 
+/* spxmtest [count] [seed] prints count random floats, spxmtest check [name]
+runs the checks whose name contains name and fails when any of them fails */
+
+typedef int (*testfn)(void);
+
+static const char* filter = NULL;
+static int failures = 0;
+
+static void test(const char* name, testfn fn)
+{
+    int ok;
+    if (filter && !strstr(name, filter)) {
+        return;
+    }
+    ok = fn();
+    printf("%s: %s\n", name, ok ? "ok" : "FAILED");
+    failures += !ok;
+}
+
+/* max error of the approximations against double precision references */
+
+#define TEST_SAMPLES 4000000L
+
+static double err_max;
+
+static void err_add(double x, double ref)
+{
+    double d = x > ref ? x - ref : ref - x;
+    err_max = d > err_max ? d : err_max;
+}
+
+static int err_check(double bound)
+{
+    double err = err_max;
+    err_max = 0.0;
+    if (err > bound) {
+        printf("max error %.3g above %.3g\n", err, bound);
+    }
+    return err <= bound;
+}
+
+static float test_angle(long i, double range)
+{
+    return (float)((double)(i - TEST_SAMPLES / 2) * (range * 2.0 / (double)TEST_SAMPLES));
+}
+
+static int test_sinf_fast(void)
+{
+    long i;
+    for (i = 0; i <= TEST_SAMPLES; ++i) {
+        float x = test_angle(i, 8192.0);
+        err_add(sinf_fast(x), sin(x));
+    }
+    return err_check(1.25e-7);
+}
+
+static int test_cosf_fast(void)
+{
+    long i;
+    for (i = 0; i <= TEST_SAMPLES; ++i) {
+        float x = test_angle(i, 8192.0);
+        err_add(cosf_fast(x), cos(x));
+    }
+    return err_check(1.25e-7);
+}
+
+static int test_atan2f_fast(void)
+{
+    long i;
+    spxrng rng = spxrng_new(1);
+    for (i = 0; i < TEST_SAMPLES; ++i) {
+        float x = spxrandf_between_r(&rng, -1.0F, 1.0F) * spxrandf_r(&rng) * 100.0F;
+        float y = spxrandf_between_r(&rng, -1.0F, 1.0F) * spxrandf_r(&rng) * 100.0F;
+        err_add(atan2f_fast(y, x), atan2(y, x));
+    }
+    return err_check(2e-6);
+}
+
+static int test_spxm_sincosf(void)
+{
+    long i;
+    int ok;
+    float s, c;
+    for (i = 0; i <= TEST_SAMPLES; ++i) {
+        float x = test_angle(i, 3.14159265);
+        spxm_sincosf(x, &s, &c);
+        err_add(s, sin(x));
+        err_add(c, cos(x));
+    }
+    ok = err_check(1.5e-7);
+    for (i = 0; i <= TEST_SAMPLES; ++i) {
+        float x = test_angle(i, 8192.0);
+        spxm_sincosf(x, &s, &c);
+        err_add(s, sin(x));
+        err_add(c, cos(x));
+    }
+    ok &= err_check(1.8e-7);
+    for (i = 0; i <= TEST_SAMPLES; ++i) {
+        float x = test_angle(i, 1e6);
+        spxm_sincosf(x, &s, &c);
+        err_add(s, sin(x));
+        err_add(c, cos(x));
+    }
+    return ok & err_check(1.8e-7);
+}
+
+/* relative error */
+
+static int test_rsqrtf_fast(void)
+{
+    long i;
+    for (i = 1; i <= TEST_SAMPLES; ++i) {
+        float x = (float)i * (1000.0F / (float)TEST_SAMPLES);
+        double ref = 1.0 / sqrt(x);
+        err_add(rsqrtf_fast(x) / ref, 1.0);
+    }
+    return err_check(3e-7);
+}
+
+/* exact comparisons of the SIMD and batch functions with the scalar code,
+on random input from a fixed seed */
+
+static mat4 test_mat4(spxrng* rng)
+{
+    mat4 m;
+    int i, j;
+    for (i = 0; i < 4; ++i) {
+        for (j = 0; j < 4; ++j) {
+            m.data[i][j] = spxrandf_between_r(rng, -2.0F, 2.0F);
+        }
+    }
+    return m;
+}
+
+static int test_mat4_mult_to(void)
+{
+    spxrng rng = spxrng_new(1);
+    int n, i, j, ok = 1;
+    for (n = 0; n < 10000; ++n) {
+        mat4 a = test_mat4(&rng), b = test_mat4(&rng), ref, m;
+        for (i = 0; i < 4; ++i) {
+            for (j = 0; j < 4; ++j) {
+                ref.data[i][j] = a.data[0][j] * b.data[i][0] + a.data[1][j] * b.data[i][1] + a.data[2][j] * b.data[i][2] + a.data[3][j] * b.data[i][3];
+            }
+        }
+        mat4_mult_to(&m, &a, &b);
+        ok &= !memcmp(&m, &ref, sizeof(mat4));
+        m = mat4_mult(a, b);
+        ok &= !memcmp(&m, &ref, sizeof(mat4));
+        mat4_mult_inplace(&a, &b);
+        ok &= !memcmp(&a, &ref, sizeof(mat4));
+    }
+    return ok;
+}
+
+/* the fills continue the sequence of the single calls, from a seed close
+to the wrap around of the counter */
+
+#define TEST_FILL 1003
+
+static int test_spxrand_fill(void)
+{
+    unsigned int u[TEST_FILL], seed = 0xfffffe00U;
+    float f[TEST_FILL];
+    vec3 v[TEST_FILL / 3];
+    size_t i;
+    int ok = 1;
+
+    spxrand_seed_set(seed);
+    spxrand_fill(u, TEST_FILL);
+    spxrand_seed_set(seed);
+    for (i = 0; i < TEST_FILL; ++i) {
+        ok &= u[i] == spxrand() && u[i] == spxrand_hash(seed + (unsigned int)i);
+    }
+    spxrand_hash_fill(seed, u, TEST_FILL);
+    for (i = 0; i < TEST_FILL; ++i) {
+        ok &= u[i] == spxrand_hash(seed + (unsigned int)i);
+    }
+
+    spxrand_seed_set(seed);
+    spxrandf_fill(f, TEST_FILL);
+    ok &= spxrand_seed_get() == seed + TEST_FILL;
+    spxrand_seed_set(seed);
+    for (i = 0; i < TEST_FILL; ++i) {
+        float n = spxrandf();
+        ok &= !memcmp(f + i, &n, sizeof(float));
+    }
+    spxrandf_hash_fill(seed, f, TEST_FILL);
+    for (i = 0; i < TEST_FILL; ++i) {
+        float n = spxrandf_hash(seed + (unsigned int)i);
+        ok &= !memcmp(f + i, &n, sizeof(float));
+    }
+
+    spxrand_seed_set(seed);
+    vec3_rand_fill(v, TEST_FILL / 3);
+    spxrand_seed_set(seed);
+    for (i = 0; i < TEST_FILL / 3; ++i) {
+        vec3 n = vec3_rand();
+        ok &= !memcmp(v + i, &n, sizeof(vec3));
+    }
+    return ok;
+}
+
+/* the array version also takes angles beyond the reduction range, and
+vec2_from_rad calls sinf and cosf unless SPXM_FAST_MATH is defined */
+
+static int test_spxm_sincosf_array(void)
+{
+    float x[TEST_FILL], s[TEST_FILL], c[TEST_FILL];
+    spxrng rng = spxrng_new(1);
+    size_t i;
+    int ok = 1;
+    for (i = 0; i < TEST_FILL; ++i) {
+        x[i] = spxrandf_between_r(&rng, -10000.0F, 10000.0F);
+    }
+    spxm_sincosf_array(x, s, c, TEST_FILL);
+    for (i = 0; i < TEST_FILL; ++i) {
+        vec2 p = vec2_from_rad(x[i]);
+        float ss, cs;
+        spxm_sincosf(x[i], &ss, &cs);
+        ok &= !memcmp(s + i, &ss, sizeof(float)) && !memcmp(c + i, &cs, sizeof(float));
+#ifndef SPXM_FAST_MATH
+        ss = sinf(x[i]);
+        cs = cosf(x[i]);
+#endif /* SPXM_FAST_MATH */
+        ok &= !memcmp(&p.y, &ss, sizeof(float)) && !memcmp(&p.x, &cs, sizeof(float));
+    }
+    return ok;
+}
+
+/* every eighth matrix is singular, with two equal columns */
+
+static int test_mat4_inverse(void)
+{
+    mat4 m[TEST_FILL], inv[TEST_FILL];
+    float det[TEST_FILL];
+    spxrng rng = spxrng_new(1);
+    size_t i;
+    int ok = 1;
+    for (i = 0; i < TEST_FILL; ++i) {
+        m[i] = test_mat4(&rng);
+        if (i % 8 == 0) {
+            memcpy(m[i].data[2], m[i].data[0], sizeof(m[i].data[0]));
+        }
+    }
+    mat4_array_inverse(m, inv, TEST_FILL);
+    mat4_array_det(m, det, TEST_FILL);
+    for (i = 0; i < TEST_FILL; ++i) {
+        mat4 r = mat4_inverse(m[i]), t;
+        float d = mat4_det(m[i]);
+        mat4_inverse_to(&t, m + i);
+        ok &= !memcmp(inv + i, &r, sizeof(mat4)) && !memcmp(&t, &r, sizeof(mat4));
+        ok &= !memcmp(det + i, &d, sizeof(float));
+    }
+    return ok;
+}
+
+static quat test_quat(spxrng* rng)
+{
+    quat q;
+    q.x = spxrandf_between_r(rng, -1.0F, 1.0F);
+    q.y = spxrandf_between_r(rng, -1.0F, 1.0F);
+    q.z = spxrandf_between_r(rng, -1.0F, 1.0F);
+    q.w = spxrandf_between_r(rng, -1.0F, 1.0F);
+    return quat_norm(q);
+}
+
+/* every fourth pair is nearly parallel or opposite, where both fall back
+to quat_nlerp, and some q are 1% longer, which only the nlerp lanes undo */
+
+static int test_quat_array_slerp(void)
+{
+    quat p[TEST_FILL], q[TEST_FILL], out[TEST_FILL];
+    spxrng rng = spxrng_new(1);
+    size_t i;
+    for (i = 0; i < TEST_FILL; ++i) {
+        p[i] = test_quat(&rng);
+        q[i] = test_quat(&rng);
+        if (i % 4 == 0) {
+            float s = i % 8 ? -1.0F : 1.0F;
+            q[i].x = p[i].x * s + 0.001F;
+            q[i].y = p[i].y * s;
+            q[i].z = p[i].z * s;
+            q[i].w = p[i].w * s;
+            q[i] = quat_norm(q[i]);
+        } else if (i % 4 == 2) {
+            q[i].x *= 1.01F;
+            q[i].y *= 1.01F;
+            q[i].z *= 1.01F;
+            q[i].w *= 1.01F;
+        }
+    }
+    quat_array_slerp(p, q, 0.3F, out, TEST_FILL);
+    for (i = 0; i < TEST_FILL; ++i) {
+        quat r = quat_slerp(p[i], q[i], 0.3F);
+        err_add(out[i].x, r.x);
+        err_add(out[i].y, r.y);
+        err_add(out[i].z, r.z);
+        err_add(out[i].w, r.w);
+    }
+    return err_check(1e-6);
+}
+
+/* the batch tests over the whole array and over a range starting at 32,
+against the single tests */
+
+static int test_frustum(void)
+{
+    frustum f = frustum_from_mat4(mat4_mult(mat4_perspective_LH(1.5707963F, 1.0F, 0.1F, 100.0F),
+        mat4_look_at_LH(vec3_new(0.0F, 0.0F, 0.0F), vec3_new(0.0F, 0.0F, -1.0F), vec3_new(0.0F, 1.0F, 0.0F))));
+    vec4_soa spheres = vec4_soa_create(TEST_FILL);
+    vec3_soa mins = vec3_soa_create(TEST_FILL), maxs = vec3_soa_create(TEST_FILL);
+    unsigned int smask[TEST_FILL / 32 + 1], bmask[TEST_FILL / 32 + 1];
+    spxrng rng = spxrng_new(1);
+    size_t i, begin;
+    int ok = 1;
+
+    for (i = 0; i < TEST_FILL; ++i) {
+        spheres.x[i] = spxrandf_between_r(&rng, -60.0F, 60.0F);
+        spheres.y[i] = spxrandf_between_r(&rng, -60.0F, 60.0F);
+        spheres.z[i] = spxrandf_between_r(&rng, -120.0F, 20.0F);
+        spheres.w[i] = spxrandf_between_r(&rng, 0.0F, 5.0F);
+        mins.x[i] = spheres.x[i];
+        mins.y[i] = spheres.y[i];
+        mins.z[i] = spheres.z[i];
+        maxs.x[i] = mins.x[i] + spxrandf_between_r(&rng, 0.0F, 5.0F);
+        maxs.y[i] = mins.y[i] + spxrandf_between_r(&rng, 0.0F, 5.0F);
+        maxs.z[i] = mins.z[i] + spxrandf_between_r(&rng, 0.0F, 5.0F);
+    }
+    for (begin = 0; begin <= 32; begin += 32) {
+        frustum_test_spheres(&f, &spheres, smask, begin, TEST_FILL);
+        frustum_test_aabbs(&f, &mins, &maxs, bmask, begin, TEST_FILL);
+        for (i = begin; i < TEST_FILL; ++i) {
+            sphere sp;
+            aabb box;
+            sp.center = vec3_new(spheres.x[i], spheres.y[i], spheres.z[i]);
+            sp.radius = spheres.w[i];
+            box.min = vec3_new(mins.x[i], mins.y[i], mins.z[i]);
+            box.max = vec3_new(maxs.x[i], maxs.y[i], maxs.z[i]);
+            ok &= (int)(smask[i / 32] >> (i % 32) & 1) == frustum_test_sphere(&f, sp);
+            ok &= (int)(bmask[i / 32] >> (i % 32) & 1) == frustum_test_aabb(&f, box);
+        }
+    }
+    vec4_soa_free(&spheres);
+    vec3_soa_free(&mins);
+    vec3_soa_free(&maxs);
+    return ok;
+}
+
+/* rays from around the unit box towards it, every fourth one axis parallel
+with its origin on a slab plane so the box test meets a NaN distance */
+
+static ray test_ray(spxrng* rng, int i)
+{
+    ray r;
+    r.origin = vec3_new(spxrandf_between_r(rng, -3.0F, 3.0F),
+        spxrandf_between_r(rng, -3.0F, 3.0F), spxrandf_between_r(rng, -3.0F, 3.0F));
+    if (i % 4 == 3) {
+        r.origin.y = 1.0F;
+        r.dir = vec3_new(r.origin.x > 0.0F ? -1.0F : 1.0F, 0.0F, 0.0F);
+    } else {
+        r.dir = vec3_new(spxrandf_between_r(rng, -1.5F, 1.5F) - r.origin.x,
+            spxrandf_between_r(rng, -1.5F, 1.5F) - r.origin.y,
+            spxrandf_between_r(rng, -1.5F, 1.5F) - r.origin.z);
+    }
+    return r;
+}
+
+static void test_ray_fill(float* t, float* u, float* v)
+{
+    int i;
+    for (i = 0; i < 8; ++i) {
+        t[i] = u[i] = v[i] = -1.0F;
+    }
+}
+
+/* the packet tests against the single ray tests, t, u and v bit for bit */
+
+static int test_ray8(void)
+{
+    aabb box;
+    sphere sp;
+    triangle tri;
+    ray r[8];
+    ray4 p4;
+    ray8 p8;
+    float tmax[8], t[8], u[8], v[8], st[8], su[8], sv[8];
+    spxrng rng = spxrng_new(1);
+    int i, j, mask, smask, ok = 1;
+
+    box.min = vec3_new(-1.0F, -1.0F, -1.0F);
+    box.max = vec3_new(1.0F, 1.0F, 1.0F);
+    sp.center = vec3_new(0.5F, 0.0F, 0.0F);
+    sp.radius = 1.0F;
+    tri.a = vec3_new(-1.0F, -1.0F, 0.0F);
+    tri.b = vec3_new(1.0F, -1.0F, 0.5F);
+    tri.c = vec3_new(0.0F, 1.0F, 0.0F);
+
+    for (i = 0; i < TEST_FILL; ++i) {
+        for (j = 0; j < 8; ++j) {
+            r[j] = test_ray(&rng, j);
+            tmax[j] = spxrandf_between_r(&rng, 0.0F, 6.0F);
+        }
+        p4 = ray4_from_rays(r);
+        p8 = ray8_from_rays(r);
+
+        test_ray_fill(st, su, sv);
+        smask = 0;
+        for (j = 0; j < 8; ++j) {
+            smask |= ray_aabb(r[j], box, tmax[j], st + j) << j;
+        }
+        test_ray_fill(t, u, v);
+        mask = ray8_aabb(&p8, box, tmax, t);
+        ok &= mask == smask && !memcmp(t, st, sizeof(t));
+        test_ray_fill(t, u, v);
+        mask = ray4_aabb(&p4, box, tmax, t);
+        ok &= mask == (smask & 15) && !memcmp(t, st, sizeof(float) * 4);
+
+        test_ray_fill(st, su, sv);
+        smask = 0;
+        for (j = 0; j < 8; ++j) {
+            smask |= ray_sphere(r[j], sp, tmax[j], st + j) << j;
+        }
+        test_ray_fill(t, u, v);
+        mask = ray8_sphere(&p8, sp, tmax, t);
+        ok &= mask == smask && !memcmp(t, st, sizeof(t));
+        test_ray_fill(t, u, v);
+        mask = ray4_sphere(&p4, sp, tmax, t);
+        ok &= mask == (smask & 15) && !memcmp(t, st, sizeof(float) * 4);
+
+        test_ray_fill(st, su, sv);
+        smask = 0;
+        for (j = 0; j < 8; ++j) {
+            vec2 uv;
+            if (ray_triangle(r[j], tri, tmax[j], st + j, &uv)) {
+                smask |= 1 << j;
+                su[j] = uv.x;
+                sv[j] = uv.y;
+            }
+        }
+        test_ray_fill(t, u, v);
+        mask = ray8_triangle(&p8, tri, tmax, t, u, v);
+        ok &= mask == smask && !memcmp(t, st, sizeof(t));
+        ok &= !memcmp(u, su, sizeof(u)) && !memcmp(v, sv, sizeof(v));
+        test_ray_fill(t, u, v);
+        mask = ray4_triangle(&p4, tri, tmax, t, u, v);
+        ok &= mask == (smask & 15) && !memcmp(t, st, sizeof(float) * 4);
+        ok &= !memcmp(u, su, sizeof(float) * 4) && !memcmp(v, sv, sizeof(float) * 4);
+    }
+    return ok;
+}
+
+/* small triangles scattered over a 20 unit cube */
+
+static triangle test_triangle(spxrng* rng)
+{
+    triangle tri;
+    tri.a = vec3_new(spxrandf_between_r(rng, -10.0F, 10.0F),
+        spxrandf_between_r(rng, -10.0F, 10.0F), spxrandf_between_r(rng, -10.0F, 10.0F));
+    tri.b = vec3_add(tri.a, vec3_new(spxrandf_between_r(rng, -1.0F, 1.0F),
+        spxrandf_between_r(rng, -1.0F, 1.0F), spxrandf_between_r(rng, -1.0F, 1.0F)));
+    tri.c = vec3_add(tri.a, vec3_new(spxrandf_between_r(rng, -1.0F, 1.0F),
+        spxrandf_between_r(rng, -1.0F, 1.0F), spxrandf_between_r(rng, -1.0F, 1.0F)));
+    return tri;
+}
+
+static int test_aabb_overlap(aabb p, aabb q)
+{
+    return p.min.x <= q.max.x && p.max.x >= q.min.x &&
+           p.min.y <= q.max.y && p.max.y >= q.min.y &&
+           p.min.z <= q.max.z && p.max.z >= q.min.z;
+}
+
+/* the found indices are distinct, pass the test and number as many as the
+boxes passing it */
+
+static int test_found(const unsigned int* out, size_t found, const int* pass, unsigned int* seen, unsigned int stamp)
+{
+    size_t i, count = 0;
+    int ok = 1;
+    for (i = 0; i < TEST_FILL; ++i) {
+        count += (size_t)pass[i];
+    }
+    ok &= found == count;
+    for (i = 0; i < found && i < TEST_FILL; ++i) {
+        ok &= pass[out[i]] && seen[out[i]] != stamp;
+        seen[out[i]] = stamp;
+    }
+    return ok;
+}
+
+/* the queries against testing every box and triangle, after a build, after
+a threaded build and after a refit with moved triangles */
+
+static int test_bvh(void)
+{
+    triangle tris[TEST_FILL];
+    aabb boxes[TEST_FILL];
+    unsigned int out[TEST_FILL], seen[TEST_FILL];
+    int pass[TEST_FILL];
+    bvh b = bvh_create(TEST_FILL);
+    spxrng rng = spxrng_new(1);
+    unsigned int stamp = 0;
+    size_t i, j, tasks;
+    int round, ok = b.mem != NULL;
+
+    for (i = 0; i < TEST_FILL; ++i) {
+        tris[i] = test_triangle(&rng);
+        boxes[i] = aabb_from_triangle(tris[i]);
+        seen[i] = 0;
+    }
+    for (round = 0; ok && round < 3; ++round) {
+        if (round == 0) {
+            bvh_build(&b, boxes);
+        } else if (round == 1) {
+            tasks = bvh_build_split(&b, boxes, 8);
+            for (i = 0; i < tasks; ++i) {
+                bvh_build_task(&b, boxes, i);
+            }
+        } else {
+            for (i = 0; i < TEST_FILL; i += 3) {
+                vec3 d = vec3_new(spxrandf_between_r(&rng, -2.0F, 2.0F), 0.0F, 0.0F);
+                tris[i].a = vec3_add(tris[i].a, d);
+                tris[i].b = vec3_add(tris[i].b, d);
+                tris[i].c = vec3_add(tris[i].c, d);
+                boxes[i] = aabb_from_triangle(tris[i]);
+            }
+            bvh_refit(&b, boxes);
+        }
+
+        for (i = 0; i < 200; ++i) {
+            aabb box;
+            ray r;
+            float t = 0.0F, st = 0.0F, tmax = spxrandf_between_r(&rng, 5.0F, 40.0F);
+            unsigned int prim = 0, sprim = 0;
+            int hit, shit = 0;
+
+            box.min = vec3_new(spxrandf_between_r(&rng, -12.0F, 10.0F),
+                spxrandf_between_r(&rng, -12.0F, 10.0F), spxrandf_between_r(&rng, -12.0F, 10.0F));
+            box.max = vec3_add(box.min, vec3_new(spxrandf_between_r(&rng, 0.0F, 4.0F),
+                spxrandf_between_r(&rng, 0.0F, 4.0F), spxrandf_between_r(&rng, 0.0F, 4.0F)));
+            for (j = 0; j < TEST_FILL; ++j) {
+                pass[j] = test_aabb_overlap(boxes[j], box);
+            }
+            ok &= test_found(out, bvh_query_aabb(&b, boxes, box, out, TEST_FILL), pass, seen, ++stamp);
+
+            r = test_ray(&rng, (int)i);
+            r.origin = vec3_mult(r.origin, 4.0F);
+            for (j = 0; j < TEST_FILL; ++j) {
+                pass[j] = ray_aabb(r, boxes[j], tmax, &t);
+            }
+            ok &= test_found(out, bvh_query_ray(&b, boxes, r, tmax, out, TEST_FILL), pass, seen, ++stamp);
+
+            for (j = 0; j < TEST_FILL; ++j) {
+                if (ray_triangle(r, tris[j], shit ? st : tmax, &t, NULL)) {
+                    st = t;
+                    sprim = (unsigned int)j;
+                    shit = 1;
+                }
+            }
+            hit = bvh_raycast_triangles(&b, tris, r, tmax, &t, &prim);
+            ok &= hit == shit;
+            if (hit && shit) {
+                ok &= t == st && (prim == sprim || (ray_triangle(r, tris[prim], tmax, &st, NULL) && t == st));
+            }
+        }
+    }
+    bvh_free(&b);
+    return ok;
+}
+
+/* the radius and k nearest queries against testing every point, with radii
+large enough for both to fall back to testing every point themselves */
+
+static int test_spatial_hash(void)
+{
+    vec3_soa points = vec3_soa_create(TEST_FILL);
+    spatial_hash h = spatial_hash_create(TEST_FILL, 1024, 0.5F);
+    unsigned int out[TEST_FILL], seen[TEST_FILL];
+    float sqdist[TEST_FILL], d2[TEST_FILL];
+    int pass[TEST_FILL];
+    spxrng rng = spxrng_new(1);
+    unsigned int stamp = 0;
+    size_t i, j, k, n, m;
+    int ok = points.mem && h.mem;
+
+    for (i = 0; ok && i < TEST_FILL; ++i) {
+        points.x[i] = spxrandf_between_r(&rng, 0.0F, 4.0F);
+        points.y[i] = spxrandf_between_r(&rng, 0.0F, 4.0F);
+        points.z[i] = spxrandf_between_r(&rng, 0.0F, 4.0F);
+        seen[i] = 0;
+    }
+    if (ok) {
+        spatial_hash_build(&h, &points);
+    }
+    for (i = 0; ok && i < 400; ++i) {
+        vec3 p = vec3_new(spxrandf_between_r(&rng, -0.5F, 4.5F),
+            spxrandf_between_r(&rng, -0.5F, 4.5F), spxrandf_between_r(&rng, -0.5F, 4.5F));
+        float r = spxrandf_between_r(&rng, 0.0F, i % 8 ? 1.5F : 4.0F), r2 = r * r;
+
+        for (j = 0; j < TEST_FILL; ++j) {
+            float dx = points.x[j] - p.x, dy = points.y[j] - p.y, dz = points.z[j] - p.z;
+            d2[j] = dx * dx + dy * dy + dz * dz;
+            pass[j] = d2[j] <= r2;
+        }
+        ok &= test_found(out, spatial_hash_query_radius(&h, p, r, out, TEST_FILL), pass, seen, ++stamp);
+
+        /* the k nearest are the k smallest distances within the radius */
+        k = i % 16 + 1;
+        n = spatial_hash_query_knn(&h, p, k, r, out, sqdist);
+        ok &= n <= k;
+        ++stamp;
+        for (j = 0; ok && j < n; ++j) {
+            ok &= d2[out[j]] == sqdist[j] && sqdist[j] <= r2 && (!j || sqdist[j - 1] <= sqdist[j]);
+            ok &= seen[out[j]] != stamp;
+            seen[out[j]] = stamp;
+        }
+        for (j = 0, m = 0; ok && j < TEST_FILL; ++j) {
+            m += (size_t)(pass[j] && (n < k || d2[j] < sqdist[n - 1]));
+        }
+        ok &= n == k ? m < k : m == n;
+    }
+    vec3_soa_free(&points);
+    spatial_hash_free(&h);
+    return ok;
+}
+
+/* the codes against interleaving the bits one at a time and decoding back,
+x in the lowest bit */
+
+static int test_morton(void)
+{
+    spxrng rng = spxrng_new(1);
+    long i;
+    int b, ok = 1;
+
+    for (i = 0; i < TEST_SAMPLES / 4; ++i) {
+        unsigned int n = spxrand_r(&rng), code2 = 0, code3 = 0;
+        ivec2 p, p2;
+        ivec3 q, q3;
+        p.x = (int)(n & 0xffff);
+        p.y = (int)(n >> 16);
+        q.x = (int)(n & 0x3ff);
+        q.y = (int)(n >> 10 & 0x3ff);
+        q.z = (int)(n >> 20 & 0x3ff);
+        for (b = 0; b < 16; ++b) {
+            code2 |= ((unsigned int)p.x >> b & 1U) << (b * 2);
+            code2 |= ((unsigned int)p.y >> b & 1U) << (b * 2 + 1);
+        }
+        for (b = 0; b < 10; ++b) {
+            code3 |= ((unsigned int)q.x >> b & 1U) << (b * 3);
+            code3 |= ((unsigned int)q.y >> b & 1U) << (b * 3 + 1);
+            code3 |= ((unsigned int)q.z >> b & 1U) << (b * 3 + 2);
+        }
+        p2 = morton2_decode(code2);
+        q3 = morton3_decode(code3);
+        ok &= morton2_encode(p) == code2 && p2.x == p.x && p2.y == p.y;
+        ok &= morton3_encode(q) == code3 && q3.x == q.x && q3.y == q.y && q3.z == q.z;
+    }
+    return ok;
+}
+
+/* the batch keys against morton3_from_vec3 from an odd begin, with points
+outside the bounds and NaN clamped the same way */
+
+static int test_morton3_from_vec3_soa(void)
+{
+    vec3_soa points = vec3_soa_create(TEST_FILL);
+    unsigned int keys[TEST_FILL];
+    vec3 min = vec3_new(-1.0F, 0.0F, 2.0F), max = vec3_new(1.0F, 4.0F, 3.0F);
+    spxrng rng = spxrng_new(1);
+    float zero = 0.0F;
+    size_t i;
+    int ok = points.mem != NULL;
+
+    for (i = 0; ok && i < TEST_FILL; ++i) {
+        points.x[i] = spxrandf_between_r(&rng, -1.5F, 1.5F);
+        points.y[i] = spxrandf_between_r(&rng, -0.5F, 4.5F);
+        points.z[i] = i % 7 ? spxrandf_between_r(&rng, 1.5F, 3.5F) : zero / zero;
+        keys[i] = 0;
+    }
+    if (ok) {
+        morton3_from_vec3_soa(&points, min, max, keys, 3, TEST_FILL);
+    }
+    for (i = 0; ok && i < TEST_FILL; ++i) {
+        vec3 p = vec3_new(points.x[i], points.y[i], points.z[i]);
+        ok &= keys[i] == (i < 3 ? 0U : morton3_from_vec3(p, min, max));
+    }
+    vec3_soa_free(&points);
+    return ok;
+}
+
+/* keys with many duplicates in every byte, sorted with and without values
+and on 3 parts with the threaded passes, equal keys keep the order of their
+values */
+
+static int test_radix_sort(void)
+{
+    unsigned int keys[TEST_FILL], values[TEST_FILL], orig[TEST_FILL];
+    unsigned int tkeys[TEST_FILL], tvalues[TEST_FILL], pkeys[TEST_FILL], pvalues[TEST_FILL];
+    size_t counts[3 * 256], parts[4] = {0, 300, 301, TEST_FILL}, i, k;
+    spxrng rng = spxrng_new(1);
+    int pass, ok = 1;
+
+    for (i = 0; i < TEST_FILL; ++i) {
+        orig[i] = spxrand_r(&rng) & 0x03010307U;
+        keys[i] = pkeys[i] = orig[i];
+        values[i] = pvalues[i] = (unsigned int)i;
+    }
+    radix_sort(keys, values, tkeys, tvalues, TEST_FILL);
+    for (i = 0; i < TEST_FILL; ++i) {
+        ok &= keys[i] == orig[values[i]];
+        ok &= !i || keys[i - 1] < keys[i] || (keys[i - 1] == keys[i] && values[i - 1] < values[i]);
+    }
+
+    for (pass = 0; pass < 4; ++pass) {
+        for (k = 0; k < 3; ++k) {
+            radix_sort_count(pkeys, parts[k], parts[k + 1], pass, counts + k * 256);
+        }
+        radix_sort_offsets(counts, 3);
+        for (k = 0; k < 3; ++k) {
+            radix_sort_scatter(pkeys, pvalues, parts[k], parts[k + 1], pass, counts + k * 256, tkeys, tvalues);
+        }
+        memcpy(pkeys, tkeys, sizeof(pkeys));
+        memcpy(pvalues, tvalues, sizeof(pvalues));
+    }
+    ok &= !memcmp(pkeys, keys, sizeof(keys)) && !memcmp(pvalues, values, sizeof(values));
+
+    memcpy(pkeys, orig, sizeof(orig));
+    radix_sort(pkeys, NULL, tkeys, NULL, TEST_FILL);
+    ok &= !memcmp(pkeys, keys, sizeof(keys));
+    return ok;
+}
+
+/* the batch against the single normalization bit for bit, which only holds
+when the vector reciprocal square root takes the same steps as rsqrtf_fast */
+
+static int test_vec2_array_norm_fast(void)
+{
+    vec2 in[TEST_FILL], out[TEST_FILL], ref[TEST_FILL];
+    spxrng rng = spxrng_new(1);
+    size_t i;
+
+    for (i = 0; i < TEST_FILL; ++i) {
+        float scale = i % 5 ? (float)(1 << (i % 23)) * 1e-3F : 0.0F;
+        in[i] = vec2_new(spxrandf_between_r(&rng, -1.0F, 1.0F) * scale, spxrandf_between_r(&rng, -1.0F, 1.0F) * scale);
+        ref[i] = vec2_norm_fast(in[i]);
+    }
+    vec2_array_norm_fast(in, out, TEST_FILL);
+    return !memcmp(out, ref, sizeof(out));
+}
+
+static int test_half_nan(unsigned short h)
+{
+    return (h & 0x7fffU) > 0x7c00U;
+}
+
+static int test_same_float(float p, float q)
+{
+    return !memcmp(&p, &q, sizeof(float)) || (p != p && q != q);
+}
+
+/* every half back and forth, then random floats around the half range
+rounded to the nearest half and converted in batches like one at a time,
+NaN payloads aside */
+
+static int test_half(void)
+{
+    unsigned short halves[TEST_FILL], ref[TEST_FILL];
+    float floats[TEST_FILL], out[TEST_FILL];
+    spxrng rng = spxrng_new(1);
+    unsigned int n;
+    size_t i;
+    int ok = 1;
+
+    for (n = 0; n < 0x10000U; n += TEST_FILL) {
+        for (i = 0; i < TEST_FILL; ++i) {
+            unsigned short h = (unsigned short)(n + i);
+            floats[i] = float_from_half(h);
+            halves[i] = h;
+            if (test_half_nan(h)) {
+                ok &= floats[i] != floats[i] && test_half_nan(half_from_float(floats[i]));
+            } else {
+                ok &= half_from_float(floats[i]) == h;
+            }
+        }
+        float_array_from_half(halves, out, TEST_FILL);
+        for (i = 0; i < TEST_FILL; ++i) {
+            ok &= test_same_float(out[i], floats[i]);
+        }
+    }
+
+    for (n = 0; n < 400; ++n) {
+        for (i = 0; i < TEST_FILL; ++i) {
+            union { float f; unsigned int i; } u;
+            unsigned int exponent = i % 101 ? spxrand_r(&rng) % 48 + 96 : 255;
+            u.i = (spxrand_r(&rng) & 0x807fffffU) | exponent << 23;
+            floats[i] = u.f;
+            ref[i] = half_from_float(u.f);
+            if ((ref[i] & 0x7fffU) < 0x7c00U) {
+                /* no closer half on either side */
+                float d = absf(float_from_half(ref[i]) - u.f);
+                ok &= d <= absf(float_from_half((unsigned short)(ref[i] + 1)) - u.f);
+                ok &= (ref[i] & 0x7fffU) == 0 || d <= absf(float_from_half((unsigned short)(ref[i] - 1)) - u.f);
+            }
+        }
+        half_array_from_float(floats, halves, TEST_FILL);
+        for (i = 0; i < TEST_FILL; ++i) {
+            ok &= halves[i] == ref[i] || (test_half_nan(halves[i]) && test_half_nan(ref[i]));
+        }
+    }
+    return ok;
+}
+
+/* the angle between two directions, from the cross and dot products in
+double as the dot product alone loses small angles to rounding */
+
+static double test_angle_between(vec3 p, vec3 q)
+{
+    double x = (double)p.y * q.z - (double)p.z * q.y;
+    double y = (double)p.z * q.x - (double)p.x * q.z;
+    double z = (double)p.x * q.y - (double)p.y * q.x;
+    return atan2(sqrt(x * x + y * y + z * z), (double)p.x * q.x + (double)p.y * q.y + (double)p.z * q.z);
+}
+
+/* directions round trip within 0.005 degrees and the batches match the
+single conversions */
+
+static int test_oct32(void)
+{
+    vec3 in[TEST_FILL], out[TEST_FILL];
+    unsigned int codes[TEST_FILL], ref[TEST_FILL];
+    spxrng rng = spxrng_new(1);
+    double bound = 0.005 * 3.14159265358979 / 180.0;
+    size_t i;
+    int round, ok = 1;
+
+    for (round = 0; round < 100; ++round) {
+        for (i = 0; i < TEST_FILL; ++i) {
+            vec3 p = vec3_new(spxrandf_between_r(&rng, -1.0F, 1.0F),
+                spxrandf_between_r(&rng, -1.0F, 1.0F), spxrandf_between_r(&rng, -1.0F, 1.0F));
+            if (i < 6) {
+                p = vec3_new(0.0F, 0.0F, 0.0F);
+                (&p.x)[i % 3] = i < 3 ? 1.0F : -1.0F;
+            }
+            in[i] = vec3_norm(p);
+            ref[i] = oct32_from_vec3(in[i]);
+            p = vec3_from_oct32(ref[i]);
+            ok &= test_angle_between(p, in[i]) <= bound;
+        }
+        oct32_array_from_vec3(in, codes, TEST_FILL);
+        ok &= !memcmp(codes, ref, sizeof(codes));
+        for (i = 0; i < TEST_FILL; ++i) {
+            codes[i] = spxrand_r(&rng);
+            in[i] = vec3_from_oct32(codes[i]);
+        }
+        vec3_array_from_oct32(codes, out, TEST_FILL);
+        ok &= !memcmp(out, in, sizeof(out));
+    }
+    return ok;
+}
+
+/* every field value survives decoding and encoding, except the snorm codes
+below -1, and the batches match the single conversions */
+
+static int test_1010102(void)
+{
+    vec4 in[TEST_FILL], out[TEST_FILL], ref[TEST_FILL];
+    unsigned int words[TEST_FILL], uref[TEST_FILL], sref[TEST_FILL], codes[TEST_FILL];
+    spxrng rng = spxrng_new(1);
+    size_t i;
+    int round, ok = 1;
+
+    for (round = 0; round < 100; ++round) {
+        for (i = 0; i < TEST_FILL; ++i) {
+            unsigned int n = spxrand_r(&rng), s = n, f;
+            for (f = 0; f < 30; f += 10) {
+                s = (s >> f & 0x3ffU) == 0x200U ? s + (1U << f) : s;
+            }
+            s = s >> 30 == 2U ? s | 0xc0000000U : s;
+            ok &= unorm1010102_from_vec4(vec4_from_unorm1010102(n)) == n;
+            ok &= snorm1010102_from_vec4(vec4_from_snorm1010102(s)) == s;
+            words[i] = n;
+            ref[i] = vec4_from_unorm1010102(n);
+            in[i] = vec4_new(spxrandf_between_r(&rng, -1.5F, 1.5F), spxrandf_between_r(&rng, -1.5F, 1.5F),
+                spxrandf_between_r(&rng, -1.5F, 1.5F), spxrandf_between_r(&rng, -1.5F, 1.5F));
+            uref[i] = unorm1010102_from_vec4(in[i]);
+            sref[i] = snorm1010102_from_vec4(in[i]);
+        }
+        vec4_array_from_unorm1010102(words, out, TEST_FILL);
+        ok &= !memcmp(out, ref, sizeof(out));
+        for (i = 0; i < TEST_FILL; ++i) {
+            ref[i] = vec4_from_snorm1010102(words[i]);
+        }
+        vec4_array_from_snorm1010102(words, out, TEST_FILL);
+        ok &= !memcmp(out, ref, sizeof(out));
+        unorm1010102_array_from_vec4(in, codes, TEST_FILL);
+        ok &= !memcmp(codes, uref, sizeof(codes));
+        snorm1010102_array_from_vec4(in, codes, TEST_FILL);
+        ok &= !memcmp(codes, sref, sizeof(codes));
+    }
+    return ok;
+}
+
+static int check(const char* name)
+{
+    filter = name;
+    test("sinf_fast", test_sinf_fast);
+    test("cosf_fast", test_cosf_fast);
+    test("atan2f_fast", test_atan2f_fast);
+    test("spxm_sincosf", test_spxm_sincosf);
+    test("rsqrtf_fast", test_rsqrtf_fast);
+    test("mat4_mult_to", test_mat4_mult_to);
+    test("mat4_inverse", test_mat4_inverse);
+    test("spxrand_fill", test_spxrand_fill);
+    test("quat_array_slerp", test_quat_array_slerp);
+    test("spxm_sincosf_array", test_spxm_sincosf_array);
+    test("frustum", test_frustum);
+    test("ray8", test_ray8);
+    test("bvh", test_bvh);
+    test("spatial_hash", test_spatial_hash);
+    test("morton", test_morton);
+    test("morton3_from_vec3_soa", test_morton3_from_vec3_soa);
+    test("radix_sort", test_radix_sort);
+    test("vec2_array_norm_fast", test_vec2_array_norm_fast);
+    test("half", test_half);
+    test("oct32", test_oct32);
+    test("1010102", test_1010102);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 int main(int argc, char** argv)
 {
     int i, count = 100;
     float min = FLT_MAX, max = FLT_MIN, sum = 0.0F;
 
+    if (argc > 1 && !strcmp(argv[1], "check")) {
+        return check(argc > 2 ? argv[2] : NULL);
+    }
+
     if (argc > 1) {
         count = atoi(argv[1]);
         spxrand_seed_set(argc > 2 ? atoi(argv[2]) : 0);
@@ -27,4 +964,3 @@ int main(int argc, char** argv)
     printf("average: %f\n", sum / (float)count);
     return 0;
 }
-